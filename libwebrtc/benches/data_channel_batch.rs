@@ -0,0 +1,133 @@
+// Copyright 2025 LiveKit, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Cost of handing data packets to an open data channel, one hop to the
+//! network thread per packet (send) against one hop per batch (send_batch),
+//! over a loopback connection between two peer connections.
+//!
+//! cargo bench -p libwebrtc --bench data_channel_batch
+
+use std::{
+    sync::mpsc,
+    thread,
+    time::{Duration, Instant},
+};
+
+use libwebrtc::{data_channel::DataSendBatch, prelude::*};
+
+// Reliable packets are mostly small (chat, RPC, cursors)
+const PACKET_SIZE: usize = 64;
+const BATCH_SIZES: [usize; 4] = [1, 8, 32, 128];
+
+const RUN_TIME: Duration = Duration::from_secs(2);
+const CONNECT_TIMEOUT: Duration = Duration::from_secs(10);
+
+/// Stay well below the SCTP send buffer so no send fails
+const MAX_BUFFERED: u64 = 256 * 1024;
+
+fn run(name: &str, dc: &DataChannel, batch_size: usize, mut f: impl FnMut()) {
+    let mut elapsed = Duration::ZERO;
+    let mut packets = 0u64;
+    let start = Instant::now();
+    while start.elapsed() < RUN_TIME {
+        // Only the hand-over is timed, not the wait for the buffer to drain
+        let hop = Instant::now();
+        f();
+        elapsed += hop.elapsed();
+        packets += batch_size as u64;
+
+        while dc.buffered_amount() > MAX_BUFFERED {
+            thread::sleep(Duration::from_millis(1));
+        }
+    }
+
+    let per_packet = elapsed / packets as u32;
+    let packets_per_s = packets as f64 / elapsed.as_secs_f64();
+    println!(
+        "{name:>6} x{batch_size:<4}: {per_packet:>10.2?}/packet {packets_per_s:>12.0} packets/s"
+    );
+}
+
+async fn connect(factory: &PeerConnectionFactory) -> (PeerConnection, PeerConnection, DataChannel) {
+    let config = RtcConfiguration {
+        ice_servers: vec![],
+        continual_gathering_policy: ContinualGatheringPolicy::GatherOnce,
+        ice_transport_type: IceTransportsType::All,
+    };
+    let offerer = factory.create_peer_connection(config.clone()).unwrap();
+    let answerer = factory.create_peer_connection(config).unwrap();
+
+    let (offerer_tx, offerer_rx) = mpsc::channel();
+    let (answerer_tx, answerer_rx) = mpsc::channel();
+    offerer.on_ice_candidate(Some(Box::new(move |candidate| {
+        let _ = offerer_tx.send(candidate);
+    })));
+    answerer.on_ice_candidate(Some(Box::new(move |candidate| {
+        let _ = answerer_tx.send(candidate);
+    })));
+
+    // Negotiated on both sides, no need to wait for on_data_channel
+    let init = DataChannelInit { negotiated: true, id: 0, ..Default::default() };
+    let dc = offerer.create_data_channel("bench", init.clone()).unwrap();
+    let _remote_dc = answerer.create_data_channel("bench", init).unwrap();
+
+    let offer = offerer.create_offer(OfferOptions::default()).await.unwrap();
+    offerer.set_local_description(offer.clone()).await.unwrap();
+    answerer.set_remote_description(offer).await.unwrap();
+    let answer = answerer.create_answer(AnswerOptions::default()).await.unwrap();
+    answerer.set_local_description(answer.clone()).await.unwrap();
+    offerer.set_remote_description(answer).await.unwrap();
+
+    let start = Instant::now();
+    while dc.state() != DataChannelState::Open {
+        assert!(start.elapsed() < CONNECT_TIMEOUT, "data channel didn't open");
+        while let Ok(candidate) = offerer_rx.try_recv() {
+            answerer.add_ice_candidate(candidate).await.unwrap();
+        }
+        while let Ok(candidate) = answerer_rx.try_recv() {
+            offerer.add_ice_candidate(candidate).await.unwrap();
+        }
+        thread::sleep(Duration::from_millis(10));
+    }
+
+    (offerer, answerer, dc)
+}
+
+#[tokio::main(flavor = "current_thread")]
+async fn main() {
+    let factory = PeerConnectionFactory::default();
+    let (offerer, answerer, dc) = connect(&factory).await;
+    let packet = [0x5a; PACKET_SIZE];
+
+    for batch_size in BATCH_SIZES {
+        run("send", &dc, batch_size, || {
+            for _ in 0..batch_size {
+                dc.send(&packet, true).unwrap();
+            }
+        });
+
+        run("batch", &dc, batch_size, || {
+            let mut batch = DataSendBatch::new();
+            for _ in 0..batch_size {
+                batch.push(&packet, true).unwrap();
+            }
+            for result in dc.send_batch(batch) {
+                result.unwrap();
+            }
+        });
+    }
+
+    offerer.close();
+    answerer.close();
+}
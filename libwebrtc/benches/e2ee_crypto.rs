@@ -0,0 +1,79 @@
+// Copyright 2025 LiveKit, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! AES-GCM throughput with the cached per-key contexts shared by the frame
+//! cryptors and the data packets, to size E2EE capacity.
+//!
+//! cargo bench -p libwebrtc --bench e2ee_crypto
+
+use std::time::{Duration, Instant};
+
+use libwebrtc::native::frame_cryptor::{
+    DataPacketCryptor, KeyProvider, KeyProviderOptions, DATA_PACKET_TAG_SIZE,
+};
+
+const PARTICIPANT: &str = "bench";
+
+// Audio frames (~100 B) and video frames (10-100 KB)
+const SIZES: [usize; 4] = [100, 10 * 1024, 50 * 1024, 100 * 1024];
+
+const RUN_TIME: Duration = Duration::from_secs(2);
+
+fn run(name: &str, size: usize, mut f: impl FnMut()) {
+    // Warm up the context cache
+    for _ in 0..16 {
+        f();
+    }
+
+    let start = Instant::now();
+    let mut iterations = 0u64;
+    while start.elapsed() < RUN_TIME {
+        f();
+        iterations += 1;
+    }
+
+    let elapsed = start.elapsed();
+    let per_frame = elapsed / iterations as u32;
+    let mb_per_s = (size as f64 * iterations as f64) / elapsed.as_secs_f64() / 1e6;
+    println!("{name:>8} {size:>7} B: {per_frame:>10.2?}/frame {mb_per_s:>10.1} MB/s");
+}
+
+fn main() {
+    let key_provider = KeyProvider::new(KeyProviderOptions {
+        shared_key: false,
+        ratchet_window_size: 0,
+        ratchet_salt: b"LKFrameEncryptionKey".to_vec(),
+        failure_tolerance: -1,
+    });
+    key_provider.set_key(PARTICIPANT.to_owned(), 0, b"bench-key".to_vec());
+    let cryptor = DataPacketCryptor::new(key_provider);
+
+    for size in SIZES {
+        let payload = vec![0x5a; size];
+        let mut buffer = Vec::with_capacity(size + DATA_PACKET_TAG_SIZE);
+        run("encrypt", size, || {
+            buffer.clear();
+            buffer.extend_from_slice(&payload);
+            cryptor.encrypt(PARTICIPANT, 0, &mut buffer).unwrap();
+        });
+
+        let mut sealed = payload.clone();
+        let iv = cryptor.encrypt(PARTICIPANT, 0, &mut sealed).unwrap();
+        run("decrypt", size, || {
+            buffer.clear();
+            buffer.extend_from_slice(&sealed);
+            cryptor.decrypt(PARTICIPANT, 0, &iv, &mut buffer).unwrap();
+        });
+    }
+}
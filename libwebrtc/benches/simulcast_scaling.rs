@@ -0,0 +1,73 @@
+// Copyright 2025 LiveKit, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Per-frame CPU of downscaling the simulcast layers, each from the full
+//! resolution (SimulcastEncoderAdapter alone) or through the scaling pyramid
+//! of the PyramidSimulcastEncoder. VP8 doesn't use either: its simulcast
+//! encoder cascades the layers itself.
+//!
+//! cargo bench -p libwebrtc --bench simulcast_scaling
+
+use std::time::{Duration, Instant};
+
+use libwebrtc::video_frame::I420Buffer;
+
+// Source resolution and the lower layers, the full resolution layer isn't
+// scaled
+const CASES: [(&str, (u32, u32), &[(u32, u32)]); 4] = [
+    ("720p halves", (1280, 720), &[(640, 360), (320, 180)]),
+    ("1080p halves", (1920, 1080), &[(960, 540), (480, 270)]),
+    ("1080p 2 layers", (1920, 1080), &[(640, 360)]),
+    ("720p 3/4", (1280, 720), &[(960, 540), (480, 270)]),
+];
+
+const RUN_TIME: Duration = Duration::from_secs(2);
+
+fn run(name: &str, mut f: impl FnMut()) {
+    for _ in 0..16 {
+        f();
+    }
+
+    let start = Instant::now();
+    let mut iterations = 0u64;
+    while start.elapsed() < RUN_TIME {
+        f();
+        iterations += 1;
+    }
+
+    let per_frame = start.elapsed() / iterations as u32;
+    println!("{name:>24}: {per_frame:>10.2?}/frame");
+}
+
+fn main() {
+    for (name, (width, height), layers) in CASES {
+        let mut source = I420Buffer::new(width, height);
+        let (data_y, data_u, data_v) = source.data_mut();
+        for (i, byte) in data_y.iter_mut().enumerate() {
+            *byte = (i % 251) as u8;
+        }
+        data_u.fill(96);
+        data_v.fill(160);
+
+        println!("{name} ({width}x{height} -> {layers:?})");
+        run("direct", || {
+            for &(layer_width, layer_height) in layers {
+                std::hint::black_box(source.scale(layer_width, layer_height));
+            }
+        });
+        run("pyramid", || {
+            std::hint::black_box(source.scale_layers(layers));
+        });
+    }
+}
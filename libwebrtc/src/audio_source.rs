@@ -23,6 +23,15 @@ pub struct AudioSourceOptions {
     pub auto_gain_control: bool,
 }
 
+/// An Opus packet encoded outside of WebRTC, sent without being decoded/re-encoded.
+/// In-band FEC and DTX packets are forwarded as they are.
+#[derive(Debug, Clone)]
+pub struct EncodedAudioFrame<'a> {
+    pub data: &'a [u8],
+    /// Multiple of 10ms, up to 120ms
+    pub duration_ms: u32,
+}
+
 #[non_exhaustive]
 #[derive(Debug, Clone)]
 pub enum RtcAudioSource {
@@ -83,6 +92,17 @@ pub mod native {
             self.handle.capture_frame(frame).await
         }
 
+        /// Publish an already encoded Opus packet, the source must be created with a
+        /// 48kHz sample rate and a single channel
+        ///
+        /// The gaps between packets are treated as DTX until a PCM frame is captured
+        /// or the buffer is cleared. Local sinks of the track (e.g. a NativeAudioStream)
+        /// receive silence while packets are sent, and in-band FEC/DTX are whatever
+        /// the upstream encoder produced.
+        pub fn capture_encoded_frame(&self, frame: &EncodedAudioFrame) -> Result<(), RtcError> {
+            self.handle.capture_encoded_frame(frame)
+        }
+
         pub fn set_audio_options(&self, options: AudioSourceOptions) {
             self.handle.set_audio_options(options)
         }
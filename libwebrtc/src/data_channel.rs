@@ -17,6 +17,8 @@ use std::{fmt::Debug, str::Utf8Error};
 use serde::Deserialize;
 use thiserror::Error;
 
+#[cfg(not(target_arch = "wasm32"))]
+pub use crate::imp::data_channel::DataSendBatch;
 use crate::{imp::data_channel as dc_imp, rtp_parameters::Priority};
 
 #[derive(Clone, Debug)]
@@ -70,6 +72,10 @@ pub struct DataBuffer<'a> {
 pub type OnStateChange = Box<dyn FnMut(DataChannelState) + Send + Sync>;
 pub type OnMessage = Box<dyn FnMut(DataBuffer) + Send + Sync>;
 pub type OnBufferedAmountChange = Box<dyn FnMut(u64) + Send + Sync>;
+/// Message and whether it is binary, the Bytes references the buffer WebRTC
+/// received the message in
+#[cfg(not(target_arch = "wasm32"))]
+pub type OnMessageBytes = Box<dyn FnMut(bytes::Bytes, bool) + Send + Sync>;
 
 #[derive(Clone)]
 pub struct DataChannel {
@@ -114,6 +120,39 @@ impl DataChannel {
     }
 }
 
+#[cfg(not(target_arch = "wasm32"))]
+impl DataChannel {
+    /// Send a message of `len` bytes written by `write` directly into the
+    /// buffer handed to WebRTC, saving the copy done by send()
+    pub fn send_with(
+        &self,
+        len: usize,
+        binary: bool,
+        write: impl FnOnce(&mut [u8]),
+    ) -> Result<(), DataChannelError> {
+        self.handle.send_with(len, binary, write)
+    }
+
+    /// Send the messages of the batch in a single hop to the network
+    /// thread instead of one per message, one result per message
+    pub fn send_batch(&self, batch: DataSendBatch) -> Vec<Result<(), DataChannelError>> {
+        self.handle.send_batch(batch)
+    }
+
+    /// With a threshold, on_buffered_amount_change is only called when the
+    /// buffered amount drops to the threshold or below (or to 0), with the
+    /// bytes sent since the previous call. None reports every change.
+    pub fn set_buffered_amount_low_threshold(&self, threshold: Option<u64>) {
+        self.handle.set_buffered_amount_low_threshold(threshold)
+    }
+
+    /// Like on_message but the messages can be kept without copying them,
+    /// takes precedence over the on_message handler when set
+    pub fn on_message_bytes(&self, callback: Option<OnMessageBytes>) {
+        self.handle.on_message_bytes(callback)
+    }
+}
+
 impl Debug for DataChannel {
     fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
         f.debug_struct("DataChannel")
@@ -66,7 +66,9 @@ pub mod video_track;
 pub mod native {
     pub use webrtc_sys::webrtc::ffi::create_random_uuid;
 
-    pub use crate::imp::{apm, audio_resampler, frame_cryptor, yuv_helper};
+    pub use crate::imp::{
+        apm, audio_resampler, codec_stats, encoded_frame_sink, frame_cryptor, yuv_helper,
+    };
 }
 
 #[cfg(target_os = "android")]
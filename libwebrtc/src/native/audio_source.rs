@@ -16,7 +16,11 @@ use cxx::SharedPtr;
 use tokio::sync::oneshot;
 use webrtc_sys::audio_track as sys_at;
 
-use crate::{audio_frame::AudioFrame, audio_source::AudioSourceOptions, RtcError, RtcErrorType};
+use crate::{
+    audio_frame::AudioFrame,
+    audio_source::{AudioSourceOptions, EncodedAudioFrame},
+    RtcError, RtcErrorType,
+};
 
 #[derive(Clone)]
 pub struct NativeAudioSource {
@@ -111,6 +115,31 @@ impl NativeAudioSource {
 
         Ok(())
     }
+
+    pub fn capture_encoded_frame(&self, frame: &EncodedAudioFrame) -> Result<(), RtcError> {
+        if self.sample_rate != 48000 || self.num_channels != 1 {
+            return Err(RtcError {
+                error_type: RtcErrorType::InvalidState,
+                message: "encoded frames require a 48kHz mono source".to_owned(),
+            });
+        }
+
+        if frame.duration_ms == 0 || frame.duration_ms % 10 != 0 || frame.duration_ms > 120 {
+            return Err(RtcError {
+                error_type: RtcErrorType::InvalidState,
+                message: "duration_ms must be a multiple of 10ms, up to 120ms".to_owned(),
+            });
+        }
+
+        if !self.sys_handle.capture_encoded_frame(frame.data, frame.duration_ms) {
+            return Err(RtcError {
+                error_type: RtcErrorType::InvalidState,
+                message: "failed to capture encoded frame".to_owned(),
+            });
+        }
+
+        Ok(())
+    }
 }
 
 impl From<sys_at::ffi::AudioSourceOptions> for AudioSourceOptions {
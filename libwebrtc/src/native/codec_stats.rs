@@ -0,0 +1,200 @@
+// Copyright 2023 LiveKit, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+use std::fmt::Debug;
+
+use cxx::SharedPtr;
+use webrtc_sys::codec_stats as sys_cs;
+
+const QP_BUCKET_WIDTH: u64 = 4;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum HistogramScale {
+    /// Bucket i counts [i * width, (i + 1) * width)
+    Linear { width: u64 },
+    /// Bucket 0 counts 0, bucket i counts [2^(i - 1), 2^i)
+    Log2,
+}
+
+/// The last bucket also counts the values above its range
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct Histogram {
+    pub scale: HistogramScale,
+    pub count: u64,
+    pub sum: u64,
+    pub max: u64,
+    pub buckets: Vec<u64>,
+}
+
+impl Histogram {
+    pub(crate) fn new(scale: HistogramScale, value: sys_cs::ffi::HistogramSnapshot) -> Self {
+        Self { scale, count: value.count, sum: value.sum, max: value.max, buckets: value.buckets }
+    }
+
+    /// [lower, upper) bounds of a bucket
+    pub fn bucket_range(&self, index: usize) -> (u64, u64) {
+        match self.scale {
+            HistogramScale::Linear { width } => {
+                (index as u64 * width, (index as u64 + 1).saturating_mul(width))
+            }
+            HistogramScale::Log2 if index == 0 => (0, 1),
+            HistogramScale::Log2 => {
+                (1 << (index - 1), 1u64.checked_shl(index as u32).unwrap_or(u64::MAX))
+            }
+        }
+    }
+
+    pub fn mean(&self) -> Option<f64> {
+        (self.count > 0).then(|| self.sum as f64 / self.count as f64)
+    }
+
+    /// Upper bound of the bucket holding the given percentile (0.0 - 1.0),
+    /// capped by the max recorded value
+    pub fn percentile(&self, percentile: f64) -> Option<u64> {
+        if self.count == 0 {
+            return None;
+        }
+
+        let rank = ((percentile.clamp(0.0, 1.0) * self.count as f64).ceil() as u64).max(1);
+        let mut seen = 0;
+        for (index, count) in self.buckets.iter().enumerate() {
+            seen += count;
+            if seen >= rank {
+                return Some(self.bucket_range(index).1.saturating_sub(1).min(self.max));
+            }
+        }
+        Some(self.max)
+    }
+}
+
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct CodecStatsSnapshot {
+    /// Encoded/decoded frames, simulcast layers are counted separately
+    pub frames: u64,
+    /// Frames dropped by the encoder (rate control)
+    pub dropped: u64,
+    pub errors: u64,
+    /// Time spent in the codec, in microseconds
+    pub latency_us: Histogram,
+    /// Only filled when the codec reports it
+    pub qp: Histogram,
+    /// Size of the encoded frames
+    pub size_bytes: Histogram,
+}
+
+impl From<sys_cs::ffi::CodecStatsSnapshot> for CodecStatsSnapshot {
+    fn from(value: sys_cs::ffi::CodecStatsSnapshot) -> Self {
+        Self {
+            frames: value.frames,
+            dropped: value.dropped,
+            errors: value.errors,
+            latency_us: Histogram::new(HistogramScale::Log2, value.latency_us),
+            qp: Histogram::new(HistogramScale::Linear { width: QP_BUCKET_WIDTH }, value.qp),
+            size_bytes: Histogram::new(HistogramScale::Log2, value.size_bytes),
+        }
+    }
+}
+
+/// Per-frame statistics recorded by the video encoders of an RtpSender or
+/// the video decoders of an RtpReceiver. Reading them is lock-free and
+/// doesn't go through the WebRTC stats collector.
+#[derive(Clone)]
+pub struct CodecStats {
+    sys_handle: SharedPtr<sys_cs::ffi::CodecStats>,
+}
+
+impl CodecStats {
+    pub(crate) fn from_sys(sys_handle: SharedPtr<sys_cs::ffi::CodecStats>) -> Option<Self> {
+        (!sys_handle.is_null()).then_some(Self { sys_handle })
+    }
+
+    pub fn snapshot(&self) -> CodecStatsSnapshot {
+        self.sys_handle.snapshot().into()
+    }
+
+    pub fn reset(&self) {
+        self.sys_handle.reset();
+    }
+}
+
+impl Debug for CodecStats {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("CodecStats").finish()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn histogram(scale: HistogramScale, buckets: Vec<u64>, sum: u64, max: u64) -> Histogram {
+        Histogram { scale, count: buckets.iter().sum(), sum, max, buckets }
+    }
+
+    #[test]
+    fn test_linear_bucket_range() {
+        let qp = histogram(HistogramScale::Linear { width: 4 }, vec![0; 64], 0, 0);
+        assert_eq!(qp.bucket_range(0), (0, 4));
+        assert_eq!(qp.bucket_range(3), (12, 16));
+        assert_eq!(qp.bucket_range(63), (252, 256));
+
+        let wide = histogram(HistogramScale::Linear { width: u64::MAX }, vec![0; 2], 0, 0);
+        assert_eq!(wide.bucket_range(1), (u64::MAX, u64::MAX));
+    }
+
+    #[test]
+    fn test_log2_bucket_range() {
+        let latency = histogram(HistogramScale::Log2, vec![0; 65], 0, 0);
+        assert_eq!(latency.bucket_range(0), (0, 1));
+        assert_eq!(latency.bucket_range(1), (1, 2));
+        assert_eq!(latency.bucket_range(3), (4, 8));
+        assert_eq!(latency.bucket_range(64), (1 << 63, u64::MAX));
+    }
+
+    #[test]
+    fn test_empty_percentile() {
+        let latency = histogram(HistogramScale::Log2, vec![0; 24], 0, 0);
+        assert_eq!(latency.percentile(0.5), None);
+        assert_eq!(latency.mean(), None);
+    }
+
+    #[test]
+    fn test_log2_percentile() {
+        // 1, 1, 5 and 12
+        let latency = histogram(HistogramScale::Log2, vec![0, 2, 0, 1, 1], 19, 12);
+        assert_eq!(latency.percentile(0.0), Some(1));
+        assert_eq!(latency.percentile(0.5), Some(1));
+        assert_eq!(latency.percentile(0.75), Some(7));
+        // Capped by the max
+        assert_eq!(latency.percentile(1.0), Some(12));
+        assert_eq!(latency.percentile(2.0), Some(12));
+        assert_eq!(latency.mean(), Some(4.75));
+    }
+
+    #[test]
+    fn test_linear_percentile() {
+        // 8, 9, 10 and 13
+        let qp = histogram(HistogramScale::Linear { width: 4 }, vec![0, 0, 3, 1], 40, 13);
+        assert_eq!(qp.percentile(0.5), Some(11));
+        assert_eq!(qp.percentile(0.99), Some(13));
+    }
+
+    #[test]
+    fn test_overflow_bucket_percentile() {
+        // The last bucket also counts the values above its range
+        let size = histogram(HistogramScale::Log2, vec![0, 0, 1], 1000, 1000);
+        assert_eq!(size.bucket_range(2), (2, 4));
+        assert_eq!(size.percentile(1.0), Some(3));
+    }
+}
@@ -14,13 +14,14 @@
 
 use std::{str, sync::Arc};
 
-use cxx::SharedPtr;
+use bytes::Bytes;
+use cxx::{SharedPtr, UniquePtr};
 use parking_lot::Mutex;
 use webrtc_sys::data_channel as sys_dc;
 
 use crate::data_channel::{
     DataBuffer, DataChannelError, DataChannelInit, DataChannelState, OnBufferedAmountChange,
-    OnMessage, OnStateChange,
+    OnMessage, OnMessageBytes, OnStateChange,
 };
 
 impl From<sys_dc::ffi::DataState> for DataChannelState {
@@ -78,6 +79,34 @@ impl DataChannel {
         self.sys_handle.send(&buffer).then_some(()).ok_or(DataChannelError::Send)
     }
 
+    pub fn send_with(
+        &self,
+        len: usize,
+        binary: bool,
+        write: impl FnOnce(&mut [u8]),
+    ) -> Result<(), DataChannelError> {
+        let mut buffer = sys_dc::ffi::new_data_send_buffer(len);
+        let data = buffer.pin_mut().data();
+        write(data);
+        if !binary {
+            str::from_utf8(data)?;
+        }
+
+        self.sys_handle.send_buffer(buffer, binary).then_some(()).ok_or(DataChannelError::Send)
+    }
+
+    pub fn send_batch(&self, batch: DataSendBatch) -> Vec<Result<(), DataChannelError>> {
+        if batch.is_empty() {
+            return Vec::new();
+        }
+
+        self.sys_handle
+            .send_batch(batch.sys_handle)
+            .into_iter()
+            .map(|sent| sent.then_some(()).ok_or(DataChannelError::Send))
+            .collect()
+    }
+
     pub fn id(&self) -> i32 {
         self.sys_handle.id()
     }
@@ -98,6 +127,10 @@ impl DataChannel {
         self.sys_handle.buffered_amount()
     }
 
+    pub fn set_buffered_amount_low_threshold(&self, threshold: Option<u64>) {
+        self.sys_handle.set_buffered_amount_low_threshold(threshold.unwrap_or(u64::MAX));
+    }
+
     pub fn on_state_change(&self, handler: Option<OnStateChange>) {
         *self.observer.state_change_handler.lock() = handler;
     }
@@ -106,15 +139,78 @@ impl DataChannel {
         *self.observer.message_handler.lock() = handler;
     }
 
+    pub fn on_message_bytes(&self, handler: Option<OnMessageBytes>) {
+        *self.observer.message_bytes_handler.lock() = handler;
+    }
+
     pub fn on_buffered_amount_change(&self, handler: Option<OnBufferedAmountChange>) {
         *self.observer.buffered_amount_change_handler.lock() = handler;
     }
 }
 
+/// Messages sent together by DataChannel::send_batch, each one is written
+/// directly into the buffer handed to WebRTC
+pub struct DataSendBatch {
+    sys_handle: UniquePtr<sys_dc::ffi::DataSendBatch>,
+}
+
+impl Default for DataSendBatch {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl DataSendBatch {
+    pub fn new() -> Self {
+        Self { sys_handle: sys_dc::ffi::new_data_send_batch() }
+    }
+
+    pub fn push(&mut self, data: &[u8], binary: bool) -> Result<(), DataChannelError> {
+        self.push_with(data.len(), binary, |buf| buf.copy_from_slice(data))
+    }
+
+    /// Add a message of `len` bytes written by `write`
+    pub fn push_with(
+        &mut self,
+        len: usize,
+        binary: bool,
+        write: impl FnOnce(&mut [u8]),
+    ) -> Result<(), DataChannelError> {
+        let data = self.sys_handle.pin_mut().add(len, binary);
+        write(data);
+        if !binary {
+            let valid = str::from_utf8(data).map(|_| ());
+            if let Err(err) = valid {
+                self.sys_handle.pin_mut().pop();
+                return Err(err.into());
+            }
+        }
+        Ok(())
+    }
+
+    pub fn len(&self) -> usize {
+        self.sys_handle.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+}
+
+/// Owner of the Bytes given to on_message_bytes handlers
+struct ReceiveBuffer(UniquePtr<sys_dc::ffi::DataReceiveBuffer>);
+
+impl AsRef<[u8]> for ReceiveBuffer {
+    fn as_ref(&self) -> &[u8] {
+        self.0.data()
+    }
+}
+
 #[derive(Default)]
 struct DataChannelObserver {
     state_change_handler: Mutex<Option<OnStateChange>>,
     message_handler: Mutex<Option<OnMessage>>,
+    message_bytes_handler: Mutex<Option<OnMessageBytes>>,
     buffered_amount_change_handler: Mutex<Option<OnBufferedAmountChange>>,
 }
 
@@ -126,10 +222,17 @@ impl sys_dc::DataChannelObserver for DataChannelObserver {
         }
     }
 
-    fn on_message(&self, data: &[u8], binary: bool) {
+    fn on_message(&self, buffer: UniquePtr<sys_dc::ffi::DataReceiveBuffer>, binary: bool) {
+        let mut handler = self.message_bytes_handler.lock();
+        if let Some(f) = handler.as_mut() {
+            f(Bytes::from_owner(ReceiveBuffer(buffer)), binary);
+            return;
+        }
+        drop(handler);
+
         let mut handler = self.message_handler.lock();
         if let Some(f) = handler.as_mut() {
-            f(DataBuffer { data, binary });
+            f(DataBuffer { data: buffer.data(), binary });
         }
     }
 
@@ -0,0 +1,105 @@
+// Copyright 2023 LiveKit, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+use std::sync::Arc;
+
+use cxx::SharedPtr;
+use parking_lot::Mutex;
+use webrtc_sys::encoded_frame_sink as sys_efs;
+
+use crate::{rtp_receiver::RtpReceiver, RtcError, RtcErrorType};
+
+pub type OnEncodedFrame = Box<dyn FnMut(&[u8], EncodedFrameInfo) + Send + Sync>;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct EncodedFrameInfo {
+    pub rtp_timestamp: u32,
+    pub ssrc: u32,
+    pub payload_type: u8,
+    /// Always false for audio
+    pub is_keyframe: bool,
+    /// 0 for audio and delta frames
+    pub width: u32,
+    pub height: u32,
+}
+
+/// Receives the frames of an RtpReceiver after depacketization, before they
+/// reach the decoder. The sink would replace the FrameCryptor of an E2EE
+/// track, creating it on an encrypted receiver fails.
+/// With suppress_decoding, the video frames are only delivered to the sink and
+/// no decoder is created, useful to record or forward a track without the cost
+/// of decoding it. Audio frames are always decoded.
+#[derive(Clone)]
+pub struct EncodedFrameSink {
+    observer: Arc<EncodedFrameSinkObserver>,
+    sys_handle: SharedPtr<sys_efs::ffi::EncodedFrameSink>,
+}
+
+impl EncodedFrameSink {
+    pub fn new(receiver: &RtpReceiver, suppress_decoding: bool) -> Result<Self, RtcError> {
+        let observer = Arc::new(EncodedFrameSinkObserver::default());
+        let sys_handle = sys_efs::ffi::new_encoded_frame_sink(
+            receiver.handle.sys_handle.clone(),
+            Box::new(sys_efs::EncodedFrameSinkWrapper::new(observer.clone())),
+            suppress_decoding,
+        )
+        .map_err(|e| RtcError {
+            error_type: RtcErrorType::InvalidState,
+            message: e.what().to_owned(),
+        })?;
+        Ok(Self { observer, sys_handle })
+    }
+
+    /// Resuming the decoding of a video track requests a keyframe
+    pub fn set_suppress_decoding(&self, suppress: bool) {
+        self.sys_handle.set_suppress_decoding(suppress);
+    }
+
+    pub fn suppress_decoding(&self) -> bool {
+        self.sys_handle.suppress_decoding()
+    }
+
+    /// Called on the WebRTC worker thread for every received frame, the
+    /// handler must not block
+    pub fn on_frame(&self, handler: Option<OnEncodedFrame>) {
+        *self.observer.frame_handler.lock() = handler;
+    }
+}
+
+#[derive(Default)]
+struct EncodedFrameSinkObserver {
+    frame_handler: Mutex<Option<OnEncodedFrame>>,
+}
+
+impl sys_efs::EncodedFrameSinkObserver for EncodedFrameSinkObserver {
+    fn on_encoded_frame(&self, data: &[u8], info: sys_efs::ffi::EncodedFrameInfo) {
+        let mut handler = self.frame_handler.lock();
+        if let Some(f) = handler.as_mut() {
+            f(data, info.into());
+        }
+    }
+}
+
+impl From<sys_efs::ffi::EncodedFrameInfo> for EncodedFrameInfo {
+    fn from(value: sys_efs::ffi::EncodedFrameInfo) -> Self {
+        Self {
+            rtp_timestamp: value.rtp_timestamp,
+            ssrc: value.ssrc,
+            payload_type: value.payload_type,
+            is_keyframe: value.is_keyframe,
+            width: value.width,
+            height: value.height,
+        }
+    }
+}
@@ -1,14 +1,21 @@
-use std::sync::Arc;
+use std::{
+    fmt::{self, Debug, Formatter},
+    sync::Arc,
+};
 
 use cxx::SharedPtr;
 use parking_lot::Mutex;
 use webrtc_sys::frame_cryptor::{self as sys_fc};
 
+use super::codec_stats::{Histogram, HistogramScale};
 use crate::{
     peer_connection_factory::PeerConnectionFactory, rtp_receiver::RtpReceiver,
-    rtp_sender::RtpSender,
+    rtp_sender::RtpSender, RtcError, RtcErrorType,
 };
 
+pub const DATA_PACKET_IV_SIZE: usize = 12;
+pub const DATA_PACKET_TAG_SIZE: usize = 16;
+
 pub type OnStateChange = Box<dyn FnMut(String, EncryptionState) + Send + Sync>;
 
 #[derive(Debug, Clone)]
@@ -36,6 +43,33 @@ pub enum EncryptionState {
     InternalError,
 }
 
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct FrameCryptorStats {
+    /// Frames handed to the cryptor and their size, counted when the crypto
+    /// thread picks them up (the queued ones are in queue_depth)
+    pub frames: u64,
+    pub bytes: u64,
+    /// Frames coming out of the cryptor (encrypted/decrypted or passed
+    /// through when disabled), the frames failing to decrypt are dropped
+    pub frames_out: u64,
+    pub bytes_out: u64,
+    /// CPU time of the crypto thread spent on this cryptor, in microseconds
+    pub cpu_time_us: u64,
+    /// Frames waiting for the crypto thread
+    pub queue_depth: u32,
+    pub max_queue_depth: u32,
+    /// Time from the frame being queued to the end of the transform, in
+    /// microseconds
+    pub latency_us: Histogram,
+    /// Failures and ratchets, counted when the cryptor enters the state
+    /// (not per frame)
+    pub encryption_failures: u32,
+    pub decryption_failures: u32,
+    pub missing_keys: u32,
+    pub internal_errors: u32,
+    pub key_ratchets: u32,
+}
+
 #[derive(Clone)]
 pub struct KeyProvider {
     pub(crate) sys_handle: SharedPtr<sys_fc::ffi::KeyProvider>,
@@ -75,6 +109,59 @@ impl KeyProvider {
     }
 }
 
+/// AES-GCM encryption of data packets with the keys of a KeyProvider, the
+/// ratchets done by the frame cryptors apply here as well.
+#[derive(Clone)]
+pub struct DataPacketCryptor {
+    sys_handle: SharedPtr<sys_fc::ffi::DataPacketCryptor>,
+}
+
+impl Debug for DataPacketCryptor {
+    fn fmt(&self, f: &mut Formatter<'_>) -> fmt::Result {
+        f.debug_struct("DataPacketCryptor").finish()
+    }
+}
+
+impl DataPacketCryptor {
+    pub fn new(key_provider: KeyProvider) -> Self {
+        Self { sys_handle: sys_fc::ffi::new_data_packet_cryptor(key_provider.sys_handle) }
+    }
+
+    /// Encrypt `data` in place and append the tag, returns the IV.
+    /// Reserve DATA_PACKET_TAG_SIZE bytes of capacity to avoid a reallocation.
+    pub fn encrypt(
+        &self,
+        participant_id: &str,
+        key_index: i32,
+        data: &mut Vec<u8>,
+    ) -> Result<[u8; DATA_PACKET_IV_SIZE], RtcError> {
+        let mut iv = [0u8; DATA_PACKET_IV_SIZE];
+        data.resize(data.len() + DATA_PACKET_TAG_SIZE, 0);
+        self.sys_handle.encrypt(participant_id, key_index, data, &mut iv).map_err(|e| {
+            data.truncate(data.len() - DATA_PACKET_TAG_SIZE);
+            RtcError { error_type: RtcErrorType::Internal, message: e.to_string() }
+        })?;
+        Ok(iv)
+    }
+
+    /// Decrypt `data` (payload followed by the tag) in place, it is
+    /// truncated to the payload
+    pub fn decrypt(
+        &self,
+        participant_id: &str,
+        key_index: i32,
+        iv: &[u8],
+        data: &mut Vec<u8>,
+    ) -> Result<(), RtcError> {
+        let len = self
+            .sys_handle
+            .decrypt(participant_id, key_index, iv, data)
+            .map_err(|e| RtcError { error_type: RtcErrorType::Internal, message: e.to_string() })?;
+        data.truncate(len);
+        Ok(())
+    }
+}
+
 #[derive(Clone)]
 pub struct FrameCryptor {
     observer: Arc<RtcFrameCryptorObserver>,
@@ -147,6 +234,15 @@ impl FrameCryptor {
     pub fn on_state_change(&self, handler: Option<OnStateChange>) {
         *self.observer.state_change_handler.lock() = handler;
     }
+
+    pub fn stats(&self) -> FrameCryptorStats {
+        self.sys_handle.stats().into()
+    }
+
+    /// Reset the counters, the max queue depth restarts from the current depth
+    pub fn reset_stats(&self) {
+        self.sys_handle.reset_stats();
+    }
 }
 
 #[derive(Default)]
@@ -167,6 +263,26 @@ impl sys_fc::RtcFrameCryptorObserver for RtcFrameCryptorObserver {
     }
 }
 
+impl From<sys_fc::ffi::FrameCryptorStats> for FrameCryptorStats {
+    fn from(value: sys_fc::ffi::FrameCryptorStats) -> Self {
+        Self {
+            frames: value.frames,
+            bytes: value.bytes,
+            frames_out: value.frames_out,
+            bytes_out: value.bytes_out,
+            cpu_time_us: value.cpu_time_us,
+            queue_depth: value.queue_depth,
+            max_queue_depth: value.max_queue_depth,
+            latency_us: Histogram::new(HistogramScale::Log2, value.latency_us),
+            encryption_failures: value.encryption_failures,
+            decryption_failures: value.decryption_failures,
+            missing_keys: value.missing_keys,
+            internal_errors: value.internal_errors,
+            key_ratchets: value.key_ratchets,
+        }
+    }
+}
+
 impl From<sys_fc::ffi::Algorithm> for EncryptionAlgorithm {
     fn from(value: sys_fc::ffi::Algorithm) -> Self {
         match value {
@@ -19,7 +19,9 @@ pub mod audio_resampler;
 pub mod audio_source;
 pub mod audio_stream;
 pub mod audio_track;
+pub mod codec_stats;
 pub mod data_channel;
+pub mod encoded_frame_sink;
 pub mod frame_cryptor;
 pub mod ice_candidate;
 pub mod media_stream;
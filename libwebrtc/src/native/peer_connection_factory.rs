@@ -101,6 +101,14 @@ impl PeerConnectionFactory {
     pub fn get_rtp_receiver_capabilities(&self, media_type: MediaType) -> RtpCapabilities {
         self.sys_handle.rtp_receiver_capabilities(media_type.into()).into()
     }
+
+    pub fn set_video_decoder_threads(&self, max_threads: u32) {
+        self.sys_handle.set_video_decoder_threads(max_threads);
+    }
+
+    pub fn set_crypto_threads(&self, count: u32) {
+        self.sys_handle.set_crypto_threads(count);
+    }
 }
 
 #[cfg(test)]
@@ -14,11 +14,15 @@
 
 use cxx::SharedPtr;
 use tokio::sync::oneshot;
-use webrtc_sys::rtp_receiver as sys_rr;
+use webrtc_sys::{rtp_receiver as sys_rr, video_frame_buffer as vfb_sys};
 
 use crate::{
-    imp::media_stream_track::new_media_stream_track, media_stream_track::MediaStreamTrack,
-    rtp_parameters::RtpParameters, stats::RtcStats, RtcError, RtcErrorType,
+    imp::{codec_stats::CodecStats, media_stream_track::new_media_stream_track},
+    media_stream_track::MediaStreamTrack,
+    rtp_parameters::RtpParameters,
+    stats::RtcStats,
+    video_frame::VideoBufferType,
+    RtcError, RtcErrorType,
 };
 
 #[derive(Clone)]
@@ -62,4 +66,27 @@ impl RtpReceiver {
     pub fn parameters(&self) -> RtpParameters {
         self.sys_handle.get_parameters().into()
     }
+
+    pub fn decoder_stats(&self) -> Option<CodecStats> {
+        CodecStats::from_sys(self.sys_handle.decoder_stats())
+    }
+
+    pub fn set_preferred_decoder_output(
+        &self,
+        buffer_type: Option<VideoBufferType>,
+    ) -> Result<(), RtcError> {
+        let buffer_type = match buffer_type {
+            Some(VideoBufferType::I420) => vfb_sys::ffi::VideoFrameBufferType::I420,
+            Some(VideoBufferType::NV12) => vfb_sys::ffi::VideoFrameBufferType::NV12,
+            _ => vfb_sys::ffi::VideoFrameBufferType::Native,
+        };
+
+        if !self.sys_handle.set_preferred_decoder_output(buffer_type) {
+            return Err(RtcError {
+                error_type: RtcErrorType::InvalidState,
+                message: "the receiver has no video stream yet".to_owned(),
+            });
+        }
+        Ok(())
+    }
 }
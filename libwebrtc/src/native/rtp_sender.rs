@@ -16,10 +16,12 @@ use cxx::SharedPtr;
 use tokio::sync::oneshot;
 use webrtc_sys::{rtc_error as sys_err, rtp_sender as sys_rs};
 
-use super::media_stream_track::new_media_stream_track;
+use super::{codec_stats::CodecStats, media_stream_track::new_media_stream_track};
 use crate::{
-    media_stream_track::MediaStreamTrack, rtp_parameters::RtpParameters, stats::RtcStats, RtcError,
-    RtcErrorType,
+    media_stream_track::MediaStreamTrack,
+    rtp_parameters::{RtpParameters, VideoEncoderComplexity, VideoEncoderSettings},
+    stats::RtcStats,
+    RtcError, RtcErrorType,
 };
 
 #[derive(Clone)]
@@ -80,4 +82,30 @@ impl RtpSender {
             .set_parameters(parameters.into())
             .map_err(|e| unsafe { sys_err::ffi::RtcError::from(e.what()).into() })
     }
+
+    pub fn set_video_encoder_settings(&self, settings: VideoEncoderSettings) -> CodecStats {
+        CodecStats::from_sys(self.sys_handle.set_video_encoder_settings(settings.into())).unwrap()
+    }
+}
+
+impl From<VideoEncoderComplexity> for sys_rs::ffi::VideoEncoderComplexity {
+    fn from(value: VideoEncoderComplexity) -> Self {
+        match value {
+            VideoEncoderComplexity::Low => Self::Low,
+            VideoEncoderComplexity::Normal => Self::Normal,
+            VideoEncoderComplexity::High => Self::High,
+            VideoEncoderComplexity::Higher => Self::Higher,
+            VideoEncoderComplexity::Max => Self::Max,
+        }
+    }
+}
+
+impl From<VideoEncoderSettings> for sys_rs::ffi::VideoEncoderSettings {
+    fn from(value: VideoEncoderSettings) -> Self {
+        Self {
+            max_threads: value.max_threads,
+            has_complexity: value.complexity.is_some(),
+            complexity: value.complexity.unwrap_or(VideoEncoderComplexity::Normal).into(),
+        }
+    }
 }
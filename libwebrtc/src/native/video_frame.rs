@@ -219,6 +219,31 @@ impl I420Buffer {
         unsafe { &*recursive_cast!(&*self.sys_handle, i420_to_yuv8, yuv8_to_yuv, yuv_to_vfb) }
     }
 
+    pub fn scale(&self, width: u32, height: u32) -> vf::I420Buffer {
+        vf::I420Buffer {
+            handle: I420Buffer {
+                sys_handle: vfb_sys::ffi::scale_i420_buffer(
+                    &self.sys_handle,
+                    width.try_into().unwrap(),
+                    height.try_into().unwrap(),
+                ),
+            },
+        }
+    }
+
+    pub fn scale_layers(&self, sizes: &[(u32, u32)]) -> Vec<vf::I420Buffer> {
+        let pyramid = vfb_sys::ffi::new_i420_scaling_pyramid(&self.sys_handle);
+        sizes
+            .iter()
+            .map(|&(width, height)| vf::I420Buffer {
+                handle: I420Buffer {
+                    sys_handle: pyramid
+                        .scale(width.try_into().unwrap(), height.try_into().unwrap()),
+                },
+            })
+            .collect()
+    }
+
     pub fn width(&self) -> u32 {
         unsafe {
             let ptr = recursive_cast!(&*self.sys_handle, i420_to_yuv8, yuv8_to_yuv, yuv_to_vfb);
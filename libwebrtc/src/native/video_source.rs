@@ -24,7 +24,10 @@ use webrtc_sys::{video_frame as vf_sys, video_frame::ffi::VideoRotation, video_t
 
 use crate::{
     video_frame::{I420Buffer, VideoBuffer, VideoFrame},
-    video_source::VideoResolution,
+    video_source::{
+        DirtyRect, EncodedVideoCodec, EncodedVideoFrame, OnKeyFrameRequest, VideoResolution,
+        VideoSourceOptions,
+    },
 };
 
 impl From<vt_sys::ffi::VideoResolution> for VideoResolution {
@@ -39,25 +42,54 @@ impl From<VideoResolution> for vt_sys::ffi::VideoResolution {
     }
 }
 
+impl From<EncodedVideoCodec> for vt_sys::ffi::VideoCodecType {
+    fn from(codec: EncodedVideoCodec) -> Self {
+        match codec {
+            EncodedVideoCodec::H264 => Self::H264,
+            EncodedVideoCodec::VP8 => Self::VP8,
+        }
+    }
+}
+
 #[derive(Clone)]
 pub struct NativeVideoSource {
     sys_handle: SharedPtr<vt_sys::ffi::VideoTrackSource>,
     inner: Arc<Mutex<VideoSourceInner>>,
+    observer: Arc<VideoSourceObserver>,
 }
 
 struct VideoSourceInner {
     captured_frames: usize,
 }
 
+#[derive(Default)]
+struct VideoSourceObserver {
+    keyframe_request_handler: Mutex<Option<OnKeyFrameRequest>>,
+}
+
+impl vt_sys::KeyFrameRequestObserver for VideoSourceObserver {
+    fn on_keyframe_request(&self) {
+        if let Some(f) = self.keyframe_request_handler.lock().as_mut() {
+            f();
+        }
+    }
+}
+
 impl NativeVideoSource {
-    pub fn new(resolution: VideoResolution) -> NativeVideoSource {
+    pub fn new(resolution: VideoResolution, options: VideoSourceOptions) -> NativeVideoSource {
         let source = Self {
-            sys_handle: vt_sys::ffi::new_video_track_source(&vt_sys::ffi::VideoResolution::from(
-                resolution.clone(),
-            )),
+            sys_handle: vt_sys::ffi::new_video_track_source(
+                &vt_sys::ffi::VideoResolution::from(resolution.clone()),
+                options.is_screencast,
+            ),
             inner: Arc::new(Mutex::new(VideoSourceInner { captured_frames: 0 })),
+            observer: Arc::new(VideoSourceObserver::default()),
         };
 
+        source.sys_handle.set_keyframe_request_observer(Box::new(
+            vt_sys::KeyFrameRequestObserverWrapper::new(source.observer.clone()),
+        ));
+
         livekit_runtime::spawn({
             let source = source.clone();
             let i420 = I420Buffer::new(resolution.width, resolution.height);
@@ -91,7 +123,11 @@ impl NativeVideoSource {
         self.sys_handle.clone()
     }
 
-    pub fn capture_frame<T: AsRef<dyn VideoBuffer>>(&self, frame: &VideoFrame<T>) {
+    pub fn capture_frame<T: AsRef<dyn VideoBuffer>>(
+        &self,
+        frame: &VideoFrame<T>,
+        dirty_rects: Option<&[DirtyRect]>,
+    ) {
         let mut inner = self.inner.lock();
         inner.captured_frames += 1;
 
@@ -99,6 +135,30 @@ impl NativeVideoSource {
         builder.pin_mut().set_rotation(frame.rotation.into());
         builder.pin_mut().set_video_frame_buffer(frame.buffer.as_ref().sys_handle());
 
+        if let Some(dirty_rects) = dirty_rects {
+            // WebRTC only supports a single update rect, use the bounding box
+            let (mut left, mut top, mut right, mut bottom) = (u32::MAX, u32::MAX, 0, 0);
+            for rect in dirty_rects.iter().filter(|r| r.width > 0 && r.height > 0) {
+                left = left.min(rect.x);
+                top = top.min(rect.y);
+                right = right.max(rect.x.saturating_add(rect.width));
+                bottom = bottom.max(rect.y.saturating_add(rect.height));
+            }
+
+            let buffer = frame.buffer.as_ref();
+            let (right, bottom) = (right.min(buffer.width()), bottom.min(buffer.height()));
+            if left < right && top < bottom {
+                builder.pin_mut().set_update_rect(
+                    left as i32,
+                    top as i32,
+                    (right - left) as i32,
+                    (bottom - top) as i32,
+                );
+            } else {
+                builder.pin_mut().set_update_rect(0, 0, 0, 0);
+            }
+        }
+
         if frame.timestamp_us == 0 {
             // If the timestamp is set to 0, default to now
             let now = SystemTime::now().duration_since(UNIX_EPOCH).unwrap();
@@ -110,7 +170,36 @@ impl NativeVideoSource {
         self.sys_handle.on_captured_frame(&builder.pin_mut().build());
     }
 
+    pub fn capture_encoded_frame(&self, frame: &EncodedVideoFrame) {
+        let mut inner = self.inner.lock();
+        inner.captured_frames += 1;
+
+        let timestamp_us = if frame.timestamp_us == 0 {
+            // If the timestamp is set to 0, default to now
+            SystemTime::now().duration_since(UNIX_EPOCH).unwrap().as_micros() as i64
+        } else {
+            frame.timestamp_us
+        };
+
+        self.sys_handle.on_captured_encoded_frame(
+            frame.data,
+            frame.codec.into(),
+            frame.is_keyframe,
+            frame.width,
+            frame.height,
+            timestamp_us,
+        );
+    }
+
+    pub fn on_keyframe_request(&self, handler: Option<OnKeyFrameRequest>) {
+        *self.observer.keyframe_request_handler.lock() = handler;
+    }
+
     pub fn video_resolution(&self) -> VideoResolution {
         self.sys_handle.video_resolution().into()
     }
+
+    pub fn is_screencast(&self) -> bool {
+        self.sys_handle.is_screencast()
+    }
 }
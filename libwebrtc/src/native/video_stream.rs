@@ -13,51 +13,77 @@
 // limitations under the License.
 
 use std::{
+    collections::VecDeque,
     pin::Pin,
-    sync::Arc,
-    task::{Context, Poll},
+    sync::{
+        atomic::{AtomicU64, Ordering},
+        Arc,
+    },
+    task::{Context, Poll, Waker},
 };
 
 use cxx::{SharedPtr, UniquePtr};
 use livekit_runtime::Stream;
-use tokio::sync::mpsc;
-use webrtc_sys::video_track as sys_vt;
+use parking_lot::Mutex;
+use webrtc_sys::{video_frame_buffer as vfb_sys, video_track as sys_vt};
 
 use super::video_frame::new_video_frame_buffer;
 use crate::{
-    video_frame::{BoxVideoFrame, VideoFrame},
+    video_frame::{BoxVideoFrame, VideoBufferType, VideoFrame},
+    video_stream::native::{NativeVideoStreamOptions, VideoSinkWants},
     video_track::RtcVideoTrack,
 };
 
 pub struct NativeVideoStream {
     native_sink: SharedPtr<sys_vt::ffi::NativeVideoSink>,
     video_track: RtcVideoTrack,
-    frame_rx: mpsc::UnboundedReceiver<BoxVideoFrame>,
+    queue: Arc<FrameQueue>,
 }
 
 impl NativeVideoStream {
-    pub fn new(video_track: RtcVideoTrack) -> Self {
-        let (frame_tx, frame_rx) = mpsc::unbounded_channel();
-        let observer = Arc::new(VideoTrackObserver { frame_tx });
-        let native_sink = sys_vt::ffi::new_native_video_sink(Box::new(
-            sys_vt::VideoSinkWrapper::new(observer.clone()),
-        ));
+    pub fn new(video_track: RtcVideoTrack, options: NativeVideoStreamOptions) -> Self {
+        let queue = Arc::new(FrameQueue::new(options.queue_size));
+        let observer = Arc::new(VideoTrackObserver { queue: queue.clone() });
+        // Only I420 and NV12 can be produced by the native sink
+        let format = match options.format {
+            Some(VideoBufferType::I420) => vfb_sys::ffi::VideoFrameBufferType::I420,
+            Some(VideoBufferType::NV12) => vfb_sys::ffi::VideoFrameBufferType::NV12,
+            _ => vfb_sys::ffi::VideoFrameBufferType::Native,
+        };
+        let native_sink = sys_vt::ffi::new_native_video_sink(
+            Box::new(sys_vt::VideoSinkWrapper::new(observer.clone())),
+            format,
+        );
 
         let video = unsafe { sys_vt::ffi::media_to_video(video_track.sys_handle()) };
-        video.add_sink(&native_sink);
+        video.add_sink(&native_sink, &options.wants.into());
 
-        Self { native_sink, video_track, frame_rx }
+        Self { native_sink, video_track, queue }
     }
 
     pub fn track(&self) -> RtcVideoTrack {
         self.video_track.clone()
     }
 
+    pub fn set_wants(&self, wants: VideoSinkWants) {
+        // add_sink would attach a closed stream again
+        if self.queue.is_closed() {
+            return;
+        }
+
+        let video = unsafe { sys_vt::ffi::media_to_video(self.video_track.sys_handle()) };
+        video.add_sink(&self.native_sink, &wants.into());
+    }
+
+    pub fn dropped_frames(&self) -> u64 {
+        self.queue.dropped.load(Ordering::Relaxed)
+    }
+
     pub fn close(&mut self) {
         let video = unsafe { sys_vt::ffi::media_to_video(self.video_track.sys_handle()) };
         video.remove_sink(&self.native_sink);
 
-        self.frame_rx.close();
+        self.queue.close();
     }
 }
 
@@ -70,25 +96,239 @@ impl Drop for NativeVideoStream {
 impl Stream for NativeVideoStream {
     type Item = BoxVideoFrame;
 
-    fn poll_next(mut self: Pin<&mut Self>, cx: &mut Context) -> Poll<Option<Self::Item>> {
-        self.frame_rx.poll_recv(cx)
+    fn poll_next(self: Pin<&mut Self>, cx: &mut Context) -> Poll<Option<Self::Item>> {
+        self.queue.poll_next(cx)
+    }
+}
+
+impl From<VideoSinkWants> for sys_vt::ffi::VideoSinkWants {
+    fn from(wants: VideoSinkWants) -> Self {
+        Self {
+            has_max_pixel_count: wants.max_pixel_count.is_some(),
+            max_pixel_count: wants.max_pixel_count.unwrap_or_default().min(i32::MAX as u32) as i32,
+            has_target_pixel_count: wants.target_pixel_count.is_some(),
+            target_pixel_count: wants.target_pixel_count.unwrap_or_default().min(i32::MAX as u32)
+                as i32,
+            has_max_framerate_fps: wants.max_framerate_fps.is_some(),
+            max_framerate_fps: wants.max_framerate_fps.unwrap_or_default().min(i32::MAX as u32)
+                as i32,
+            resolution_alignment: wants.resolution_alignment.max(1).min(i32::MAX as u32) as i32,
+        }
+    }
+}
+
+/// Frames waiting to be polled. When a capacity is set, the oldest frames are dropped
+/// (and their buffers released back to the decoder) instead of letting the queue grow.
+struct FrameQueue<T = BoxVideoFrame> {
+    inner: Mutex<FrameQueueInner<T>>,
+    capacity: Option<usize>,
+    dropped: AtomicU64,
+}
+
+struct FrameQueueInner<T> {
+    frames: VecDeque<T>,
+    waker: Option<Waker>,
+    closed: bool,
+}
+
+impl<T> FrameQueue<T> {
+    fn new(capacity: Option<usize>) -> Self {
+        let capacity = capacity.map(|c| c.max(1));
+        Self {
+            inner: Mutex::new(FrameQueueInner {
+                frames: VecDeque::with_capacity(capacity.unwrap_or_default()),
+                waker: None,
+                closed: false,
+            }),
+            capacity,
+            dropped: AtomicU64::new(0),
+        }
+    }
+
+    fn push(&self, frame: T) {
+        let (stale, waker) = {
+            let mut inner = self.inner.lock();
+            if inner.closed {
+                return;
+            }
+
+            let mut stale = None;
+            if let Some(capacity) = self.capacity {
+                if inner.frames.len() >= capacity {
+                    stale = inner.frames.pop_front();
+                }
+            }
+
+            inner.frames.push_back(frame);
+            (stale, inner.waker.take())
+        };
+
+        if stale.is_some() {
+            self.dropped.fetch_add(1, Ordering::Relaxed);
+        }
+
+        // Release the stale buffer outside of the lock
+        drop(stale);
+
+        if let Some(waker) = waker {
+            waker.wake();
+        }
+    }
+
+    fn poll_next(&self, cx: &mut Context) -> Poll<Option<T>> {
+        let mut inner = self.inner.lock();
+        if let Some(frame) = inner.frames.pop_front() {
+            return Poll::Ready(Some(frame));
+        }
+
+        if inner.closed {
+            return Poll::Ready(None);
+        }
+
+        inner.waker = Some(cx.waker().clone());
+        Poll::Pending
+    }
+
+    fn is_closed(&self) -> bool {
+        self.inner.lock().closed
+    }
+
+    fn close(&self) {
+        let waker = {
+            let mut inner = self.inner.lock();
+            inner.closed = true;
+            inner.waker.take()
+        };
+
+        if let Some(waker) = waker {
+            waker.wake();
+        }
     }
 }
 
 struct VideoTrackObserver {
-    frame_tx: mpsc::UnboundedSender<BoxVideoFrame>,
+    queue: Arc<FrameQueue>,
 }
 
 impl sys_vt::VideoSink for VideoTrackObserver {
     fn on_frame(&self, frame: UniquePtr<webrtc_sys::video_frame::ffi::VideoFrame>) {
-        let _ = self.frame_tx.send(VideoFrame {
+        self.queue.push(VideoFrame {
             rotation: frame.rotation().into(),
             timestamp_us: frame.timestamp_us(),
             buffer: new_video_frame_buffer(unsafe { frame.video_frame_buffer() }),
         });
     }
 
-    fn on_discarded_frame(&self) {}
+    fn on_discarded_frame(&self) {
+        self.queue.dropped.fetch_add(1, Ordering::Relaxed);
+    }
 
     fn on_constraints_changed(&self, _constraints: sys_vt::ffi::VideoTrackSourceConstraints) {}
 }
+
+#[cfg(test)]
+mod tests {
+    use std::task::Wake;
+
+    use super::*;
+
+    #[derive(Default)]
+    struct CountingWaker(AtomicU64);
+
+    impl Wake for CountingWaker {
+        fn wake(self: Arc<Self>) {
+            self.0.fetch_add(1, Ordering::Relaxed);
+        }
+    }
+
+    fn poll(queue: &FrameQueue<u32>, waker: &Arc<CountingWaker>) -> Poll<Option<u32>> {
+        let waker = Waker::from(waker.clone());
+        queue.poll_next(&mut Context::from_waker(&waker))
+    }
+
+    fn dropped(queue: &FrameQueue<u32>) -> u64 {
+        queue.dropped.load(Ordering::Relaxed)
+    }
+
+    #[test]
+    fn test_capacity_one_keeps_latest() {
+        let waker = Arc::new(CountingWaker::default());
+        let queue = FrameQueue::new(Some(1));
+        for frame in 1..=3 {
+            queue.push(frame);
+        }
+
+        assert_eq!(poll(&queue, &waker), Poll::Ready(Some(3)));
+        assert_eq!(poll(&queue, &waker), Poll::Pending);
+        assert_eq!(dropped(&queue), 2);
+
+        // A zero capacity is raised to one
+        let queue = FrameQueue::new(Some(0));
+        queue.push(1);
+        queue.push(2);
+        assert_eq!(poll(&queue, &waker), Poll::Ready(Some(2)));
+        assert_eq!(dropped(&queue), 1);
+    }
+
+    #[test]
+    fn test_dropped_counts() {
+        let waker = Arc::new(CountingWaker::default());
+        let queue = FrameQueue::new(Some(2));
+        for frame in 1..=5 {
+            queue.push(frame);
+        }
+        assert_eq!(dropped(&queue), 3);
+        assert_eq!(poll(&queue, &waker), Poll::Ready(Some(4)));
+        assert_eq!(poll(&queue, &waker), Poll::Ready(Some(5)));
+
+        // Polled frames make room again
+        queue.push(6);
+        queue.push(7);
+        assert_eq!(dropped(&queue), 3);
+
+        // Without capacity nothing is dropped
+        let queue = FrameQueue::new(None);
+        for frame in 1..=100 {
+            queue.push(frame);
+        }
+        assert_eq!(dropped(&queue), 0);
+        assert_eq!(poll(&queue, &waker), Poll::Ready(Some(1)));
+    }
+
+    #[test]
+    fn test_frames_delivered_after_close() {
+        let waker = Arc::new(CountingWaker::default());
+        let queue = FrameQueue::new(Some(4));
+        queue.push(1);
+        queue.push(2);
+        queue.close();
+        assert!(queue.is_closed());
+
+        // Ignored once closed
+        queue.push(3);
+        assert_eq!(dropped(&queue), 0);
+
+        assert_eq!(poll(&queue, &waker), Poll::Ready(Some(1)));
+        assert_eq!(poll(&queue, &waker), Poll::Ready(Some(2)));
+        assert_eq!(poll(&queue, &waker), Poll::Ready(None));
+    }
+
+    #[test]
+    fn test_push_and_close_wake_the_poller() {
+        let waker = Arc::new(CountingWaker::default());
+        let queue = FrameQueue::new(Some(1));
+        assert_eq!(poll(&queue, &waker), Poll::Pending);
+
+        queue.push(1);
+        assert_eq!(waker.0.load(Ordering::Relaxed), 1);
+        // Woken once per poll, not per frame
+        queue.push(2);
+        assert_eq!(waker.0.load(Ordering::Relaxed), 1);
+        assert_eq!(poll(&queue, &waker), Poll::Ready(Some(2)));
+
+        assert_eq!(poll(&queue, &waker), Poll::Pending);
+        queue.close();
+        assert_eq!(waker.0.load(Ordering::Relaxed), 2);
+        assert_eq!(poll(&queue, &waker), Poll::Ready(None));
+    }
+}
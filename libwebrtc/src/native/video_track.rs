@@ -27,6 +27,22 @@ pub struct RtcVideoTrack {
 impl RtcVideoTrack {
     impl_media_stream_track!(video_to_media);
 
+    pub fn set_should_receive(&self, should_receive: bool) {
+        self.sys_handle.set_should_receive(should_receive);
+    }
+
+    pub fn should_receive(&self) -> bool {
+        self.sys_handle.should_receive()
+    }
+
+    pub fn set_lazy_receive(&self, lazy_receive: bool) {
+        self.sys_handle.set_lazy_receive(lazy_receive);
+    }
+
+    pub fn lazy_receive(&self) -> bool {
+        self.sys_handle.lazy_receive()
+    }
+
     pub fn sys_handle(&self) -> SharedPtr<sys_vt::ffi::MediaStreamTrack> {
         video_to_media(self.sys_handle.clone())
     }
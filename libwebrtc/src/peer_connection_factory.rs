@@ -94,6 +94,15 @@ pub mod native {
     pub trait PeerConnectionFactoryExt {
         fn create_video_track(&self, label: &str, source: NativeVideoSource) -> RtcVideoTrack;
         fn create_audio_track(&self, label: &str, source: NativeAudioSource) -> RtcAudioTrack;
+
+        /// Max number of threads of each video decoder (dav1d, libvpx) created
+        /// from now on, 0 lets WebRTC decide from the number of cores
+        fn set_video_decoder_threads(&self, max_threads: u32);
+
+        /// Number of threads encrypting/decrypting the media frames, the
+        /// tracks are spread over them. Only the frame cryptors created from
+        /// now on are affected.
+        fn set_crypto_threads(&self, count: u32);
     }
 
     impl PeerConnectionFactoryExt for PeerConnectionFactory {
@@ -104,5 +113,13 @@ pub mod native {
         fn create_audio_track(&self, label: &str, source: NativeAudioSource) -> RtcAudioTrack {
             self.handle.create_audio_track(label, source)
         }
+
+        fn set_video_decoder_threads(&self, max_threads: u32) {
+            self.handle.set_video_decoder_threads(max_threads)
+        }
+
+        fn set_crypto_threads(&self, count: u32) {
+            self.handle.set_crypto_threads(count)
+        }
     }
 }
@@ -60,6 +60,25 @@ pub struct RtpEncodingParameters {
     pub scale_resolution_down_by: Option<f64>,
 }
 
+/// Speed/quality tradeoff of the software encoders (cpu-used of libvpx and
+/// libaom), lower is faster
+#[derive(Debug, Copy, Clone, PartialEq, Eq)]
+pub enum VideoEncoderComplexity {
+    Low,
+    Normal,
+    High,
+    Higher,
+    Max,
+}
+
+#[derive(Debug, Copy, Clone, Default, PartialEq, Eq)]
+pub struct VideoEncoderSettings {
+    /// Max number of threads used by each encoder, 0 lets WebRTC decide from
+    /// the number of cores
+    pub max_threads: u32,
+    pub complexity: Option<VideoEncoderComplexity>,
+}
+
 #[derive(Debug, Clone)]
 pub struct RtpCodecCapability {
     pub channels: Option<u16>,
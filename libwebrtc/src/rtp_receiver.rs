@@ -38,6 +38,31 @@ impl RtpReceiver {
     }
 }
 
+#[cfg(not(target_arch = "wasm32"))]
+impl RtpReceiver {
+    /// Per-frame stats of the video decoders, None for audio or until the SSRC
+    /// of the remote stream is known. Decoders recreated for the same stream
+    /// (e.g after a codec change) keep recording into the same stats.
+    pub fn decoder_stats(&self) -> Option<crate::native::codec_stats::CodecStats> {
+        self.handle.decoder_stats()
+    }
+
+    /// Buffer type the video decoders should output, only I420 and NV12 can
+    /// be preferred (None restores the decoder default). Decoders that can
+    /// (libvpx VP8) then decode straight into pooled buffers of that type,
+    /// which NativeVideoStream delivers without conversion.
+    /// Applied from the next keyframe. The preference is kept by the decoders
+    /// of the current stream and ends with them: a stream renegotiated with the
+    /// same SSRC, or restarted after the last sink of a lazily received track
+    /// went away, decodes to the default output until it is set again.
+    pub fn set_preferred_decoder_output(
+        &self,
+        buffer_type: Option<crate::video_frame::VideoBufferType>,
+    ) -> Result<(), RtcError> {
+        self.handle.set_preferred_decoder_output(buffer_type)
+    }
+}
+
 impl Debug for RtpReceiver {
     fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
         f.debug_struct("RtpReceiver")
@@ -15,8 +15,11 @@
 use std::fmt::Debug;
 
 use crate::{
-    imp::rtp_sender as imp_rs, media_stream_track::MediaStreamTrack, rtp_parameters::RtpParameters,
-    stats::RtcStats, RtcError,
+    imp::rtp_sender as imp_rs,
+    media_stream_track::MediaStreamTrack,
+    rtp_parameters::{RtpParameters, VideoEncoderSettings},
+    stats::RtcStats,
+    RtcError,
 };
 
 #[derive(Clone)]
@@ -46,6 +49,18 @@ impl RtpSender {
     }
 }
 
+#[cfg(not(target_arch = "wasm32"))]
+impl RtpSender {
+    /// Threads/complexity of the video encoders created for this sender.
+    /// The returned stats are filled by these encoders.
+    pub fn set_video_encoder_settings(
+        &self,
+        settings: VideoEncoderSettings,
+    ) -> crate::native::codec_stats::CodecStats {
+        self.handle.set_video_encoder_settings(settings)
+    }
+}
+
 impl Debug for RtpSender {
     fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
         f.debug_struct("RtpReceiver").field("cname", &self.parameters().rtcp.cname).finish()
@@ -209,6 +209,19 @@ impl I420Buffer {
         Self::with_strides(width, height, width, (width + 1) / 2, (width + 1) / 2)
     }
 
+    /// Scale the whole buffer to width x height
+    pub fn scale(&self, width: u32, height: u32) -> I420Buffer {
+        self.handle.scale(width, height)
+    }
+
+    /// Scale the buffer to several sizes like the simulcast layers are: a
+    /// cascade of half resolution downscales is built lazily and each size is
+    /// scaled from its closest level instead of the full resolution. A size
+    /// matching a level exactly shares its planes.
+    pub fn scale_layers(&self, sizes: &[(u32, u32)]) -> Vec<I420Buffer> {
+        self.handle.scale_layers(sizes)
+    }
+
     pub fn chroma_width(&self) -> u32 {
         self.handle.chroma_width()
     }
@@ -509,3 +522,54 @@ pub mod web {
 
     impl VideoFrameBuffer for WebGlBuffer {}
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn uniform_buffer(width: u32, height: u32) -> I420Buffer {
+        let mut buffer = I420Buffer::new(width, height);
+        let (data_y, data_u, data_v) = buffer.data_mut();
+        data_y.fill(200);
+        data_u.fill(96);
+        data_v.fill(160);
+        buffer
+    }
+
+    #[test]
+    fn test_scale_layers_sizes_in_order() {
+        let source = uniform_buffer(1280, 720);
+        let sizes = [(320, 180), (1280, 720), (960, 540), (640, 360), (480, 270)];
+        let layers = source.scale_layers(&sizes);
+
+        assert_eq!(layers.len(), sizes.len());
+        for (layer, &(width, height)) in layers.iter().zip(sizes.iter()) {
+            assert_eq!((layer.width(), layer.height()), (width, height));
+
+            let (data_y, data_u, data_v) = layer.data();
+            assert!(data_y.iter().all(|&y| y == 200));
+            assert!(data_u.iter().all(|&u| u == 96));
+            assert!(data_v.iter().all(|&v| v == 160));
+        }
+    }
+
+    #[test]
+    fn test_scale_layers_share_levels() {
+        let source = uniform_buffer(1280, 720);
+        // The half level is built for the quarter one, then reused as is
+        let layers = source.scale_layers(&[(320, 180), (640, 360), (640, 360), (1280, 720)]);
+
+        assert_eq!(layers[1].data().0.as_ptr(), layers[2].data().0.as_ptr());
+        assert_eq!(layers[3].data().0.as_ptr(), source.data().0.as_ptr());
+        assert_ne!(layers[0].data().0.as_ptr(), layers[1].data().0.as_ptr());
+    }
+
+    #[test]
+    fn test_scale_matches_scale_layers() {
+        let source = uniform_buffer(640, 480);
+        let direct = source.scale(160, 120);
+        let layers = source.scale_layers(&[(160, 120)]);
+        assert_eq!((direct.width(), direct.height()), (160, 120));
+        assert_eq!(direct.data().0, layers[0].data().0);
+    }
+}
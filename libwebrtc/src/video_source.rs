@@ -22,6 +22,43 @@ pub struct VideoResolution {
     pub height: u32,
 }
 
+#[derive(Default, Debug, Clone)]
+pub struct VideoSourceOptions {
+    /// Screen content: the track is marked as detailed content, and frames identical to the
+    /// previous one are dropped before being scaled and encoded
+    pub is_screencast: bool,
+}
+
+/// Region of a captured frame that changed since the previous frame
+#[derive(Default, Debug, Clone, Copy, PartialEq, Eq)]
+pub struct DirtyRect {
+    pub x: u32,
+    pub y: u32,
+    pub width: u32,
+    pub height: u32,
+}
+
+/// Codecs that can be published without being re-encoded
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum EncodedVideoCodec {
+    /// Annex B byte stream, keyframes must carry the SPS/PPS
+    H264,
+    VP8,
+}
+
+/// A frame encoded outside of WebRTC (e.g. received from RTMP, a file or an IP camera)
+#[derive(Debug, Clone)]
+pub struct EncodedVideoFrame<'a> {
+    pub data: &'a [u8],
+    pub codec: EncodedVideoCodec,
+    pub is_keyframe: bool,
+    pub width: u32,
+    pub height: u32,
+    pub timestamp_us: i64,
+}
+
+pub type OnKeyFrameRequest = Box<dyn FnMut() + Send + Sync>;
+
 #[non_exhaustive]
 #[derive(Debug, Clone)]
 pub enum RtcVideoSource {
@@ -64,11 +101,42 @@ pub mod native {
 
     impl NativeVideoSource {
         pub fn new(resolution: VideoResolution) -> Self {
-            Self { handle: vs_imp::NativeVideoSource::new(resolution) }
+            Self::with_options(resolution, VideoSourceOptions::default())
+        }
+
+        pub fn with_options(resolution: VideoResolution, options: VideoSourceOptions) -> Self {
+            Self { handle: vs_imp::NativeVideoSource::new(resolution, options) }
         }
 
         pub fn capture_frame<T: AsRef<dyn VideoBuffer>>(&self, frame: &VideoFrame<T>) {
-            self.handle.capture_frame(frame)
+            self.handle.capture_frame(frame, None)
+        }
+
+        /// Capture a frame along with the regions that changed since the previous frame, as
+        /// reported by the capturer. An empty slice means nothing changed.
+        pub fn capture_frame_with_dirty_rects<T: AsRef<dyn VideoBuffer>>(
+            &self,
+            frame: &VideoFrame<T>,
+            dirty_rects: &[DirtyRect],
+        ) {
+            self.handle.capture_frame(frame, Some(dirty_rects))
+        }
+
+        /// Publish an already encoded frame, it skips scaling and encoding entirely.
+        /// The track must be published with the same codec and with simulcast disabled,
+        /// delta frames are dropped until the first keyframe.
+        pub fn capture_encoded_frame(&self, frame: &EncodedVideoFrame) {
+            self.handle.capture_encoded_frame(frame)
+        }
+
+        /// Called when a receiver asks for a keyframe (PLI/FIR) while encoded frames are
+        /// published, the next captured encoded frame should be a keyframe
+        pub fn on_keyframe_request(&self, handler: Option<OnKeyFrameRequest>) {
+            self.handle.on_keyframe_request(handler)
+        }
+
+        pub fn is_screencast(&self) -> bool {
+            self.handle.is_screencast()
         }
 
         pub fn video_resolution(&self) -> VideoResolution {
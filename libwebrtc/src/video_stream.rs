@@ -26,9 +26,51 @@ pub mod native {
     };
 
     use super::stream_imp;
-    use crate::{video_frame::BoxVideoFrame, video_track::RtcVideoTrack};
+    use crate::{
+        video_frame::{BoxVideoFrame, VideoBufferType},
+        video_track::RtcVideoTrack,
+    };
     use livekit_runtime::Stream;
 
+    /// Per-sink constraints, frames are scaled and decimated natively before being
+    /// delivered to the stream. They only apply to this stream: the source (and for
+    /// local tracks, the encoder) keeps receiving the full resolution and framerate.
+    #[derive(Debug, Clone, Copy)]
+    pub struct VideoSinkWants {
+        /// Frames will be downscaled to have at most this many pixels
+        pub max_pixel_count: Option<u32>,
+        /// Preferred number of pixels, the frames are scaled as close as possible to it
+        pub target_pixel_count: Option<u32>,
+        /// Frames above this rate are dropped
+        pub max_framerate_fps: Option<u32>,
+        /// Width and height of the delivered frames will be a multiple of this value
+        pub resolution_alignment: u32,
+    }
+
+    impl Default for VideoSinkWants {
+        fn default() -> Self {
+            Self {
+                max_pixel_count: None,
+                target_pixel_count: None,
+                max_framerate_fps: None,
+                resolution_alignment: 1,
+            }
+        }
+    }
+
+    #[derive(Debug, Clone, Copy, Default)]
+    pub struct NativeVideoStreamOptions {
+        pub wants: VideoSinkWants,
+        /// Maximum number of frames waiting to be polled. When full, the oldest frame is
+        /// dropped so a slow consumer always gets the latest frames (Some(1) is a mailbox).
+        /// None means unbounded.
+        pub queue_size: Option<usize>,
+        /// Convert the frames to this format (I420 or NV12) on the thread delivering them,
+        /// into pooled buffers with a normalized stride. Frames already in that format
+        /// are delivered as is. None keeps the decoder output.
+        pub format: Option<VideoBufferType>,
+    }
+
     pub struct NativeVideoStream {
         pub(crate) handle: stream_imp::NativeVideoStream,
     }
@@ -41,13 +83,26 @@ pub mod native {
 
     impl NativeVideoStream {
         pub fn new(video_track: RtcVideoTrack) -> Self {
-            Self { handle: stream_imp::NativeVideoStream::new(video_track) }
+            Self::with_options(video_track, NativeVideoStreamOptions::default())
+        }
+
+        pub fn with_options(video_track: RtcVideoTrack, options: NativeVideoStreamOptions) -> Self {
+            Self { handle: stream_imp::NativeVideoStream::new(video_track, options) }
         }
 
         pub fn track(&self) -> RtcVideoTrack {
             self.handle.track()
         }
 
+        pub fn set_wants(&self, wants: VideoSinkWants) {
+            self.handle.set_wants(wants);
+        }
+
+        /// Number of frames dropped because the queue was full or discarded by WebRTC
+        pub fn dropped_frames(&self) -> u64 {
+            self.handle.dropped_frames()
+        }
+
         pub fn close(&mut self) {
             self.handle.close();
         }
@@ -28,6 +28,30 @@ impl RtcVideoTrack {
     media_stream_track!();
 }
 
+#[cfg(not(target_arch = "wasm32"))]
+impl RtcVideoTrack {
+    /// Pause/resume the reception of a remote track
+    pub fn set_should_receive(&self, should_receive: bool) {
+        self.handle.set_should_receive(should_receive)
+    }
+
+    pub fn should_receive(&self) -> bool {
+        self.handle.should_receive()
+    }
+
+    /// When enabled (default for remote tracks), the track is only received
+    /// and decoded while a sink (e.g NativeVideoStream) or an EncodedFrameSink
+    /// of its receiver is attached.
+    /// A keyframe is requested when the first sink is added back.
+    pub fn set_lazy_receive(&self, lazy_receive: bool) {
+        self.handle.set_lazy_receive(lazy_receive)
+    }
+
+    pub fn lazy_receive(&self) -> bool {
+        self.handle.lazy_receive()
+    }
+}
+
 impl Debug for RtcVideoTrack {
     fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
         f.debug_struct("RtcVideoTrack")
@@ -15,8 +15,8 @@
 use crate::proto::{self};
 use bytes::Bytes;
 use livekit::{
-    ByteStreamInfo, OperationType, StreamByteOptions, StreamError, StreamResult, StreamTextOptions,
-    TextStreamInfo,
+    ByteStreamInfo, OperationType, StreamByteOptions, StreamCompression, StreamError, StreamResult,
+    StreamTextOptions, TextStreamInfo,
 };
 use std::path::PathBuf;
 
@@ -56,6 +56,7 @@ impl From<ByteStreamInfo> for proto::ByteStreamInfo {
 impl From<proto::StreamTextOptions> for StreamTextOptions {
     fn from(options: proto::StreamTextOptions) -> Self {
         let operation_type = options.operation_type().into();
+        let compression = options.compression.map(|_| options.compression().into());
         Self {
             topic: options.topic,
             attributes: options.attributes,
@@ -70,12 +71,14 @@ impl From<proto::StreamTextOptions> for StreamTextOptions {
             reply_to_stream_id: options.reply_to_stream_id,
             attached_stream_ids: options.attached_stream_ids,
             generated: options.generated,
+            compression,
         }
     }
 }
 
 impl From<proto::StreamByteOptions> for StreamByteOptions {
     fn from(options: proto::StreamByteOptions) -> Self {
+        let compression = options.compression.map(|_| options.compression().into());
         Self {
             topic: options.topic,
             attributes: options.attributes,
@@ -88,6 +91,7 @@ impl From<proto::StreamByteOptions> for StreamByteOptions {
             name: options.name,
             mime_type: options.mime_type,
             total_length: options.total_length,
+            compression,
         }
     }
 }
@@ -143,6 +147,14 @@ impl From<proto::text_stream_info::OperationType> for OperationType {
     }
 }
 
+impl From<proto::StreamCompression> for StreamCompression {
+    fn from(value: proto::StreamCompression) -> Self {
+        match value {
+            proto::StreamCompression::CompressionDeflate => Self::Deflate,
+        }
+    }
+}
+
 impl From<StreamError> for proto::StreamError {
     fn from(error: StreamError) -> Self {
         Self { description: error.to_string() }
@@ -22,7 +22,10 @@ use livekit::{
     prelude::*,
     webrtc::{
         native::frame_cryptor::EncryptionState,
-        prelude::{ContinualGatheringPolicy, IceServer, IceTransportsType, RtcConfiguration},
+        prelude::{
+            ContinualGatheringPolicy, IceServer, IceTransportsType, RtcConfiguration,
+            VideoEncoderComplexity, VideoEncoderSettings,
+        },
     },
     RoomInfo,
 };
@@ -188,6 +191,9 @@ impl From<proto::RoomOptions> for RoomOptions {
         options.dynacast = value.dynacast.unwrap_or(options.dynacast);
         options.rtc_config = rtc_config;
         options.join_retries = value.join_retries.unwrap_or(options.join_retries);
+        options.video_decoder_threads = value.video_decoder_threads;
+        options.e2ee_crypto_threads = value.e2ee_crypto_threads;
+        options.encrypt_data = value.encrypt_data.unwrap_or(options.encrypt_data);
         options.e2ee = e2ee;
         options
     }
@@ -232,6 +238,10 @@ impl From<proto::TrackPublishOptions> for TrackPublishOptions {
             red: opts.red.unwrap_or(default_publish_options.red),
             simulcast: opts.simulcast.unwrap_or(default_publish_options.simulcast),
             stream: opts.stream.unwrap_or(default_publish_options.stream),
+            video_encoder_settings: opts
+                .video_encoder_settings
+                .map(Into::into)
+                .or(default_publish_options.video_encoder_settings),
         }
     }
 }
@@ -242,6 +252,27 @@ impl From<proto::VideoEncoding> for VideoEncoding {
     }
 }
 
+impl From<proto::VideoEncoderComplexity> for VideoEncoderComplexity {
+    fn from(value: proto::VideoEncoderComplexity) -> Self {
+        match value {
+            proto::VideoEncoderComplexity::ComplexityLow => Self::Low,
+            proto::VideoEncoderComplexity::ComplexityNormal => Self::Normal,
+            proto::VideoEncoderComplexity::ComplexityHigh => Self::High,
+            proto::VideoEncoderComplexity::ComplexityHigher => Self::Higher,
+            proto::VideoEncoderComplexity::ComplexityMax => Self::Max,
+        }
+    }
+}
+
+impl From<proto::VideoEncoderSettings> for VideoEncoderSettings {
+    fn from(opts: proto::VideoEncoderSettings) -> Self {
+        let complexity =
+            opts.complexity.map(|x| proto::VideoEncoderComplexity::try_from(x).ok()).flatten();
+
+        Self { max_threads: opts.max_threads.unwrap_or(0), complexity: complexity.map(Into::into) }
+    }
+}
+
 impl From<proto::AudioEncoding> for AudioEncoding {
     fn from(opts: proto::AudioEncoding) -> Self {
         Self { max_bitrate: opts.max_bitrate }
@@ -394,7 +425,7 @@ impl From<livekit_protocol::data_stream::Chunk> for proto::data_stream::Chunk {
     fn from(msg: livekit_protocol::data_stream::Chunk) -> Self {
         proto::data_stream::Chunk {
             stream_id: msg.stream_id,
-            content: msg.content,
+            content: msg.content.into(),
             chunk_index: msg.chunk_index,
             version: Some(msg.version),
             iv: msg.iv,
@@ -406,7 +437,7 @@ impl From<proto::data_stream::Chunk> for livekit_protocol::data_stream::Chunk {
     fn from(msg: proto::data_stream::Chunk) -> Self {
         livekit_protocol::data_stream::Chunk {
             stream_id: msg.stream_id,
-            content: msg.content,
+            content: msg.content.into(),
             chunk_index: msg.chunk_index,
             version: msg.version.unwrap_or(0),
             iv: msg.iv,
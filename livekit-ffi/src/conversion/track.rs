@@ -12,7 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-use livekit::{participant::ParticipantTrackPermission, prelude::*};
+use livekit::{
+    participant::ParticipantTrackPermission,
+    prelude::*,
+    webrtc::native::codec_stats::{CodecStatsSnapshot, Histogram, HistogramScale},
+};
 
 use crate::{
     proto,
@@ -158,3 +162,31 @@ impl From<AudioTrackFeature> for proto::AudioTrackFeature {
         }
     }
 }
+
+impl From<Histogram> for proto::FrameCodecHistogram {
+    fn from(value: Histogram) -> Self {
+        Self {
+            count: value.count,
+            sum: value.sum,
+            max: value.max,
+            buckets: value.buckets,
+            linear_width: match value.scale {
+                HistogramScale::Linear { width } => Some(width),
+                HistogramScale::Log2 => None,
+            },
+        }
+    }
+}
+
+impl From<CodecStatsSnapshot> for proto::FrameCodecStats {
+    fn from(value: CodecStatsSnapshot) -> Self {
+        Self {
+            frames: value.frames,
+            dropped: value.dropped,
+            errors: value.errors,
+            latency_us: value.latency_us.into(),
+            qp: value.qp.into(),
+            size_bytes: value.size_bytes.into(),
+        }
+    }
+}
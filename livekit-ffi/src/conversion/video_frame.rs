@@ -14,7 +14,10 @@
 
 use livekit::{
     options::{VideoCodec, VideoResolution},
-    webrtc::{prelude::*, video_source::VideoResolution as VideoSourceResolution},
+    webrtc::{
+        prelude::*, video_source::VideoResolution as VideoSourceResolution,
+        video_stream::native::VideoSinkWants,
+    },
 };
 
 use crate::{
@@ -28,6 +31,17 @@ impl From<proto::VideoSourceResolution> for VideoSourceResolution {
     }
 }
 
+impl From<proto::VideoSinkWants> for VideoSinkWants {
+    fn from(wants: proto::VideoSinkWants) -> Self {
+        Self {
+            max_pixel_count: wants.max_pixel_count,
+            target_pixel_count: wants.target_pixel_count,
+            max_framerate_fps: wants.max_framerate_fps,
+            resolution_alignment: wants.resolution_alignment.unwrap_or(1),
+        }
+    }
+}
+
 impl From<&FfiVideoSource> for proto::VideoSourceInfo {
     fn from(source: &FfiVideoSource) -> Self {
         Self { r#type: source.source_type as i32 }
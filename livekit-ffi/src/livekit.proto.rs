@@ -1359,6 +1359,59 @@ pub struct GetStatsCallback {
     #[prost(message, repeated, tag="3")]
     pub stats: ::prost::alloc::vec::Vec<RtcStats>,
 }
+/// Per-frame stats recorded by the video encoders (local tracks) or decoders
+/// (remote tracks), read synchronously without going through GetStats
+#[allow(clippy::derive_partial_eq_without_eq)]
+#[derive(Clone, PartialEq, ::prost::Message)]
+pub struct GetCodecStatsRequest {
+    #[prost(uint64, required, tag="1")]
+    pub track_handle: u64,
+    /// Reset the counters after reading them
+    #[prost(bool, optional, tag="2")]
+    pub reset: ::core::option::Option<bool>,
+}
+#[allow(clippy::derive_partial_eq_without_eq)]
+#[derive(Clone, PartialEq, ::prost::Message)]
+pub struct GetCodecStatsResponse {
+    #[prost(message, optional, tag="1")]
+    pub encoder: ::core::option::Option<FrameCodecStats>,
+    #[prost(message, optional, tag="2")]
+    pub decoder: ::core::option::Option<FrameCodecStats>,
+}
+#[allow(clippy::derive_partial_eq_without_eq)]
+#[derive(Clone, PartialEq, ::prost::Message)]
+pub struct FrameCodecStats {
+    /// Simulcast layers are counted separately
+    #[prost(uint64, required, tag="1")]
+    pub frames: u64,
+    #[prost(uint64, required, tag="2")]
+    pub dropped: u64,
+    #[prost(uint64, required, tag="3")]
+    pub errors: u64,
+    #[prost(message, required, tag="4")]
+    pub latency_us: FrameCodecHistogram,
+    #[prost(message, required, tag="5")]
+    pub qp: FrameCodecHistogram,
+    #[prost(message, required, tag="6")]
+    pub size_bytes: FrameCodecHistogram,
+}
+/// The last bucket also counts the values above its range
+#[allow(clippy::derive_partial_eq_without_eq)]
+#[derive(Clone, PartialEq, ::prost::Message)]
+pub struct FrameCodecHistogram {
+    #[prost(uint64, required, tag="1")]
+    pub count: u64,
+    #[prost(uint64, required, tag="2")]
+    pub sum: u64,
+    #[prost(uint64, required, tag="3")]
+    pub max: u64,
+    #[prost(uint64, repeated, packed="false", tag="4")]
+    pub buckets: ::prost::alloc::vec::Vec<u64>,
+    /// Bucket i counts [i * width, (i + 1) * width) when set, otherwise bucket 0
+    /// counts 0 and bucket i counts [2^(i - 1), 2^i)
+    #[prost(uint64, optional, tag="5")]
+    pub linear_width: ::core::option::Option<u64>,
+}
 //
 // Track
 //
@@ -1804,6 +1857,9 @@ pub struct NewVideoStreamRequest {
     /// if true, stride will be set to width/chroma_width
     #[prost(bool, optional, tag="4")]
     pub normalize_stride: ::core::option::Option<bool>,
+    /// Scale/decimate the frames natively before they're sent to the client
+    #[prost(message, optional, tag="5")]
+    pub wants: ::core::option::Option<VideoSinkWants>,
 }
 #[allow(clippy::derive_partial_eq_without_eq)]
 #[derive(Clone, PartialEq, ::prost::Message)]
@@ -1825,6 +1881,8 @@ pub struct VideoStreamFromParticipantRequest {
     pub format: ::core::option::Option<i32>,
     #[prost(bool, optional, tag="5")]
     pub normalize_stride: ::core::option::Option<bool>,
+    #[prost(message, optional, tag="6")]
+    pub wants: ::core::option::Option<VideoSinkWants>,
 }
 #[allow(clippy::derive_partial_eq_without_eq)]
 #[derive(Clone, PartialEq, ::prost::Message)]
@@ -1843,6 +1901,9 @@ pub struct NewVideoSourceRequest {
     /// Most of the time it corresponds to the source resolution 
     #[prost(message, required, tag="2")]
     pub resolution: VideoSourceResolution,
+    /// Screen content, unchanged frames are dropped before being encoded
+    #[prost(bool, optional, tag="3")]
+    pub is_screencast: ::core::option::Option<bool>,
 }
 #[allow(clippy::derive_partial_eq_without_eq)]
 #[derive(Clone, PartialEq, ::prost::Message)]
@@ -1995,6 +2056,18 @@ pub struct VideoFrameReceived {
 #[derive(Clone, PartialEq, ::prost::Message)]
 pub struct VideoStreamEos {
 }
+#[allow(clippy::derive_partial_eq_without_eq)]
+#[derive(Clone, PartialEq, ::prost::Message)]
+pub struct VideoSinkWants {
+    #[prost(uint32, optional, tag="1")]
+    pub max_pixel_count: ::core::option::Option<u32>,
+    #[prost(uint32, optional, tag="2")]
+    pub target_pixel_count: ::core::option::Option<u32>,
+    #[prost(uint32, optional, tag="3")]
+    pub max_framerate_fps: ::core::option::Option<u32>,
+    #[prost(uint32, optional, tag="4")]
+    pub resolution_alignment: ::core::option::Option<u32>,
+}
 //
 // VideoSource
 //
@@ -2787,6 +2860,9 @@ pub struct StreamTextOptions {
     pub attached_stream_ids: ::prost::alloc::vec::Vec<::prost::alloc::string::String>,
     #[prost(bool, optional, tag="9")]
     pub generated: ::core::option::Option<bool>,
+    /// Compress the chunks, only receivers supporting it can read the stream
+    #[prost(enumeration="StreamCompression", optional, tag="10")]
+    pub compression: ::core::option::Option<i32>,
 }
 #[allow(clippy::derive_partial_eq_without_eq)]
 #[derive(Clone, PartialEq, ::prost::Message)]
@@ -2805,6 +2881,9 @@ pub struct StreamByteOptions {
     pub mime_type: ::core::option::Option<::prost::alloc::string::String>,
     #[prost(uint64, optional, tag="7")]
     pub total_length: ::core::option::Option<u64>,
+    /// Compress the chunks, only receivers supporting it can read the stream
+    #[prost(enumeration="StreamCompression", optional, tag="8")]
+    pub compression: ::core::option::Option<i32>,
 }
 /// Error pertaining to a stream.
 #[allow(clippy::derive_partial_eq_without_eq)]
@@ -2814,6 +2893,31 @@ pub struct StreamError {
     #[prost(string, required, tag="1")]
     pub description: ::prost::alloc::string::String,
 }
+/// Compression of the chunks of a stream, declared to the receivers in the
+/// "lk.compression" header attribute. Readers get the decompressed content.
+#[derive(Clone, Copy, Debug, PartialEq, Eq, Hash, PartialOrd, Ord, ::prost::Enumeration)]
+#[repr(i32)]
+pub enum StreamCompression {
+    CompressionDeflate = 0,
+}
+impl StreamCompression {
+    /// String value of the enum field names used in the ProtoBuf definition.
+    ///
+    /// The values are not transformed in any way and thus are considered stable
+    /// (if the ProtoBuf definition does not change) and safe for programmatic use.
+    pub fn as_str_name(&self) -> &'static str {
+        match self {
+            StreamCompression::CompressionDeflate => "COMPRESSION_DEFLATE",
+        }
+    }
+    /// Creates an enum from field names used in the ProtoBuf definition.
+    pub fn from_str_name(value: &str) -> ::core::option::Option<Self> {
+        match value {
+            "COMPRESSION_DEFLATE" => Some(Self::CompressionDeflate),
+            _ => None,
+        }
+    }
+}
 /// Connect to a new LiveKit room
 #[allow(clippy::derive_partial_eq_without_eq)]
 #[derive(Clone, PartialEq, ::prost::Message)]
@@ -2969,6 +3073,9 @@ pub struct PublishDataRequest {
     pub topic: ::core::option::Option<::prost::alloc::string::String>,
     #[prost(string, repeated, tag="7")]
     pub destination_identities: ::prost::alloc::vec::Vec<::prost::alloc::string::String>,
+    /// lossy only, see DataPacket::coalesce_key
+    #[prost(string, optional, tag="8")]
+    pub coalesce_key: ::core::option::Option<::prost::alloc::string::String>,
 }
 #[allow(clippy::derive_partial_eq_without_eq)]
 #[derive(Clone, PartialEq, ::prost::Message)]
@@ -3232,6 +3339,15 @@ pub struct VideoEncoding {
 }
 #[allow(clippy::derive_partial_eq_without_eq)]
 #[derive(Clone, PartialEq, ::prost::Message)]
+pub struct VideoEncoderSettings {
+    /// 0 or unset = decided from the core count
+    #[prost(uint32, optional, tag="1")]
+    pub max_threads: ::core::option::Option<u32>,
+    #[prost(enumeration="VideoEncoderComplexity", optional, tag="2")]
+    pub complexity: ::core::option::Option<i32>,
+}
+#[allow(clippy::derive_partial_eq_without_eq)]
+#[derive(Clone, PartialEq, ::prost::Message)]
 pub struct AudioEncoding {
     #[prost(uint64, required, tag="1")]
     pub max_bitrate: u64,
@@ -3256,6 +3372,8 @@ pub struct TrackPublishOptions {
     pub source: ::core::option::Option<i32>,
     #[prost(string, optional, tag="8")]
     pub stream: ::core::option::Option<::prost::alloc::string::String>,
+    #[prost(message, optional, tag="9")]
+    pub video_encoder_settings: ::core::option::Option<VideoEncoderSettings>,
 }
 #[allow(clippy::derive_partial_eq_without_eq)]
 #[derive(Clone, PartialEq, ::prost::Message)]
@@ -3294,6 +3412,13 @@ pub struct RoomOptions {
     pub rtc_config: ::core::option::Option<RtcConfig>,
     #[prost(uint32, optional, tag="6")]
     pub join_retries: ::core::option::Option<u32>,
+    #[prost(uint32, optional, tag="7")]
+    pub video_decoder_threads: ::core::option::Option<u32>,
+    #[prost(uint32, optional, tag="8")]
+    pub e2ee_crypto_threads: ::core::option::Option<u32>,
+    /// encrypt data packets with the e2ee keys
+    #[prost(bool, optional, tag="9")]
+    pub encrypt_data: ::core::option::Option<bool>,
 }
 #[allow(clippy::derive_partial_eq_without_eq)]
 #[derive(Clone, PartialEq, ::prost::Message)]
@@ -3996,6 +4121,41 @@ pub struct TextStreamOpened {
 }
 #[derive(Clone, Copy, Debug, PartialEq, Eq, Hash, PartialOrd, Ord, ::prost::Enumeration)]
 #[repr(i32)]
+pub enum VideoEncoderComplexity {
+    ComplexityLow = 0,
+    ComplexityNormal = 1,
+    ComplexityHigh = 2,
+    ComplexityHigher = 3,
+    ComplexityMax = 4,
+}
+impl VideoEncoderComplexity {
+    /// String value of the enum field names used in the ProtoBuf definition.
+    ///
+    /// The values are not transformed in any way and thus are considered stable
+    /// (if the ProtoBuf definition does not change) and safe for programmatic use.
+    pub fn as_str_name(&self) -> &'static str {
+        match self {
+            VideoEncoderComplexity::ComplexityLow => "COMPLEXITY_LOW",
+            VideoEncoderComplexity::ComplexityNormal => "COMPLEXITY_NORMAL",
+            VideoEncoderComplexity::ComplexityHigh => "COMPLEXITY_HIGH",
+            VideoEncoderComplexity::ComplexityHigher => "COMPLEXITY_HIGHER",
+            VideoEncoderComplexity::ComplexityMax => "COMPLEXITY_MAX",
+        }
+    }
+    /// Creates an enum from field names used in the ProtoBuf definition.
+    pub fn from_str_name(value: &str) -> ::core::option::Option<Self> {
+        match value {
+            "COMPLEXITY_LOW" => Some(Self::ComplexityLow),
+            "COMPLEXITY_NORMAL" => Some(Self::ComplexityNormal),
+            "COMPLEXITY_HIGH" => Some(Self::ComplexityHigh),
+            "COMPLEXITY_HIGHER" => Some(Self::ComplexityHigher),
+            "COMPLEXITY_MAX" => Some(Self::ComplexityMax),
+            _ => None,
+        }
+    }
+}
+#[derive(Clone, Copy, Debug, PartialEq, Eq, Hash, PartialOrd, Ord, ::prost::Enumeration)]
+#[repr(i32)]
 pub enum IceTransportType {
     TransportRelay = 0,
     TransportNohost = 1,
@@ -4887,7 +5047,7 @@ pub struct RpcMethodInvocationEvent {
 #[allow(clippy::derive_partial_eq_without_eq)]
 #[derive(Clone, PartialEq, ::prost::Message)]
 pub struct FfiRequest {
-    #[prost(oneof="ffi_request::Message", tags="2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 48, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66")]
+    #[prost(oneof="ffi_request::Message", tags="2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 48, 67, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66")]
     pub message: ::core::option::Option<ffi_request::Message>,
 }
 /// Nested message and enum types in `FfiRequest`.
@@ -4935,6 +5095,8 @@ pub mod ffi_request {
         GetStats(super::GetStatsRequest),
         #[prost(message, tag="48")]
         SetTrackSubscriptionPermissions(super::SetTrackSubscriptionPermissionsRequest),
+        #[prost(message, tag="67")]
+        GetCodecStats(super::GetCodecStatsRequest),
         /// Video
         #[prost(message, tag="20")]
         NewVideoStream(super::NewVideoStreamRequest),
@@ -5041,7 +5203,7 @@ pub mod ffi_request {
 #[allow(clippy::derive_partial_eq_without_eq)]
 #[derive(Clone, PartialEq, ::prost::Message)]
 pub struct FfiResponse {
-    #[prost(oneof="ffi_response::Message", tags="2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 47, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65")]
+    #[prost(oneof="ffi_response::Message", tags="2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 47, 66, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65")]
     pub message: ::core::option::Option<ffi_response::Message>,
 }
 /// Nested message and enum types in `FfiResponse`.
@@ -5089,6 +5251,8 @@ pub mod ffi_response {
         GetStats(super::GetStatsResponse),
         #[prost(message, tag="47")]
         SetTrackSubscriptionPermissions(super::SetTrackSubscriptionPermissionsResponse),
+        #[prost(message, tag="66")]
+        GetCodecStats(super::GetCodecStatsResponse),
         /// Video
         #[prost(message, tag="20")]
         NewVideoStream(super::NewVideoStreamResponse),
@@ -151,6 +151,74 @@ pub unsafe fn to_libwebrtc_buffer(info: proto::VideoBufferInfo) -> BoxVideoBuffe
     }
 }
 
+/// Describe the buffer in place when it already has the requested format, so it can be
+/// forwarded to the client without any copy (the buffer itself is kept alive by its handle).
+///
+/// Only buffers produced by the native sink qualify: the planes must be contiguous with a
+/// normalized stride, like the buffers returned by to_video_buffer_info. Clients read the
+/// whole frame from data_ptr.
+pub fn borrow_video_buffer_info(
+    rtcbuffer: &BoxVideoBuffer,
+    dst_type: Option<proto::VideoBufferType>,
+) -> Option<proto::VideoBufferInfo> {
+    match (rtcbuffer.buffer_type(), dst_type) {
+        (VideoBufferType::I420, Some(proto::VideoBufferType::I420)) => {
+            let i420 = rtcbuffer.as_i420().unwrap();
+            let (width, height) = (i420.width(), i420.height());
+            let (data_y, data_u, data_v) = i420.data();
+            let (stride_y, stride_u, stride_v) = i420.strides();
+
+            let chroma_width = (width + 1) / 2;
+            let chroma_height = (height + 1) / 2;
+            let contiguous = stride_y == width
+                && stride_u == chroma_width
+                && stride_v == chroma_width
+                && data_u.as_ptr() == data_y.as_ptr().wrapping_add((stride_y * height) as usize)
+                && data_v.as_ptr()
+                    == data_u.as_ptr().wrapping_add((stride_u * chroma_height) as usize);
+            if !contiguous {
+                return None;
+            }
+
+            Some(i420_info(
+                data_y.as_ptr(),
+                data_y.as_ptr(),
+                data_u.as_ptr(),
+                data_v.as_ptr(),
+                width,
+                height,
+                stride_y,
+                stride_u,
+                stride_v,
+            ))
+        }
+        (VideoBufferType::NV12, Some(proto::VideoBufferType::Nv12)) => {
+            let nv12 = rtcbuffer.as_nv12().unwrap();
+            let (width, height) = (nv12.width(), nv12.height());
+            let (data_y, data_uv) = nv12.data();
+            let (stride_y, stride_uv) = nv12.strides();
+
+            let contiguous = stride_y == width
+                && stride_uv == (width + 1) / 2 * 2
+                && data_uv.as_ptr() == data_y.as_ptr().wrapping_add((stride_y * height) as usize);
+            if !contiguous {
+                return None;
+            }
+
+            Some(nv12_info(
+                data_y.as_ptr(),
+                data_y.as_ptr(),
+                data_uv.as_ptr(),
+                width,
+                height,
+                stride_y,
+                stride_uv,
+            ))
+        }
+        _ => None,
+    }
+}
+
 pub fn to_video_buffer_info(
     rtcbuffer: BoxVideoBuffer,
     dst_type: Option<proto::VideoBufferType>,
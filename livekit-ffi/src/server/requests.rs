@@ -18,7 +18,7 @@ use colorcvt::cvtimpl;
 use livekit::{
     prelude::*,
     register_audio_filter_plugin,
-    webrtc::{native::apm, native::audio_resampler, prelude::*},
+    webrtc::{native::apm, native::audio_resampler, native::codec_stats::CodecStats, prelude::*},
     AudioFilterPlugin,
 };
 use parking_lot::Mutex;
@@ -414,6 +414,30 @@ fn on_get_stats(
     Ok(proto::GetStatsResponse { async_id })
 }
 
+fn on_get_codec_stats(
+    server: &'static FfiServer,
+    request: proto::GetCodecStatsRequest,
+) -> FfiResult<proto::GetCodecStatsResponse> {
+    let ffi_track = server.retrieve_handle::<FfiTrack>(request.track_handle)?.clone();
+    let (encoder, decoder) = match &ffi_track.track {
+        Track::LocalVideo(track) => (track.encoder_stats(), None),
+        Track::RemoteVideo(track) => (None, track.decoder_stats()),
+        _ => (None, None),
+    };
+
+    let snapshot = |stats: Option<CodecStats>| {
+        stats.map(|stats| {
+            let snapshot = stats.snapshot();
+            if request.reset.unwrap_or(false) {
+                stats.reset();
+            }
+            snapshot.into()
+        })
+    };
+
+    Ok(proto::GetCodecStatsResponse { encoder: snapshot(encoder), decoder: snapshot(decoder) })
+}
+
 /// Create a new VideoStream, a video stream is used to receive frames from a Track
 fn on_new_video_stream(
     server: &'static FfiServer,
@@ -1233,6 +1257,9 @@ pub fn handle_request(
         proto::ffi_request::Message::GetStats(get_stats) => {
             proto::ffi_response::Message::GetStats(on_get_stats(server, get_stats)?)
         }
+        proto::ffi_request::Message::GetCodecStats(request) => {
+            proto::ffi_response::Message::GetCodecStats(on_get_codec_stats(server, request)?)
+        }
         proto::ffi_request::Message::NewVideoStream(new_stream) => {
             proto::ffi_response::Message::NewVideoStream(on_new_video_stream(server, new_stream)?)
         }
@@ -333,6 +333,7 @@ impl RoomInner {
         let reliable = publish.reliable;
         let topic = publish.topic;
         let destination_identities = publish.destination_identities;
+        let coalesce_key = publish.coalesce_key;
         let async_id = server.next_id();
 
         if let Err(err) = self.data_tx.send(FfiDataPacket {
@@ -344,6 +345,7 @@ impl RoomInner {
                     .into_iter()
                     .map(|str| str.try_into().unwrap())
                     .collect(),
+                coalesce_key,
             },
             async_id,
         }) {
@@ -34,9 +34,14 @@ impl FfiVideoSource {
         let source_inner = match source_type {
             #[cfg(not(target_arch = "wasm32"))]
             proto::VideoSourceType::VideoSourceNative => {
-                use livekit::webrtc::video_source::native::NativeVideoSource;
+                use livekit::webrtc::video_source::{
+                    native::NativeVideoSource, VideoSourceOptions,
+                };
 
-                let video_source = NativeVideoSource::new(new_source.resolution.into());
+                let options =
+                    VideoSourceOptions { is_screencast: new_source.is_screencast.unwrap_or(false) };
+                let video_source =
+                    NativeVideoSource::with_options(new_source.resolution.into(), options);
                 RtcVideoSource::Native(video_source)
             }
             _ => return Err(FfiError::InvalidRequest("unsupported video source type".into())),
@@ -15,7 +15,10 @@
 use futures_util::StreamExt;
 use livekit::{
     prelude::Track,
-    webrtc::{prelude::*, video_stream::native::NativeVideoStream},
+    webrtc::{
+        prelude::*,
+        video_stream::native::{NativeVideoStream, NativeVideoStreamOptions, VideoSinkWants},
+    },
 };
 use tokio::sync::{broadcast, mpsc, oneshot};
 
@@ -60,16 +63,35 @@ impl FfiVideoStream {
             #[cfg(not(target_arch = "wasm32"))]
             proto::VideoStreamType::VideoStreamNative => {
                 let video_stream = Self { handle_id, self_dropped_tx, stream_type };
-                let handle = server.async_runtime.spawn(Self::native_video_stream_task(
+                let wants = new_stream.wants.clone().map(VideoSinkWants::from).unwrap_or_default();
+                let dst_type = new_stream.format.and_then(|_| Some(new_stream.format()));
+                let options = Self::native_stream_options(dst_type, wants);
+                let preferred_track = match (&ffi_track.track, options.format) {
+                    (Track::RemoteVideo(track), Some(format)) => {
+                        // Have the decoder output what the sink converts to, best effort (the
+                        // SSRC isn't known before the first packets)
+                        let _ = track.set_preferred_decoder_output(Some(format));
+                        Some(track.clone())
+                    }
+                    _ => None,
+                };
+                let stream_task = Self::native_video_stream_task(
                     server,
                     handle_id,
-                    new_stream.format.and_then(|_| Some(new_stream.format())),
+                    dst_type,
                     new_stream.normalize_stride.unwrap_or(true),
-                    NativeVideoStream::new(rtc_track),
+                    NativeVideoStream::with_options(rtc_track, options),
                     self_dropped_rx,
                     server.watch_handle_dropped(new_stream.track_handle),
                     true,
-                ));
+                );
+                let handle = server.async_runtime.spawn(async move {
+                    stream_task.await;
+                    if let Some(track) = preferred_track {
+                        // Other streams may keep the decoder running
+                        let _ = track.set_preferred_decoder_output(None);
+                    }
+                });
                 server.watch_panic(handle);
                 Ok::<FfiVideoStream, FfiError>(video_stream)
             }
@@ -113,6 +135,22 @@ impl FfiVideoStream {
         Ok(proto::OwnedVideoStream { handle: proto::FfiOwnedHandle { id: handle_id }, info: info })
     }
 
+    /// Let the native sink do the planar conversion on the decoding thread, into pooled
+    /// buffers. Packed formats are left to colorcvt, which converts from the decoded
+    /// buffer in a single pass (an I420 copy first would be a second one).
+    fn native_stream_options(
+        dst_type: Option<proto::VideoBufferType>,
+        wants: VideoSinkWants,
+    ) -> NativeVideoStreamOptions {
+        let format = match dst_type {
+            Some(proto::VideoBufferType::Nv12) => Some(VideoBufferType::NV12),
+            Some(proto::VideoBufferType::I420) => Some(VideoBufferType::I420),
+            _ => None,
+        };
+
+        NativeVideoStreamOptions { wants, format, ..Default::default() }
+    }
+
     async fn native_video_stream_task(
         server: &'static server::FfiServer,
         stream_handle: FfiHandleId,
@@ -136,13 +174,19 @@ impl FfiVideoStream {
                         break;
                     };
 
-                    let Ok((buffer, info)) = colorcvt::to_video_buffer_info(frame.buffer, dst_type, normalize_stride) else {
-                        log::error!("video stream failed to convert video frame to {:?}", dst_type);
-                        continue;
-                    };
-
                     let handle_id = server.next_id();
-                    server.store_handle(handle_id, buffer);
+                    let info = if let Some(info) = colorcvt::borrow_video_buffer_info(&frame.buffer, dst_type) {
+                        // Converted into a contiguous buffer by the native sink, forward it as is
+                        server.store_handle(handle_id, frame.buffer);
+                        info
+                    } else {
+                        let Ok((buffer, info)) = colorcvt::to_video_buffer_info(frame.buffer, dst_type, normalize_stride) else {
+                            log::error!("video stream failed to convert video frame to {:?}", dst_type);
+                            continue;
+                        };
+                        server.store_handle(handle_id, buffer);
+                        info
+                    };
 
 
                     if let Err(err) = server.send_event(proto::ffi_event::Message::VideoStreamEvent(
@@ -211,6 +255,7 @@ impl FfiVideoStream {
         ));
         // track_tx is no longer held, so the track_rx will be closed when track_changed_trigger is done
 
+        let wants = request.wants.clone().map(VideoSinkWants::from).unwrap_or_default();
         loop {
             let track = track_rx.recv().await;
             if let Some(track) = track {
@@ -243,7 +288,10 @@ impl FfiVideoStream {
                         stream_handle,
                         dst_type,
                         request.normalize_stride.unwrap_or(true),
-                        NativeVideoStream::new(rtc_track),
+                        NativeVideoStream::with_options(
+                            rtc_track,
+                            Self::native_stream_options(dst_type, wants),
+                        ),
                         c_rx,
                         handle_dropped_rx,
                         false,
@@ -25,6 +25,7 @@ protoc \
     --prost_out=$OUT_RUST \
     --prost_opt=compile_well_known_types \
     --prost_opt=extern_path=.google.protobuf=::pbjson_types \
+    --prost_opt=bytes=.livekit.DataStream.Chunk.content \
     --prost-serde_out=$OUT_RUST \
     --prost-serde_opt=ignore_unknown_fields \
     $PROTOCOL/livekit_egress.proto \
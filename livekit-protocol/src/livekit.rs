@@ -1262,8 +1262,8 @@ pub mod data_stream {
         #[prost(uint64, tag="2")]
         pub chunk_index: u64,
         /// content as binary (bytes)
-        #[prost(bytes="vec", tag="3")]
-        pub content: ::prost::alloc::vec::Vec<u8>,
+        #[prost(bytes="bytes", tag="3")]
+        pub content: ::prost::bytes::Bytes,
         /// a version indicating that this chunk_index has been retroactively modified and the original one needs to be replaced
         #[prost(int32, tag="4")]
         pub version: i32,
@@ -0,0 +1,264 @@
+// Copyright 2025 LiveKit, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+use super::{StreamError, StreamResult};
+use bytes::Bytes;
+use flate2::{Compress, Compression, Decompress, FlushCompress, FlushDecompress};
+
+/// Compression applied to the chunks of a data stream.
+///
+/// The compression is declared in the stream header, only receivers
+/// supporting it can read the stream.
+///
+#[derive(Clone, Copy, Debug, Hash, Eq, PartialEq)]
+pub enum StreamCompression {
+    /// Raw deflate. The whole stream shares one compression context, each
+    /// chunk ends with a sync flush so it can be decompressed on arrival.
+    Deflate,
+}
+
+impl StreamCompression {
+    fn name(&self) -> &'static str {
+        match self {
+            Self::Deflate => "deflate",
+        }
+    }
+
+    fn from_name(name: &str) -> Option<Self> {
+        match name {
+            "deflate" => Some(Self::Deflate),
+            _ => None,
+        }
+    }
+}
+
+/// Header attribute declaring the compression of the chunks.
+const COMPRESSION_ATTRIBUTE: &str = "lk.compression";
+
+/// Declares the compression in the header attributes.
+pub(super) fn declare(
+    compression: StreamCompression,
+    attributes: &mut std::collections::HashMap<String, String>,
+) {
+    attributes.insert(COMPRESSION_ATTRIBUTE.to_owned(), compression.name().to_owned());
+}
+
+/// Removes the compression declared in the header attributes, if any.
+pub(super) fn take_declared(
+    attributes: &mut std::collections::HashMap<String, String>,
+) -> StreamResult<Option<StreamCompression>> {
+    let Some(name) = attributes.remove(COMPRESSION_ATTRIBUTE) else {
+        return Ok(None);
+    };
+    StreamCompression::from_name(&name).map(Some).ok_or(StreamError::UnsupportedCompression(name))
+}
+
+/// Upper bound of a decompressed chunk, chunks are compressed from at most
+/// CHUNK_SIZE bytes.
+const MAX_DECOMPRESSED_CHUNK_SIZE: usize = 64 * 1024;
+
+/// Empty stored block written by a sync flush.
+const SYNC_FLUSH_MARKER: [u8; 4] = [0x00, 0x00, 0xff, 0xff];
+
+pub(super) struct ChunkCompressor {
+    compress: Compress,
+}
+
+impl ChunkCompressor {
+    pub fn new(compression: StreamCompression) -> Self {
+        match compression {
+            StreamCompression::Deflate => {
+                Self { compress: Compress::new(Compression::default(), false) }
+            }
+        }
+    }
+
+    /// Compresses the next chunk of the stream.
+    pub fn compress(&mut self, chunk: &[u8]) -> StreamResult<Bytes> {
+        // Deflate never expands by more than a few bytes per block
+        let mut output = Vec::with_capacity(chunk.len() + 64);
+        let start = self.compress.total_in();
+        loop {
+            let (total_in, total_out) = (self.compress.total_in(), self.compress.total_out());
+            let consumed = (total_in - start) as usize;
+            self.compress
+                .compress_vec(&chunk[consumed..], &mut output, FlushCompress::Sync)
+                .map_err(|_| StreamError::Internal)?;
+
+            let consumed = (self.compress.total_in() - start) as usize;
+            // The flush is complete once there is output space left
+            if consumed == chunk.len() && output.len() < output.capacity() {
+                break;
+            }
+            if output.len() == output.capacity() {
+                output.reserve(1024);
+            } else if self.compress.total_in() == total_in && self.compress.total_out() == total_out
+            {
+                Err(StreamError::Internal)?
+            }
+        }
+        Ok(output.into())
+    }
+}
+
+pub(super) struct ChunkDecompressor {
+    decompress: Decompress,
+}
+
+impl ChunkDecompressor {
+    pub fn new(compression: StreamCompression) -> Self {
+        match compression {
+            StreamCompression::Deflate => Self { decompress: Decompress::new(false) },
+        }
+    }
+
+    /// Decompresses the next chunk of the stream, chunks must be given in
+    /// order.
+    pub fn decompress(&mut self, chunk: &[u8]) -> StreamResult<Bytes> {
+        // Every compressed chunk ends with the marker of its sync flush, a
+        // truncated chunk would otherwise decompress to a silent prefix
+        if !chunk.is_empty() && !chunk.ends_with(&SYNC_FLUSH_MARKER) {
+            Err(StreamError::Decompression)?
+        }
+
+        let mut output = Vec::with_capacity((chunk.len() * 4).max(1024));
+        let start = self.decompress.total_in();
+        loop {
+            let (total_in, total_out) = (self.decompress.total_in(), self.decompress.total_out());
+            let consumed = (total_in - start) as usize;
+            self.decompress
+                .decompress_vec(&chunk[consumed..], &mut output, FlushDecompress::Sync)
+                .map_err(|_| StreamError::Decompression)?;
+
+            if output.len() > MAX_DECOMPRESSED_CHUNK_SIZE {
+                Err(StreamError::Decompression)?
+            }
+
+            let consumed = (self.decompress.total_in() - start) as usize;
+            if consumed == chunk.len() && output.len() < output.capacity() {
+                break;
+            }
+            if output.len() == output.capacity() {
+                output.reserve(output.len());
+            } else if self.decompress.total_in() == total_in
+                && self.decompress.total_out() == total_out
+            {
+                // No progress with input and output space left: truncated data
+                Err(StreamError::Decompression)?
+            }
+        }
+        Ok(output.into())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::room::utils::utf8_chunk::Utf8AwareChunkExt;
+
+    fn round_trip(chunks: &[&[u8]]) {
+        let mut compressor = ChunkCompressor::new(StreamCompression::Deflate);
+        let mut decompressor = ChunkDecompressor::new(StreamCompression::Deflate);
+        for chunk in chunks {
+            let compressed = compressor.compress(chunk).unwrap();
+            assert_eq!(&decompressor.decompress(&compressed).unwrap()[..], *chunk);
+        }
+    }
+
+    #[test]
+    fn test_multi_chunk_round_trip() {
+        let text = "{\"type\":\"transcription\",\"final\":false}".repeat(2000);
+        let chunks: Vec<&[u8]> = text.as_bytes().chunks(15000).collect();
+        round_trip(&chunks);
+    }
+
+    #[test]
+    fn test_exact_capacity_round_trip() {
+        // The decompressed chunks fill their buffer exactly: 1024 bytes is the
+        // initial capacity, the others are reached by doubling it
+        let data = vec![b'a'; MAX_DECOMPRESSED_CHUNK_SIZE];
+        let sizes = [1024, 2048, 4096, MAX_DECOMPRESSED_CHUNK_SIZE, 1024];
+        let chunks: Vec<&[u8]> = sizes.iter().map(|size| &data[..*size]).collect();
+        round_trip(&chunks);
+    }
+
+    #[test]
+    fn test_incompressible_and_empty_round_trip() {
+        let noise: Vec<u8> =
+            (0..15000u32).map(|i| (i.wrapping_mul(2654435761) >> 13) as u8).collect();
+        round_trip(&[&noise, &[], &[], &noise[..100], &[]]);
+    }
+
+    #[test]
+    fn test_utf8_chunks_round_trip() {
+        let text = "Hello 👋, world 🌍! Ünïcödé text ✓ ".repeat(50);
+        let mut compressor = ChunkCompressor::new(StreamCompression::Deflate);
+        let mut decompressor = ChunkDecompressor::new(StreamCompression::Deflate);
+        let mut received = String::new();
+        for chunk in text.as_bytes().utf8_aware_chunks(7) {
+            let compressed = compressor.compress(chunk).unwrap();
+            let decompressed = decompressor.decompress(&compressed).unwrap();
+            // Each chunk stays decodable on its own
+            received.push_str(&String::from_utf8(decompressed.to_vec()).unwrap());
+        }
+        assert_eq!(received, text);
+    }
+
+    #[test]
+    fn test_corrupt_chunk() {
+        // Reserved block type
+        let mut decompressor = ChunkDecompressor::new(StreamCompression::Deflate);
+        let corrupt = [0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0xff, 0xff];
+        assert!(matches!(decompressor.decompress(&corrupt), Err(StreamError::Decompression)));
+    }
+
+    #[test]
+    fn test_truncated_chunk() {
+        let data = "truncated ".repeat(100);
+        let mut compressor = ChunkCompressor::new(StreamCompression::Deflate);
+        let compressed = compressor.compress(data.as_bytes()).unwrap();
+
+        let mut decompressor = ChunkDecompressor::new(StreamCompression::Deflate);
+        let truncated = &compressed[..compressed.len() - 2];
+        assert!(matches!(decompressor.decompress(truncated), Err(StreamError::Decompression)));
+    }
+
+    #[test]
+    fn test_oversize_chunk() {
+        // About 1KB inflating way past the chunk limit
+        let bomb = vec![0; MAX_DECOMPRESSED_CHUNK_SIZE * 16];
+        let mut compressor = ChunkCompressor::new(StreamCompression::Deflate);
+        let compressed = compressor.compress(&bomb).unwrap();
+        assert!(compressed.len() * 100 < bomb.len());
+
+        let mut decompressor = ChunkDecompressor::new(StreamCompression::Deflate);
+        assert!(matches!(decompressor.decompress(&compressed), Err(StreamError::Decompression)));
+    }
+
+    #[test]
+    fn test_declared_compression() {
+        let mut attributes = std::collections::HashMap::new();
+        assert_eq!(take_declared(&mut attributes).unwrap(), None);
+
+        declare(StreamCompression::Deflate, &mut attributes);
+        assert_eq!(take_declared(&mut attributes).unwrap(), Some(StreamCompression::Deflate));
+        assert!(attributes.is_empty());
+
+        attributes.insert(COMPRESSION_ATTRIBUTE.to_owned(), "zstd".to_owned());
+        assert!(matches!(
+            take_declared(&mut attributes),
+            Err(StreamError::UnsupportedCompression(name)) if name == "zstd"
+        ));
+    }
+}
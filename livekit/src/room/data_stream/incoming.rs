@@ -13,6 +13,7 @@
 // limitations under the License.
 
 use super::{
+    compression::{self, ChunkDecompressor},
     AnyStreamInfo, ByteStreamInfo, StreamError, StreamProgress, StreamResult, TextStreamInfo,
 };
 use crate::TakeCell;
@@ -225,6 +226,7 @@ impl AnyStreamReader {
 struct Descriptor {
     progress: StreamProgress,
     chunk_tx: UnboundedSender<StreamResult<Bytes>>,
+    decompressor: Option<ChunkDecompressor>,
     // TODO(ladvoc): keep track of open time.
 }
 
@@ -246,7 +248,12 @@ impl IncomingStreamManager {
     }
 
     /// Handles an incoming header packet.
-    pub fn handle_header(&self, header: proto::Header, identity: String) {
+    pub fn handle_header(&self, mut header: proto::Header, identity: String) {
+        let Ok(compression) = compression::take_declared(&mut header.attributes)
+            .inspect_err(|e| log::error!("Stream '{}' can't be read: {}", header.stream_id, e))
+        else {
+            return;
+        };
         let Ok(info) =
             AnyStreamInfo::try_from(header).inspect_err(|e| log::error!("Invalid header: {}", e))
         else {
@@ -265,8 +272,11 @@ impl IncomingStreamManager {
         let (reader, chunk_tx) = AnyStreamReader::from(info);
         let _ = self.open_tx.send((reader, identity));
 
-        let descriptor =
-            Descriptor { progress: StreamProgress { bytes_total, ..Default::default() }, chunk_tx };
+        let descriptor = Descriptor {
+            progress: StreamProgress { bytes_total, ..Default::default() },
+            chunk_tx,
+            decompressor: compression.map(ChunkDecompressor::new),
+        };
         inner.open_streams.insert(id, descriptor);
     }
 
@@ -283,8 +293,20 @@ impl IncomingStreamManager {
             return;
         }
 
+        // Progress and total length are in uncompressed bytes
+        let content = match descriptor.decompressor.as_mut() {
+            Some(decompressor) => match decompressor.decompress(&chunk.content) {
+                Ok(content) => content,
+                Err(e) => {
+                    inner.close_stream_with_error(&id, e);
+                    return;
+                }
+            },
+            None => chunk.content,
+        };
+
         descriptor.progress.chunk_index += 1;
-        descriptor.progress.bytes_processed += chunk.content.len() as u64;
+        descriptor.progress.bytes_processed += content.len() as u64;
 
         if match descriptor.progress.bytes_total {
             Some(total) => descriptor.progress.bytes_processed > total as u64,
@@ -293,7 +315,7 @@ impl IncomingStreamManager {
             inner.close_stream_with_error(&id, StreamError::LengthExceeded);
             return;
         }
-        inner.yield_chunk(&id, Bytes::from(chunk.content));
+        inner.yield_chunk(&id, content);
         // TODO: also yield progress
     }
 
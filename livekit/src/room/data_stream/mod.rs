@@ -17,9 +17,11 @@ use livekit_protocol::{data_stream as proto, enum_dispatch};
 use std::collections::HashMap;
 use thiserror::Error;
 
+mod compression;
 mod incoming;
 mod outgoing;
 
+pub use compression::StreamCompression;
 pub use incoming::*;
 pub use outgoing::*;
 
@@ -54,6 +56,12 @@ pub enum StreamError {
     #[error("unable to send packet")]
     SendFailed,
 
+    #[error("unsupported stream compression: {0}")]
+    UnsupportedCompression(String),
+
+    #[error("unable to decompress chunk")]
+    Decompression,
+
     #[error("I/O error: {0}")]
     Io(#[from] std::io::Error),
 
@@ -13,12 +13,15 @@
 // limitations under the License.
 
 use super::{
-    ByteStreamInfo, OperationType, StreamError, StreamProgress, StreamResult, TextStreamInfo,
+    compression::{self, ChunkCompressor},
+    ByteStreamInfo, OperationType, StreamCompression, StreamError, StreamProgress, StreamResult,
+    TextStreamInfo,
 };
 use crate::{
     id::ParticipantIdentity, rtc_engine::EngineError, utils::utf8_chunk::Utf8AwareChunkExt,
 };
 use bmrng::unbounded::{UnboundedRequestReceiver, UnboundedRequestSender};
+use bytes::Bytes;
 use chrono::Utc;
 use libwebrtc::native::create_random_uuid;
 use livekit_protocol as proto;
@@ -135,6 +138,7 @@ impl<'a> StreamWriter<'a> for TextStreamWriter {
 
 struct RawStreamOpenOptions {
     header: proto::data_stream::Header,
+    compression: Option<StreamCompression>,
     destination_identities: Vec<ParticipantIdentity>,
     packet_tx: UnboundedRequestSender<proto::DataPacket, Result<(), EngineError>>,
 }
@@ -143,14 +147,18 @@ struct RawStream {
     id: String,
     progress: StreamProgress,
     is_closed: bool,
+    compressor: Option<ChunkCompressor>,
     /// Request channel for sending packets.
     packet_tx: UnboundedRequestSender<proto::DataPacket, Result<(), EngineError>>,
 }
 
 impl RawStream {
-    async fn open(options: RawStreamOpenOptions) -> StreamResult<Self> {
+    async fn open(mut options: RawStreamOpenOptions) -> StreamResult<Self> {
         let id = options.header.stream_id.to_string();
         let bytes_total = options.header.total_length;
+        if let Some(compression) = options.compression {
+            compression::declare(compression, &mut options.header.attributes);
+        }
 
         let packet = Self::create_header_packet(options.header, options.destination_identities);
         Self::send_packet(&options.packet_tx, packet).await?;
@@ -159,13 +167,33 @@ impl RawStream {
             id,
             progress: StreamProgress { bytes_total, ..Default::default() },
             is_closed: false,
+            compressor: options.compression.map(ChunkCompressor::new),
             packet_tx: options.packet_tx,
         })
     }
 
+    /// Progress and total length are in uncompressed bytes.
+    ///
+    /// With compression, a chunk that fails to send closes the stream: the
+    /// compression context already includes it, the receivers couldn't
+    /// decompress the next chunks.
     async fn write_chunk(&mut self, bytes: &[u8]) -> StreamResult<()> {
-        let packet = Self::create_chunk_packet(&self.id, self.progress.chunk_index, bytes);
-        Self::send_packet(&self.packet_tx, packet).await?;
+        if self.is_closed {
+            Err(StreamError::AlreadyClosed)?
+        }
+        let content = match self.compressor.as_mut() {
+            Some(compressor) => compressor.compress(bytes)?,
+            None => Bytes::copy_from_slice(bytes),
+        };
+        let packet = Self::create_chunk_packet(&self.id, self.progress.chunk_index, content);
+        if let Err(err) = Self::send_packet(&self.packet_tx, packet).await {
+            if self.compressor.is_some() {
+                self.is_closed = true;
+                let trailer = Self::create_trailer_packet(&self.id, Some("chunk lost"));
+                let _ = Self::send_packet(&self.packet_tx, trailer).await;
+            }
+            Err(err)?
+        }
         self.progress.bytes_processed += bytes.len() as u64;
         self.progress.chunk_index += 1;
         Ok(())
@@ -205,11 +233,11 @@ impl RawStream {
         }
     }
 
-    fn create_chunk_packet(id: &str, chunk_index: u64, content: &[u8]) -> proto::DataPacket {
+    fn create_chunk_packet(id: &str, chunk_index: u64, content: Bytes) -> proto::DataPacket {
         let chunk = proto::data_stream::Chunk {
             stream_id: id.to_string(),
             chunk_index,
-            content: content.to_vec(),
+            content,
             ..Default::default()
         };
         proto::DataPacket {
@@ -257,6 +285,9 @@ pub struct StreamByteOptions {
     pub mime_type: Option<String>,
     pub name: Option<String>,
     pub total_length: Option<u64>,
+    /// Compress the chunks, the stream can only be read by receivers
+    /// supporting the compression. A failed write then closes the stream.
+    pub compression: Option<StreamCompression>,
 }
 
 /// Options used when opening an outgoing text data stream.
@@ -271,6 +302,9 @@ pub struct StreamTextOptions {
     pub reply_to_stream_id: Option<String>,
     pub attached_stream_ids: Vec<String>,
     pub generated: Option<bool>,
+    /// Compress the chunks, the stream can only be read by receivers
+    /// supporting the compression. A failed write then closes the stream.
+    pub compression: Option<StreamCompression>,
 }
 
 #[derive(Clone)]
@@ -308,6 +342,7 @@ impl OutgoingStreamManager {
         };
         let open_options = RawStreamOpenOptions {
             header: header.clone(),
+            compression: options.compression,
             destination_identities: options.destination_identities,
             packet_tx: self.packet_tx.clone(),
         };
@@ -335,6 +370,7 @@ impl OutgoingStreamManager {
 
         let open_options = RawStreamOpenOptions {
             header: header.clone(),
+            compression: options.compression,
             destination_identities: options.destination_identities,
             packet_tx: self.packet_tx.clone(),
         };
@@ -371,6 +407,7 @@ impl OutgoingStreamManager {
         };
         let open_options = RawStreamOpenOptions {
             header: header.clone(),
+            compression: options.compression,
             destination_identities: options.destination_identities,
             packet_tx: self.packet_tx.clone(),
         };
@@ -414,6 +451,7 @@ impl OutgoingStreamManager {
 
         let open_options = RawStreamOpenOptions {
             header: header.clone(),
+            compression: options.compression,
             destination_identities: options.destination_identities,
             packet_tx: self.packet_tx.clone(),
         };
@@ -15,7 +15,9 @@
 use std::{collections::HashMap, sync::Arc};
 
 use libwebrtc::{
-    native::frame_cryptor::{EncryptionAlgorithm, EncryptionState, FrameCryptor},
+    native::frame_cryptor::{
+        DataPacketCryptor, EncryptionAlgorithm, EncryptionState, FrameCryptor, FrameCryptorStats,
+    },
     rtp_receiver::RtpReceiver,
     rtp_sender::RtpSender,
 };
@@ -36,6 +38,7 @@ struct ManagerInner {
     options: Option<E2eeOptions>, // If Some, it means the e2ee was initialized
     enabled: bool,                // Used to enable/disable e2ee
     frame_cryptors: HashMap<(ParticipantIdentity, TrackSid), FrameCryptor>,
+    data_packet_cryptor: Option<DataPacketCryptor>,
 }
 
 #[derive(Clone)]
@@ -53,6 +56,7 @@ impl E2eeManager {
                 enabled: options.is_some(), // Enabled by default if options is provided
                 options,
                 frame_cryptors: HashMap::new(),
+                data_packet_cryptor: None,
             })),
             state_changed: Default::default(),
         }
@@ -159,6 +163,14 @@ impl E2eeManager {
         self.inner.lock().frame_cryptors.clone()
     }
 
+    /// Counters of every frame cryptor, reading them is lock-free on the
+    /// media path
+    pub fn frame_cryptor_stats(
+        &self,
+    ) -> HashMap<(ParticipantIdentity, TrackSid), FrameCryptorStats> {
+        self.inner.lock().frame_cryptors.iter().map(|(key, fc)| (key.clone(), fc.stats())).collect()
+    }
+
     pub fn enabled(&self) -> bool {
         self.inner.lock().enabled && self.initialized()
     }
@@ -179,6 +191,20 @@ impl E2eeManager {
         inner.options.as_ref().map(|opts| opts.key_provider.clone())
     }
 
+    /// Encrypts data packets with the keys used for the media, None if e2ee
+    /// isn't initialized. The session uses it on the user packets when
+    /// RoomOptions::encrypt_data is set.
+    pub fn data_packet_cryptor(&self) -> Option<DataPacketCryptor> {
+        let mut inner = self.inner.lock();
+        let key_provider = inner.options.as_ref()?.key_provider.handle.clone();
+        Some(
+            inner
+                .data_packet_cryptor
+                .get_or_insert_with(|| DataPacketCryptor::new(key_provider))
+                .clone(),
+        )
+    }
+
     pub fn encryption_type(&self) -> EncryptionType {
         let inner = self.inner.lock();
         inner.options.as_ref().map(|opts| opts.encryption_type).unwrap_or(EncryptionType::None)
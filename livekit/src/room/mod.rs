@@ -15,6 +15,7 @@
 use bmrng::unbounded::UnboundedRequestReceiver;
 use libwebrtc::{
     native::frame_cryptor::EncryptionState,
+    peer_connection_factory::native::PeerConnectionFactoryExt,
     prelude::{
         ContinualGatheringPolicy, IceTransportsType, MediaStream, MediaStreamTrack,
         RtcConfiguration,
@@ -49,8 +50,8 @@ use crate::{
     prelude::*,
     registered_audio_filter_plugins,
     rtc_engine::{
-        EngineError, EngineEvent, EngineEvents, EngineOptions, EngineResult, RtcEngine,
-        SessionStats, INITIAL_BUFFERED_AMOUNT_LOW_THRESHOLD,
+        lk_runtime::LkRuntime, EngineError, EngineEvent, EngineEvents, EngineOptions, EngineResult,
+        RtcEngine, SessionStats, INITIAL_BUFFERED_AMOUNT_LOW_THRESHOLD,
     },
 };
 
@@ -251,6 +252,9 @@ pub struct DataPacket {
     pub topic: Option<String>,
     pub reliable: bool,
     pub destination_identities: Vec<ParticipantIdentity>,
+    /// Lossy packets only, latest value wins: while this packet is waiting
+    /// to be sent, a newer packet with the same topic and key replaces it
+    pub coalesce_key: Option<String>,
 }
 
 impl Default for DataPacket {
@@ -260,6 +264,7 @@ impl Default for DataPacket {
             topic: None,
             reliable: false,
             destination_identities: Vec::new(),
+            coalesce_key: None,
         }
     }
 }
@@ -355,6 +360,17 @@ pub struct RoomOptions {
     pub join_retries: u32,
     pub sdk_options: RoomSdkOptions,
     pub preregistration: Option<PreRegistration>,
+    /// Max number of threads of each video decoder. The decoders are created
+    /// by a factory shared with the other rooms of the process, so this
+    /// applies to them as well.
+    pub video_decoder_threads: Option<u32>,
+    /// Number of threads encrypting/decrypting the media frames when E2EE is
+    /// enabled (2 by default). Shared with the other rooms as well.
+    pub e2ee_crypto_threads: Option<u32>,
+    /// Encrypt the payload of the data packets (publish_data) with the E2EE
+    /// keys as well, requires `e2ee`. Every participant of the room must
+    /// enable it: packets that can't be decrypted are dropped.
+    pub encrypt_data: bool,
 }
 
 #[derive(Debug, Clone)]
@@ -382,6 +398,9 @@ impl Default for RoomOptions {
             join_retries: 3,
             sdk_options: RoomSdkOptions::default(),
             preregistration: None,
+            video_decoder_threads: None,
+            e2ee_crypto_threads: None,
+            encrypt_data: false,
         }
     }
 }
@@ -468,6 +487,16 @@ impl Room {
         options: RoomOptions,
     ) -> RoomResult<(Self, mpsc::UnboundedReceiver<RoomEvent>)> {
         // TODO(theomonnom): move connection logic to the RoomSession
+        // Held until the engine keeps its own reference, the factory would be
+        // recreated otherwise
+        let lk_runtime = LkRuntime::instance();
+        if let Some(threads) = options.video_decoder_threads {
+            lk_runtime.pc_factory().set_video_decoder_threads(threads);
+        }
+        if let Some(threads) = options.e2ee_crypto_threads {
+            lk_runtime.pc_factory().set_crypto_threads(threads);
+        }
+
         let e2ee_manager = E2eeManager::new(options.e2ee.clone());
         let mut signal_options = SignalOptions::default();
         signal_options.sdk_options = options.sdk_options.clone().into();
@@ -480,6 +509,10 @@ impl Room {
                 rtc_config: options.rtc_config.clone(),
                 signal_options,
                 join_retries: options.join_retries,
+                data_cryptor: options
+                    .encrypt_data
+                    .then(|| e2ee_manager.data_packet_cryptor())
+                    .flatten(),
             },
         )
         .await?;
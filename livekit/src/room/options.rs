@@ -85,6 +85,10 @@ pub struct TrackPublishOptions {
     // pub name: String,
     pub source: TrackSource,
     pub stream: String,
+    /// Encoder threads/complexity of this track, useful to trade quality for
+    /// density when running many encoders on the same machine. None keeps the
+    /// WebRTC defaults
+    pub video_encoder_settings: Option<VideoEncoderSettings>,
 }
 
 impl Default for TrackPublishOptions {
@@ -98,6 +102,7 @@ impl Default for TrackPublishOptions {
             simulcast: true,
             source: TrackSource::Unknown,
             stream: "".to_string(),
+            video_encoder_settings: None,
         }
     }
 }
@@ -492,7 +492,19 @@ impl LocalParticipant {
             ..Default::default()
         };
 
-        self.inner.rtc_engine.publish_data(data, kind).await.map_err(Into::into)
+        match packet.coalesce_key {
+            Some(key) if kind == DataPacketKind::Lossy => {
+                self.inner.rtc_engine.publish_coalesced_data(data, key).await.map_err(Into::into)
+            }
+            _ => self.inner.rtc_engine.publish_data(data, kind).await.map_err(Into::into),
+        }
+    }
+
+    /// Number of lossy packets replaced by a newer one before being sent,
+    /// per topic (see DataPacket::coalesce_key). The counts belong to the
+    /// current RTC session, a full reconnect starts them from zero.
+    pub fn coalesced_data_counts(&self) -> HashMap<String, u64> {
+        self.inner.rtc_engine.session().coalesced_data_counts()
     }
 
     pub fn set_data_channel_buffered_amount_low_threshold(
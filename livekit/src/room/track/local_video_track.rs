@@ -14,7 +14,7 @@
 
 use std::{fmt::Debug, sync::Arc};
 
-use libwebrtc::{prelude::*, stats::RtcStats};
+use libwebrtc::{native::codec_stats::CodecStats, prelude::*, stats::RtcStats};
 use livekit_protocol as proto;
 
 use super::TrackInner;
@@ -127,6 +127,11 @@ impl LocalVideoTrack {
         super::local_track::get_stats(&self.inner).await
     }
 
+    /// Per-frame stats of the encoders of this track, available once published
+    pub fn encoder_stats(&self) -> Option<CodecStats> {
+        self.inner.info.read().codec_stats.clone()
+    }
+
     pub(crate) fn on_muted(&self, f: impl Fn(Track) + Send + 'static) {
         self.inner.events.lock().muted.replace(Box::new(f));
     }
@@ -143,6 +148,10 @@ impl LocalVideoTrack {
         self.inner.info.write().transceiver = transceiver;
     }
 
+    pub(crate) fn set_encoder_stats(&self, stats: Option<CodecStats>) {
+        self.inner.info.write().codec_stats = stats;
+    }
+
     pub(crate) fn update_info(&self, info: proto::TrackInfo) {
         super::update_info(&self.inner, &Track::LocalVideo(self.clone()), info);
     }
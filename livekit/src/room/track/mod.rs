@@ -14,7 +14,7 @@
 
 use std::{fmt::Debug, sync::Arc};
 
-use libwebrtc::{prelude::*, stats::RtcStats};
+use libwebrtc::{native::codec_stats::CodecStats, prelude::*, stats::RtcStats};
 use livekit_protocol::enum_dispatch;
 use livekit_protocol::{self as proto};
 use parking_lot::{Mutex, RwLock};
@@ -145,6 +145,7 @@ struct TrackInfo {
     pub stream_state: StreamState,
     pub muted: bool,
     pub transceiver: Option<RtpTransceiver>,
+    pub codec_stats: Option<CodecStats>, // encoder stats of local video tracks
     pub audio_features: Vec<proto::AudioTrackFeature>,
 }
 
@@ -169,6 +170,7 @@ pub(super) fn new_inner(
             stream_state: StreamState::Active,
             muted: false,
             transceiver: None,
+            codec_stats: None,
             audio_features: Vec::new(),
         }),
         rtc_track,
@@ -14,7 +14,7 @@
 
 use std::{fmt::Debug, sync::Arc};
 
-use libwebrtc::{prelude::*, stats::RtcStats};
+use libwebrtc::{native::encoded_frame_sink::EncodedFrameSink, prelude::*, stats::RtcStats};
 use livekit_protocol::{self as proto, AudioTrackFeature};
 
 use super::{remote_track, TrackInner};
@@ -98,6 +98,11 @@ impl RemoteAudioTrack {
         super::remote_track::get_stats(&self.inner).await
     }
 
+    /// Tap the received frames before decoding, see [EncodedFrameSink]
+    pub fn encoded_frame_sink(&self, suppress_decoding: bool) -> RoomResult<EncodedFrameSink> {
+        super::remote_track::encoded_frame_sink(&self.inner, suppress_decoding)
+    }
+
     pub(crate) fn on_muted(&self, f: impl Fn(Track) + Send + 'static) {
         self.inner.events.lock().muted.replace(Box::new(f));
     }
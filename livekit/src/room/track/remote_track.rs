@@ -14,7 +14,7 @@
 
 use std::sync::Arc;
 
-use libwebrtc::{prelude::*, stats::RtcStats};
+use libwebrtc::{native::encoded_frame_sink::EncodedFrameSink, prelude::*, stats::RtcStats};
 use livekit_protocol as proto;
 use livekit_protocol::enum_dispatch;
 
@@ -44,6 +44,13 @@ impl RemoteTrack {
             Self::Video(track) => track.get_stats().await,
         }
     }
+
+    pub fn encoded_frame_sink(&self, suppress_decoding: bool) -> RoomResult<EncodedFrameSink> {
+        match self {
+            Self::Audio(track) => track.encoded_frame_sink(suppress_decoding),
+            Self::Video(track) => track.encoded_frame_sink(suppress_decoding),
+        }
+    }
 }
 
 pub(super) async fn get_stats(inner: &Arc<TrackInner>) -> RoomResult<Vec<RtcStats>> {
@@ -55,6 +62,18 @@ pub(super) async fn get_stats(inner: &Arc<TrackInner>) -> RoomResult<Vec<RtcStat
     Ok(transceiver.receiver().get_stats().await?)
 }
 
+pub(super) fn encoded_frame_sink(
+    inner: &Arc<TrackInner>,
+    suppress_decoding: bool,
+) -> RoomResult<EncodedFrameSink> {
+    let transceiver = inner.info.read().transceiver.clone();
+    let Some(transceiver) = transceiver.as_ref() else {
+        return Err(RoomError::Internal("no transceiver found for track".into()));
+    };
+
+    Ok(EncodedFrameSink::new(&transceiver.receiver(), suppress_decoding)?)
+}
+
 pub(super) fn update_info(inner: &Arc<TrackInner>, track: &Track, new_info: proto::TrackInfo) {
     super::update_info(inner, track, new_info.clone());
     super::set_muted(inner, track, new_info.muted);
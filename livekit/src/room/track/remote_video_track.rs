@@ -14,7 +14,11 @@
 
 use std::{fmt::Debug, sync::Arc};
 
-use libwebrtc::{prelude::*, stats::RtcStats};
+use libwebrtc::{
+    native::{codec_stats::CodecStats, encoded_frame_sink::EncodedFrameSink},
+    prelude::*,
+    stats::RtcStats,
+};
 use livekit_protocol as proto;
 
 use super::{remote_track, TrackInner};
@@ -98,6 +102,34 @@ impl RemoteVideoTrack {
         super::remote_track::get_stats(&self.inner).await
     }
 
+    /// Tap the received frames before decoding, see [EncodedFrameSink]
+    /// The track keeps being received while the sink is alive, even without a
+    /// video sink attached
+    pub fn encoded_frame_sink(&self, suppress_decoding: bool) -> RoomResult<EncodedFrameSink> {
+        super::remote_track::encoded_frame_sink(&self.inner, suppress_decoding)
+    }
+
+    /// Per-frame stats of the decoder of this track, None until the track is
+    /// bound to its receiver
+    pub fn decoder_stats(&self) -> Option<CodecStats> {
+        let transceiver = self.inner.info.read().transceiver.clone();
+        transceiver.and_then(|transceiver| transceiver.receiver().decoder_stats())
+    }
+
+    /// Decode into I420 or NV12 buffers, see
+    /// [RtpReceiver::set_preferred_decoder_output]
+    pub fn set_preferred_decoder_output(
+        &self,
+        buffer_type: Option<VideoBufferType>,
+    ) -> RoomResult<()> {
+        let transceiver = self.inner.info.read().transceiver.clone();
+        let Some(transceiver) = transceiver else {
+            return Err(RoomError::Internal("no transceiver found for track".into()));
+        };
+
+        Ok(transceiver.receiver().set_preferred_decoder_output(buffer_type)?)
+    }
+
     pub(crate) fn on_muted(&self, f: impl Fn(Track) + Send + 'static) {
         self.inner.events.lock().muted.replace(Box::new(f));
     }
@@ -14,7 +14,7 @@
 
 use std::{borrow::Cow, fmt::Debug, sync::Arc, time::Duration};
 
-use libwebrtc::prelude::*;
+use libwebrtc::{native::frame_cryptor::DataPacketCryptor, prelude::*};
 use livekit_api::signal_client::{SignalError, SignalOptions};
 use livekit_protocol as proto;
 use livekit_runtime::{interval, Interval, JoinHandle};
@@ -80,6 +80,9 @@ pub struct EngineOptions {
     pub rtc_config: RtcConfiguration,
     pub signal_options: SignalOptions,
     pub join_retries: u32,
+    /// Encrypts the payload of the user packets sent, and decrypts the ones
+    /// received
+    pub data_cryptor: Option<DataPacketCryptor>,
 }
 
 #[derive(Debug)]
@@ -255,6 +258,21 @@ impl RtcEngine {
         session.publish_data(data, kind).await
     }
 
+    /// Publish a lossy packet replacing the queued one with the same topic
+    /// and key, if any
+    pub async fn publish_coalesced_data(
+        &self,
+        data: proto::DataPacket,
+        key: String,
+    ) -> EngineResult<()> {
+        let (session, _r_lock) = {
+            let (handle, _r_lock) = self.inner.wait_reconnection().await?;
+            (handle.session.clone(), _r_lock)
+        };
+
+        session.publish_coalesced_data(data, key).await
+    }
+
     pub async fn simulate_scenario(&self, scenario: SimulateScenario) -> EngineResult<()> {
         let (session, _r_lock) = {
             let (handle, _r_lock) = self.inner.wait_reconnection().await?;
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+use bytes::Bytes;
 use libwebrtc::{self as rtc, prelude::*};
 use livekit_protocol as proto;
 use tokio::sync::mpsc;
@@ -48,7 +49,7 @@ pub enum RtcEvent {
         target: proto::SignalTarget,
     },
     Data {
-        data: Vec<u8>,
+        data: Bytes,
         binary: bool,
     },
     DataChannelBufferedAmountChange {
@@ -90,7 +91,7 @@ fn on_data_channel(
     emitter: RtcEmitter,
 ) -> rtc::peer_connection::OnDataChannel {
     Box::new(move |data_channel| {
-        data_channel.on_message(Some(on_message(emitter.clone())));
+        data_channel.on_message_bytes(Some(on_message(emitter.clone())));
 
         let _ = emitter.send(RtcEvent::DataChannel { data_channel, target });
     })
@@ -140,9 +141,9 @@ pub fn forward_pc_events(transport: &mut PeerTransport, rtc_emitter: RtcEmitter)
     transport.on_offer(Some(on_offer(signal_target, rtc_emitter)));
 }
 
-fn on_message(emitter: RtcEmitter) -> rtc::data_channel::OnMessage {
-    Box::new(move |buffer| {
-        let _ = emitter.send(RtcEvent::Data { data: buffer.data.to_vec(), binary: buffer.binary });
+fn on_message(emitter: RtcEmitter) -> rtc::data_channel::OnMessageBytes {
+    Box::new(move |data, binary| {
+        let _ = emitter.send(RtcEvent::Data { data, binary });
     })
 }
 
@@ -158,6 +159,6 @@ fn on_buffered_amount_change(
 }
 
 pub fn forward_dc_events(dc: &mut DataChannel, kind: DataPacketKind, rtc_emitter: RtcEmitter) {
-    dc.on_message(Some(on_message(rtc_emitter.clone())));
+    dc.on_message_bytes(Some(on_message(rtc_emitter.clone())));
     dc.on_buffered_amount_change(Some(on_buffered_amount_change(rtc_emitter, dc.clone(), kind)));
 }
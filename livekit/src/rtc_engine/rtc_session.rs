@@ -24,7 +24,12 @@ use std::{
     time::Duration,
 };
 
-use libwebrtc::{prelude::*, stats::RtcStats};
+use libwebrtc::{
+    data_channel::DataSendBatch,
+    native::frame_cryptor::{DATA_PACKET_IV_SIZE, DATA_PACKET_TAG_SIZE},
+    prelude::*,
+    stats::RtcStats,
+};
 use livekit_api::signal_client::{SignalClient, SignalEvent, SignalEvents};
 use livekit_protocol as proto;
 use livekit_runtime::{sleep, JoinHandle};
@@ -60,6 +65,11 @@ pub const RELIABLE_DC_LABEL: &str = "_reliable";
 pub const PUBLISHER_NEGOTIATION_FREQUENCY: Duration = Duration::from_millis(150);
 pub const INITIAL_BUFFERED_AMOUNT_LOW_THRESHOLD: u64 = 2 * 1024 * 1024;
 
+// Encrypted user payloads end with the IV, its length and the key index (same
+// trailer as the media frames), after the ciphertext and its tag
+const DATA_TRAILER_SIZE: usize = DATA_PACKET_IV_SIZE + 2;
+const DATA_KEY_INDEX: i32 = 0; // same as the frame cryptors
+
 #[derive(Debug)]
 enum NegotiationState {
     Idle,
@@ -188,10 +198,93 @@ pub enum SessionEvent {
 
 #[derive(Debug)]
 enum DataChannelEvent {
-    PublishData(proto::DataPacket, DataPacketKind, oneshot::Sender<Result<(), EngineError>>),
+    PublishData(QueuedPacket),
     BufferedAmountChange(u64, DataPacketKind),
 }
 
+#[derive(Debug)]
+struct QueuedPacket {
+    packet: proto::DataPacket,
+    kind: DataPacketKind,
+    coalesce_key: Option<(String, String)>, // (topic, key)
+    tx: oneshot::Sender<Result<(), EngineError>>,
+}
+
+/// IV and key index of an encrypted payload, and the length of its ciphertext
+/// and tag
+fn split_data_trailer(payload: &[u8]) -> Option<([u8; DATA_PACKET_IV_SIZE], i32, usize)> {
+    let len =
+        payload.len().checked_sub(DATA_PACKET_TAG_SIZE + DATA_TRAILER_SIZE)? + DATA_PACKET_TAG_SIZE;
+    let trailer = &payload[len..];
+    if trailer[DATA_PACKET_IV_SIZE] as usize != DATA_PACKET_IV_SIZE {
+        return None;
+    }
+
+    let iv = trailer[..DATA_PACKET_IV_SIZE].try_into().ok()?;
+    Some((iv, trailer[DATA_PACKET_IV_SIZE + 1] as i32, len))
+}
+
+/// Resolve the senders of a batch with the result of their packet, in order.
+/// A sender without a result (short result list) gets an error. Returns the
+/// bytes that didn't make it to the data channel buffer.
+fn resolve_batch(
+    sent: Vec<(oneshot::Sender<Result<(), EngineError>>, usize)>,
+    results: Vec<Result<(), DataChannelError>>,
+) -> u64 {
+    let mut results = results.into_iter();
+    let mut unsent = 0;
+    for (tx, len) in sent {
+        let result = results.next().unwrap_or(Err(DataChannelError::Send));
+        if result.is_err() {
+            unsent += len as u64;
+        }
+        let _ = tx.send(result.map_err(|err| {
+            EngineError::Internal(format!("failed to send data packet: {:?}", err).into())
+        }));
+    }
+    unsent
+}
+
+/// Packets waiting for room in the data channel buffer. A packet with a
+/// coalesce key takes the place of the queued one with the same key.
+#[derive(Default)]
+struct DataQueue {
+    packets: VecDeque<QueuedPacket>,
+    popped: u64, // index of packets[0] since the queue was created
+    coalescing: HashMap<(String, String), u64>,
+}
+
+impl DataQueue {
+    /// Returns the topic if the packet replaced a queued one
+    fn push(&mut self, queued: QueuedPacket) -> Option<String> {
+        let Some(coalesce_key) = queued.coalesce_key.as_ref() else {
+            self.packets.push_back(queued);
+            return None;
+        };
+
+        if let Some(index) = self.coalescing.get(coalesce_key) {
+            let previous = &mut self.packets[(index - self.popped) as usize];
+            previous.packet = queued.packet;
+            // Never sent but superseded, same outcome as a lost lossy packet
+            let _ = std::mem::replace(&mut previous.tx, queued.tx).send(Ok(()));
+            return queued.coalesce_key.map(|(topic, _)| topic);
+        }
+
+        self.coalescing.insert(coalesce_key.clone(), self.popped + self.packets.len() as u64);
+        self.packets.push_back(queued);
+        None
+    }
+
+    fn pop(&mut self) -> Option<QueuedPacket> {
+        let queued = self.packets.pop_front()?;
+        if let Some(coalesce_key) = queued.coalesce_key.as_ref() {
+            self.coalescing.remove(coalesce_key);
+        }
+        self.popped += 1;
+        Some(queued)
+    }
+}
+
 #[derive(Serialize, Deserialize)]
 #[serde(rename_all = "camelCase")]
 struct IceCandidateJson {
@@ -203,6 +296,7 @@ struct IceCandidateJson {
 /// Fields shared with rtc_task and signal_task
 struct SessionInner {
     signal_client: Arc<SignalClient>,
+    local_identity: String,
     has_published: AtomicBool,
     fast_publish: AtomicBool,
 
@@ -218,6 +312,9 @@ struct SessionInner {
     reliable_dc: DataChannel,
     reliable_dc_buffered_amount_low_threshold: AtomicU64,
     dc_emitter: mpsc::UnboundedSender<DataChannelEvent>,
+    // Lossy packets replaced by a newer one, per topic. Reset by a full
+    // reconnect, which creates a new session
+    coalesced_data: Mutex<HashMap<String, u64>>,
 
     // Keep a strong reference to the subscriber datachannels,
     // so we can receive data from other participants
@@ -299,6 +396,11 @@ impl RtcSession {
             DataChannelInit { ordered: true, ..DataChannelInit::default() },
         )?;
 
+        // Only wake data_channel_task when the buffered amount drops to the
+        // threshold, not for every chunk sent
+        lossy_dc.set_buffered_amount_low_threshold(Some(INITIAL_BUFFERED_AMOUNT_LOW_THRESHOLD));
+        reliable_dc.set_buffered_amount_low_threshold(Some(INITIAL_BUFFERED_AMOUNT_LOW_THRESHOLD));
+
         // Forward events received inside the signaling thread to our rtc channel
         rtc_events::forward_pc_events(&mut publisher_pc, rtc_emitter.clone());
         rtc_events::forward_pc_events(&mut subscriber_pc, rtc_emitter.clone());
@@ -307,7 +409,11 @@ impl RtcSession {
 
         let (close_tx, close_rx) = watch::channel(false);
 
+        let local_identity =
+            join_response.participant.as_ref().map(|p| p.identity.clone()).unwrap_or_default();
+
         let inner = Arc::new(SessionInner {
+            local_identity,
             has_published: Default::default(),
             fast_publish: AtomicBool::new(join_response.fast_publish),
             signal_client,
@@ -323,6 +429,7 @@ impl RtcSession {
                 INITIAL_BUFFERED_AMOUNT_LOW_THRESHOLD,
             ),
             dc_emitter,
+            coalesced_data: Default::default(),
             sub_lossy_dc: Mutex::new(None),
             sub_reliable_dc: Mutex::new(None),
             closed: Default::default(),
@@ -395,7 +502,23 @@ impl RtcSession {
         data: proto::DataPacket,
         kind: DataPacketKind,
     ) -> Result<(), EngineError> {
-        self.inner.publish_data(data, kind).await
+        self.inner.publish_data(data, kind, None).await
+    }
+
+    pub async fn publish_coalesced_data(
+        &self,
+        data: proto::DataPacket,
+        key: String,
+    ) -> Result<(), EngineError> {
+        let topic = match data.value.as_ref() {
+            Some(proto::data_packet::Value::User(user)) => user.topic.clone().unwrap_or_default(),
+            _ => String::new(),
+        };
+        self.inner.publish_data(data, DataPacketKind::Lossy, Some((topic, key))).await
+    }
+
+    pub fn coalesced_data_counts(&self) -> HashMap<String, u64> {
+        self.inner.coalesced_data.lock().clone()
     }
 
     pub async fn restart(&self) -> EngineResult<proto::ReconnectResponse> {
@@ -464,6 +587,10 @@ impl RtcSession {
                 .reliable_dc_buffered_amount_low_threshold
                 .store(threshold, Ordering::Relaxed),
         }
+        self.inner
+            .data_channel(SignalTarget::Publisher, kind)
+            .unwrap()
+            .set_buffered_amount_low_threshold(Some(threshold));
         let _ = self
             .inner
             .emitter
@@ -572,8 +699,8 @@ impl SessionInner {
     ) {
         let mut lossy_buffered_amount = 0;
         let mut reliable_buffered_amount = 0;
-        let mut lossy_queue = VecDeque::new();
-        let mut reliable_queue = VecDeque::new();
+        let mut lossy_queue = DataQueue::default();
+        let mut reliable_queue = DataQueue::default();
 
         loop {
             tokio::select! {
@@ -584,16 +711,18 @@ impl SessionInner {
                     };
 
                     match event {
-                        DataChannelEvent::PublishData(packet, kind, tx) => {
-                            let data = packet.encode_to_vec();
-                            match kind {
+                        DataChannelEvent::PublishData(queued) => {
+                            // Encoded when sent, directly into the buffer given to WebRTC
+                            match queued.kind {
                                 DataPacketKind::Lossy => {
-                                    lossy_queue.push_back((data, kind, tx));
+                                    if let Some(topic) = lossy_queue.push(queued) {
+                                        *self.coalesced_data.lock().entry(topic).or_default() += 1;
+                                    }
                                     let threshold = self.lossy_dc_buffered_amount_low_threshold.load(Ordering::Relaxed);
                                     self._send_until_threshold(threshold, &mut lossy_buffered_amount, &mut lossy_queue);
                                 }
                                 DataPacketKind::Reliable => {
-                                    reliable_queue.push_back((data, kind, tx));
+                                    reliable_queue.push(queued);
                                     let threshold = self.reliable_dc_buffered_amount_low_threshold.load(Ordering::Relaxed);
                                     self._send_until_threshold(threshold, &mut reliable_buffered_amount, &mut reliable_queue);
                                 }
@@ -640,24 +769,78 @@ impl SessionInner {
         self: &Arc<Self>,
         threshold: u64,
         buffered_amount: &mut u64,
-        queue: &mut VecDeque<(Vec<u8>, DataPacketKind, oneshot::Sender<Result<(), EngineError>>)>,
+        queue: &mut DataQueue,
     ) {
+        // The packets of a queue share the same data channel, they are handed
+        // over together (one hop to the network thread)
+        let mut batch = DataSendBatch::new();
+        let mut sent = Vec::new();
+        let mut batch_kind = None;
         while *buffered_amount <= threshold {
-            let Some((data, kind, tx)) = queue.pop_front() else {
+            let Some(QueuedPacket { mut packet, kind, tx, .. }) = queue.pop() else {
                 break;
             };
 
-            *buffered_amount += data.len() as u64;
-            let result = self
-                .data_channel(SignalTarget::Publisher, kind)
-                .unwrap()
-                .send(&data, true)
-                .map_err(|err| {
-                    EngineError::Internal(format!("failed to send data packet: {:?}", err).into())
-                });
+            if let Err(err) = self.encrypt_data(&mut packet) {
+                let _ = tx.send(Err(EngineError::Internal(
+                    format!("failed to encrypt data packet: {:?}", err).into(),
+                )));
+                continue;
+            }
 
-            let _ = tx.send(result);
+            let len = packet.encoded_len();
+            *buffered_amount += len as u64;
+            // Binary messages can't fail, the buffer is exactly encoded_len bytes
+            let _ = batch.push_with(len, true, |mut buf| {
+                let _ = packet.encode(&mut buf);
+            });
+            batch_kind = Some(kind);
+            sent.push((tx, len));
         }
+
+        let Some(kind) = batch_kind else {
+            return;
+        };
+
+        let results = self.data_channel(SignalTarget::Publisher, kind).unwrap().send_batch(batch);
+        // Failed packets never reach the buffer, on_buffered_amount_change
+        // won't report them
+        let unsent = resolve_batch(sent, results);
+        *buffered_amount = buffered_amount.saturating_sub(unsent);
+    }
+
+    /// Encrypt the payload of a user packet in place when data encryption is
+    /// enabled, the trailer fits in the capacity reserved up front
+    fn encrypt_data(&self, packet: &mut proto::DataPacket) -> Result<(), RtcError> {
+        let (Some(cryptor), Some(proto::data_packet::Value::User(user))) =
+            (self.options.data_cryptor.as_ref(), packet.value.as_mut())
+        else {
+            return Ok(());
+        };
+
+        user.payload.reserve(DATA_PACKET_TAG_SIZE + DATA_TRAILER_SIZE);
+        let iv = cryptor.encrypt(&self.local_identity, DATA_KEY_INDEX, &mut user.payload)?;
+        user.payload.extend_from_slice(&iv);
+        user.payload.extend_from_slice(&[DATA_PACKET_IV_SIZE as u8, DATA_KEY_INDEX as u8]);
+        Ok(())
+    }
+
+    /// Decrypt a received user payload in place, it is truncated to the
+    /// plaintext
+    fn decrypt_data(&self, identity: Option<&str>, payload: &mut Vec<u8>) -> Result<(), RtcError> {
+        let Some(cryptor) = self.options.data_cryptor.as_ref() else {
+            return Ok(());
+        };
+
+        let invalid = |message: &str| RtcError {
+            error_type: RtcErrorType::InvalidState,
+            message: message.to_owned(),
+        };
+        let identity = identity.ok_or_else(|| invalid("unknown sender"))?;
+        let (iv, key_index, len) =
+            split_data_trailer(payload).ok_or_else(|| invalid("payload isn't encrypted"))?;
+        payload.truncate(len);
+        cryptor.decrypt(identity, key_index, &iv, payload)
     }
 
     async fn on_signal_event(&self, event: proto::signal_response::Message) -> EngineResult<()> {
@@ -830,8 +1013,11 @@ impl SessionInner {
                     Err(EngineError::Internal("text messages aren't supported".into()))?;
                 }
 
-                let data = proto::DataPacket::decode(&*data).unwrap();
-                if let Some(packet) = data.value.as_ref() {
+                // Decoded from the buffer WebRTC received the message in,
+                // bytes fields (stream chunks) reference it without copying
+                let mut data = proto::DataPacket::decode(data).unwrap();
+                let kind = data.kind();
+                if let Some(packet) = data.value.as_mut() {
                     match packet {
                         proto::data_packet::Value::User(user) => {
                             let participant_sid = user
@@ -848,12 +1034,23 @@ impl SessionInner {
                                 None
                             };
 
+                            if let Err(err) = self
+                                .decrypt_data(participant_identity.as_deref(), &mut user.payload)
+                            {
+                                log::warn!(
+                                    "dropping data packet from {:?}: {}",
+                                    participant_identity,
+                                    err.message
+                                );
+                                return Ok(());
+                            }
+
                             let _ = self.emitter.send(SessionEvent::Data {
-                                kind: data.kind().into(),
+                                kind: kind.into(),
                                 participant_sid: participant_sid.map(|s| s.try_into().unwrap()),
                                 participant_identity: participant_identity
                                     .map(|s| s.try_into().unwrap()),
-                                payload: user.payload.clone(),
+                                payload: std::mem::take(&mut user.payload),
                                 topic: user.topic.clone(),
                             });
                         }
@@ -950,7 +1147,7 @@ impl SessionInner {
                         }
                         proto::data_packet::Value::StreamChunk(message) => {
                             let _ = self.emitter.send(SessionEvent::DataStreamChunk {
-                                chunk: message.clone(),
+                                chunk: std::mem::take(message),
                                 participant_identity: data.participant_identity.clone(),
                             });
                         }
@@ -1067,6 +1264,14 @@ impl SessionInner {
             matched.append(&mut partial_matched);
 
             transceiver.set_codec_preferences(matched)?;
+
+            // The selector also gives the encoders their stats, so it is set on
+            // every sender. The default settings keep the WebRTC configuration
+            let settings = options.video_encoder_settings.unwrap_or_default();
+            let stats = transceiver.sender().set_video_encoder_settings(settings);
+            if let LocalTrack::Video(video_track) = &track {
+                video_track.set_encoder_stats(Some(stats));
+            }
         }
 
         Ok(transceiver)
@@ -1178,13 +1383,15 @@ impl SessionInner {
 
     async fn publish_data(
         self: &Arc<Self>,
-        data: proto::DataPacket,
+        packet: proto::DataPacket,
         kind: DataPacketKind,
+        coalesce_key: Option<(String, String)>,
     ) -> Result<(), EngineError> {
         self.ensure_publisher_connected(kind).await?;
 
         let (tx, rx) = oneshot::channel();
-        if let Err(err) = self.dc_emitter.send(DataChannelEvent::PublishData(data, kind, tx)) {
+        let queued = QueuedPacket { packet, kind, coalesce_key, tx };
+        if let Err(err) = self.dc_emitter.send(DataChannelEvent::PublishData(queued)) {
             return Err(EngineError::Internal(
                 format!("failed to push data into queue: {:?}", err).into(),
             ));
@@ -1446,3 +1653,151 @@ macro_rules! make_rtc_config {
 
 make_rtc_config!(make_rtc_config_join, proto::JoinResponse);
 make_rtc_config!(make_rtc_config_reconnect, proto::ReconnectResponse);
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn queued(
+        payload: &str,
+        coalesce_key: Option<(&str, &str)>,
+    ) -> (QueuedPacket, oneshot::Receiver<Result<(), EngineError>>) {
+        let (tx, rx) = oneshot::channel();
+        let packet = proto::DataPacket {
+            value: Some(proto::data_packet::Value::User(proto::UserPacket {
+                payload: payload.as_bytes().to_vec().into(),
+                ..Default::default()
+            })),
+            ..Default::default()
+        };
+        let coalesce_key = coalesce_key.map(|(topic, key)| (topic.to_owned(), key.to_owned()));
+        (QueuedPacket { packet, kind: DataPacketKind::Lossy, coalesce_key, tx }, rx)
+    }
+
+    fn pop_payload(queue: &mut DataQueue) -> Option<String> {
+        let queued = queue.pop()?;
+        match queued.packet.value {
+            Some(proto::data_packet::Value::User(user)) => {
+                Some(String::from_utf8(user.payload[..].to_vec()).unwrap())
+            }
+            _ => None,
+        }
+    }
+
+    #[test]
+    fn test_split_data_trailer() {
+        let mut payload = b"hello".to_vec();
+        payload.extend_from_slice(&[0xaa; DATA_PACKET_TAG_SIZE]);
+        payload.extend_from_slice(&[7; DATA_PACKET_IV_SIZE]);
+        payload.extend_from_slice(&[DATA_PACKET_IV_SIZE as u8, 3]);
+
+        let (iv, key_index, len) = split_data_trailer(&payload).unwrap();
+        assert_eq!(iv, [7; DATA_PACKET_IV_SIZE]);
+        assert_eq!(key_index, 3);
+        assert_eq!(len, 5 + DATA_PACKET_TAG_SIZE);
+
+        // Too short for a tag and a trailer, or a clear payload
+        assert!(split_data_trailer(&payload[..DATA_PACKET_TAG_SIZE + 1]).is_none());
+        assert!(split_data_trailer(&[0u8; 64]).is_none());
+    }
+
+    #[test]
+    fn test_batch_failure_in_the_middle() {
+        let (first, mut first_rx) = oneshot::channel();
+        let (second, mut second_rx) = oneshot::channel();
+        let (third, mut third_rx) = oneshot::channel();
+
+        let unsent = resolve_batch(
+            vec![(first, 10), (second, 20), (third, 30)],
+            vec![Ok(()), Err(DataChannelError::Send), Ok(())],
+        );
+
+        assert_eq!(unsent, 20);
+        assert!(matches!(first_rx.try_recv(), Ok(Ok(()))));
+        assert!(matches!(second_rx.try_recv(), Ok(Err(EngineError::Internal(_)))));
+        assert!(matches!(third_rx.try_recv(), Ok(Ok(()))));
+    }
+
+    #[test]
+    fn test_batch_missing_results() {
+        let (first, mut first_rx) = oneshot::channel();
+        let (second, mut second_rx) = oneshot::channel();
+
+        // Every sender is resolved even if fewer results came back
+        let unsent = resolve_batch(vec![(first, 10), (second, 20)], vec![Ok(())]);
+
+        assert_eq!(unsent, 20);
+        assert!(matches!(first_rx.try_recv(), Ok(Ok(()))));
+        assert!(matches!(second_rx.try_recv(), Ok(Err(EngineError::Internal(_)))));
+    }
+
+    #[test]
+    fn test_replacement_keeps_position() {
+        let mut queue = DataQueue::default();
+        assert_eq!(queue.push(queued("a1", Some(("cursor", "a"))).0), None);
+        assert_eq!(queue.push(queued("b", None).0), None);
+        assert_eq!(queue.push(queued("a2", Some(("cursor", "a"))).0), Some("cursor".to_owned()));
+
+        assert_eq!(pop_payload(&mut queue).as_deref(), Some("a2"));
+        assert_eq!(pop_payload(&mut queue).as_deref(), Some("b"));
+        assert_eq!(pop_payload(&mut queue), None);
+    }
+
+    #[test]
+    fn test_replaced_sender_resolves() {
+        let mut queue = DataQueue::default();
+        let (first, mut first_rx) = queued("a1", Some(("cursor", "a")));
+        let (second, mut second_rx) = queued("a2", Some(("cursor", "a")));
+        queue.push(first);
+        assert!(first_rx.try_recv().is_err());
+
+        queue.push(second);
+        assert!(matches!(first_rx.try_recv(), Ok(Ok(()))));
+        // Resolved once sent
+        assert!(second_rx.try_recv().is_err());
+    }
+
+    #[test]
+    fn test_key_reused_after_pop() {
+        let mut queue = DataQueue::default();
+        queue.push(queued("x", None).0);
+        queue.push(queued("a1", Some(("cursor", "a"))).0);
+        assert_eq!(pop_payload(&mut queue).as_deref(), Some("x"));
+        assert_eq!(pop_payload(&mut queue).as_deref(), Some("a1"));
+
+        // The key left the queue with its packet
+        assert_eq!(queue.push(queued("a2", Some(("cursor", "a"))).0), None);
+        queue.push(queued("y", None).0);
+        assert_eq!(queue.push(queued("a3", Some(("cursor", "a"))).0), Some("cursor".to_owned()));
+
+        assert_eq!(pop_payload(&mut queue).as_deref(), Some("a3"));
+        assert_eq!(pop_payload(&mut queue).as_deref(), Some("y"));
+        assert_eq!(pop_payload(&mut queue), None);
+    }
+
+    #[test]
+    fn test_coalesced_topics() {
+        let mut queue = DataQueue::default();
+        let mut counts = HashMap::<String, u64>::new();
+        let packets = [
+            ("cursor", "alice"),
+            ("cursor", "bob"),
+            ("cursor", "alice"),
+            ("volume", "alice"),
+            ("cursor", "alice"),
+            ("volume", "alice"),
+        ];
+        for (index, (topic, key)) in packets.into_iter().enumerate() {
+            if let Some(topic) = queue.push(queued(&index.to_string(), Some((topic, key))).0) {
+                *counts.entry(topic).or_default() += 1;
+            }
+        }
+
+        // Same key on different topics doesn't coalesce
+        assert_eq!(counts, HashMap::from([("cursor".to_owned(), 2), ("volume".to_owned(), 1)]));
+        assert_eq!(pop_payload(&mut queue).as_deref(), Some("4"));
+        assert_eq!(pop_payload(&mut queue).as_deref(), Some("1"));
+        assert_eq!(pop_payload(&mut queue).as_deref(), Some("5"));
+        assert_eq!(pop_payload(&mut queue), None);
+    }
+}
@@ -123,6 +123,8 @@ fn main() {
         "src/audio_track.rs",
         "src/video_track.rs",
         "src/data_channel.rs",
+        "src/codec_stats.rs",
+        "src/encoded_frame_sink.rs",
         "src/frame_cryptor.rs",
         "src/jsep.rs",
         "src/candidate.rs",
@@ -165,6 +167,15 @@ fn main() {
         "src/frame_cryptor.cpp",
         "src/global_task_queue.cpp",
         "src/prohibit_libsrtp_initialization.cpp",
+        "src/scaling_pyramid.cpp",
+        "src/passthrough_video_encoder.cpp",
+        "src/video_encoder_overrides.cpp",
+        "src/passthrough_audio_encoder.cpp",
+        "src/audio_encoder_factory.cpp",
+        "src/lazy_video_decoder.cpp",
+        "src/encoded_frame_sink.cpp",
+        "src/codec_stats.cpp",
+        "src/instrumented_video_codec.cpp",
     ]);
 
     let webrtc_dir = webrtc_sys_build::webrtc_dir();
@@ -194,6 +205,7 @@ fn main() {
         abseil_include,
         webrtc_include.join("third_party/libyuv/include/"),
         webrtc_include.join("third_party/libc++/"),
+        webrtc_include.join("third_party/boringssl/src/include/"),
     ]);
 
     // Configure Abseil behavior for custom/system installation
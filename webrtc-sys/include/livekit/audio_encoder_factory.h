@@ -0,0 +1,46 @@
+/*
+ * Copyright 2023 LiveKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the “License”);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an “AS IS” BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "api/audio_codecs/audio_encoder_factory.h"
+#include "api/scoped_refptr.h"
+
+namespace livekit {
+
+// Builtin encoders, with Opus wrapped into a PassthroughAudioEncoder
+class AudioEncoderFactory : public webrtc::AudioEncoderFactory {
+ public:
+  AudioEncoderFactory();
+
+  std::vector<webrtc::AudioCodecSpec> GetSupportedEncoders() override;
+
+  absl::optional<webrtc::AudioCodecInfo> QueryAudioEncoder(
+      const webrtc::SdpAudioFormat& format) override;
+
+  std::unique_ptr<webrtc::AudioEncoder> MakeAudioEncoder(
+      int payload_type,
+      const webrtc::SdpAudioFormat& format,
+      absl::optional<webrtc::AudioCodecPairId> codec_pair_id) override;
+
+ private:
+  rtc::scoped_refptr<webrtc::AudioEncoderFactory> factory_;
+};
+
+}  // namespace livekit
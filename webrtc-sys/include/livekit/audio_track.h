@@ -17,6 +17,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "api/audio/audio_frame.h"
 #include "api/audio_options.h"
@@ -37,6 +38,7 @@ class AudioTrack;
 class NativeAudioSink;
 class AudioTrackSource;
 class SourceContext;
+class EncodedAudioChannel;
 
 using CompleteCallback = void (*)(const livekit::SourceContext*);
 }  // namespace livekit
@@ -123,9 +125,20 @@ class AudioTrackSource {
                        const SourceContext* ctx,
                        void (*on_complete)(const SourceContext*));
 
+    bool capture_encoded_frame(rust::Slice<const uint8_t> data,
+                               uint32_t duration_ms);
+
     void clear_buffer();
 
    private:
+    // Local sinks (NativeAudioSink) get silence in place of the encoded
+    // markers, only the PassthroughAudioEncoder understands them
+    void send_block(const int16_t* data,
+                    int sample_rate,
+                    size_t number_of_channels,
+                    size_t number_of_frames)
+        RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
     mutable webrtc::Mutex mutex_;
     std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter> audio_queue_;
     webrtc::RepeatingTaskHandle audio_task_;
@@ -139,6 +152,14 @@ class AudioTrackSource {
     int missed_frames_ RTC_GUARDED_BY(mutex_) = 0;
     int16_t* silence_buffer_ = nullptr;
 
+    // Opus packets are queued on encoded_channel_, the sinks only get its
+    // markers. Set by the last captured frame, reset by PCM frames and
+    // clear_buffer
+    bool encoded_ RTC_GUARDED_BY(mutex_) = false;
+    std::shared_ptr<EncodedAudioChannel> encoded_channel_;
+    std::vector<int16_t> empty_marker_;
+    std::vector<int16_t> silent_block_;
+
     int sample_rate_;
     int num_channels_;
     int queue_size_samples_;
@@ -165,6 +186,10 @@ class AudioTrackSource {
                      const SourceContext* ctx,
                      CompleteCallback on_complete) const;
 
+  // Already encoded Opus packet, the source must be 48kHz mono
+  bool capture_encoded_frame(rust::Slice<const uint8_t> data,
+                             uint32_t duration_ms) const;
+
   void clear_buffer() const;
 
   rtc::scoped_refptr<InternalSource> get() const;
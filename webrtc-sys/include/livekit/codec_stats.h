@@ -0,0 +1,88 @@
+/*
+ * Copyright 2023 LiveKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the “License”);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an “AS IS” BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "rust/cxx.h"
+
+namespace livekit {
+class CodecStats;
+}  // namespace livekit
+#include "webrtc-sys/src/codec_stats.rs.h"
+
+namespace livekit {
+
+// Fixed size histogram updated with relaxed atomics, safe to record into from
+// the codec threads while being read from Rust.
+// kLinear: bucket i counts [i * width, (i + 1) * width)
+// kLog2: bucket 0 counts 0, bucket i counts [2^(i - 1), 2^i)
+// The last bucket also counts everything above its range.
+class AtomicHistogram {
+ public:
+  enum class Scale { kLinear, kLog2 };
+
+  AtomicHistogram(Scale scale, uint64_t width, size_t buckets);
+
+  void Add(uint64_t value);
+  HistogramSnapshot Snapshot() const;
+  void Reset();
+
+ private:
+  size_t BucketIndex(uint64_t value) const;
+
+  const Scale scale_;
+  const uint64_t width_;
+  const size_t size_;
+  std::unique_ptr<std::atomic<uint64_t>[]> buckets_;
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> max_{0};
+};
+
+// Per-frame statistics of the encoders of an RtpSender, or of the decoders
+// of an RtpReceiver.
+class CodecStats {
+ public:
+  CodecStats();
+
+  // qp < 0 when unknown
+  void RecordFrame(int64_t latency_us, int qp, size_t size_bytes);
+  void RecordDropped();
+  void RecordError();
+
+  CodecStatsSnapshot snapshot() const;
+  void reset() const;
+
+ private:
+  mutable AtomicHistogram latency_us_;
+  mutable AtomicHistogram qp_;
+  mutable AtomicHistogram size_bytes_;
+  mutable std::atomic<uint64_t> frames_{0};
+  mutable std::atomic<uint64_t> dropped_{0};
+  mutable std::atomic<uint64_t> errors_{0};
+};
+
+// Decoders are created without knowing their receiver. The stats of a
+// received stream are shared under its SSRC by the decoders decoding it and
+// the receivers reading them, and released with the last of them. Only
+// looked up once per decoder and when a receiver reads them, never per frame.
+std::shared_ptr<CodecStats> SharedDecoderStats(uint32_t ssrc);
+
+}  // namespace livekit
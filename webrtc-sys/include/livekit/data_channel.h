@@ -16,8 +16,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <limits>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include "api/data_channel_interface.h"
 #include "livekit/webrtc.h"
@@ -26,6 +29,9 @@
 
 namespace livekit {
 class DataChannel;
+class DataSendBuffer;
+class DataSendBatch;
+class DataReceiveBuffer;
 }  // namespace livekit
 #include "webrtc-sys/src/data_channel.rs.h"
 
@@ -35,6 +41,62 @@ class NativeDataChannelObserver;
 
 webrtc::DataChannelInit to_native_data_channel_init(DataChannelInit init);
 
+// Outgoing message written in place from Rust, then moved into the
+// DataBuffer given to the channel (CopyOnWriteBuffer is ref counted, so
+// the bytes are never copied)
+class DataSendBuffer {
+ public:
+  explicit DataSendBuffer(size_t size) : buffer_(size) {}
+
+  rust::Slice<uint8_t> data() {
+    return rust::Slice<uint8_t>(buffer_.MutableData(), buffer_.size());
+  }
+
+  rtc::CopyOnWriteBuffer release() { return std::move(buffer_); }
+
+ private:
+  rtc::CopyOnWriteBuffer buffer_;
+};
+
+std::unique_ptr<DataSendBuffer> new_data_send_buffer(size_t size);
+
+// Messages handed to the channel together, see DataChannel::send_batch
+class DataSendBatch {
+ public:
+  // Buffer of the new message, to be written in place
+  rust::Slice<uint8_t> add(size_t size, bool binary) {
+    buffers_.emplace_back(rtc::CopyOnWriteBuffer(size), binary);
+    return rust::Slice<uint8_t>(buffers_.back().data.MutableData(), size);
+  }
+
+  // Drop the last message (invalid text)
+  void pop() { buffers_.pop_back(); }
+
+  size_t len() const { return buffers_.size(); }
+
+  const std::vector<webrtc::DataBuffer>& buffers() const { return buffers_; }
+
+ private:
+  std::vector<webrtc::DataBuffer> buffers_;
+};
+
+std::unique_ptr<DataSendBatch> new_data_send_batch();
+
+// Incoming message handed to Rust, it keeps a reference on the buffer
+// WebRTC received the message in instead of copying the bytes
+class DataReceiveBuffer {
+ public:
+  explicit DataReceiveBuffer(rtc::CopyOnWriteBuffer buffer)
+      : buffer_(std::move(buffer)) {}
+
+  rust::Slice<const uint8_t> data() const {
+    return rust::Slice<const uint8_t>(buffer_.cdata(), buffer_.size());
+  }
+
+ private:
+  rtc::CopyOnWriteBuffer buffer_;
+};
+
 class DataChannel {
  public:
   explicit DataChannel(
@@ -45,14 +107,30 @@ class DataChannel {
   void register_observer(rust::Box<DataChannelObserverWrapper> observer) const;
   void unregister_observer() const;
   bool send(const DataBuffer& buffer) const;
+  bool send_buffer(std::unique_ptr<DataSendBuffer> buffer, bool binary) const;
+
+  // Send every message of the batch in a single hop to the network thread,
+  // one result per message
+  rust::Vec<bool> send_batch(std::unique_ptr<DataSendBatch> batch) const;
   int id() const;
   rust::String label() const;
   DataState state() const;
   void close() const;
   uint64_t buffered_amount() const;
 
+  // Once set, the observer only reports buffered amount changes when the
+  // amount goes from above the threshold to below or equal to it (or
+  // down to 0), with the bytes sent since the last report. Otherwise every
+  // change is reported.
+  void set_buffered_amount_low_threshold(uint64_t threshold) const;
+  uint64_t buffered_amount_low_threshold() const;
+
+  static constexpr uint64_t kNoThreshold =
+      std::numeric_limits<uint64_t>::max();
+
  private:
   mutable webrtc::Mutex mutex_;
+  mutable std::atomic<uint64_t> buffered_amount_low_threshold_{kNoThreshold};
   std::shared_ptr<RtcRuntime> rtc_runtime_;
   rtc::scoped_refptr<webrtc::DataChannelInterface> data_channel_;
   mutable std::unique_ptr<NativeDataChannelObserver> observer_;
@@ -74,6 +152,7 @@ class NativeDataChannelObserver : public webrtc::DataChannelObserver {
  private:
   rust::Box<DataChannelObserverWrapper> observer_;
   const DataChannel* dc_;
+  uint64_t unreported_sent_ = 0;  // network thread
 };
 
 }  // namespace livekit
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2023 LiveKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the “License”);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an “AS IS” BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+
+#include "absl/types/optional.h"
+#include "api/frame_transformer_interface.h"
+#include "api/media_types.h"
+#include "api/rtp_receiver_interface.h"
+#include "api/scoped_refptr.h"
+#include "livekit/rtp_receiver.h"
+#include "livekit/video_track.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rust/cxx.h"
+
+namespace livekit {
+class EncodedFrameSink;
+}  // namespace livekit
+#include "webrtc-sys/src/encoded_frame_sink.rs.h"
+
+namespace livekit {
+
+// Frame transformer handing the received (depacketized) frames to Rust
+// before they reach the decoder. When decoding is suppressed, the payload is
+// stripped and the LazyVideoDecoder skips the frame (video only, audio frames
+// are always forwarded as is).
+class EncodedFrameTap : public webrtc::FrameTransformerInterface {
+ public:
+  EncodedFrameTap(bool is_video,
+                  rust::Box<EncodedFrameSinkWrapper> observer,
+                  bool suppress_decoding);
+
+  void Transform(
+      std::unique_ptr<webrtc::TransformableFrameInterface> frame) override;
+
+  void RegisterTransformedFrameCallback(
+      rtc::scoped_refptr<webrtc::TransformedFrameCallback> callback) override;
+  void RegisterTransformedFrameSinkCallback(
+      rtc::scoped_refptr<webrtc::TransformedFrameCallback> callback,
+      uint32_t ssrc) override;
+  void UnregisterTransformedFrameCallback() override;
+  void UnregisterTransformedFrameSinkCallback(uint32_t ssrc) override;
+
+  // Returns true when decoding of a video stream resumes
+  bool set_suppress_decoding(bool suppress);
+  bool suppress_decoding() const;
+
+  // The transformer can't be removed from the receiver, once detached the
+  // frames are forwarded untouched
+  void detach();
+
+ private:
+  const bool is_video_;
+  mutable webrtc::Mutex mutex_;
+  absl::optional<rust::Box<EncodedFrameSinkWrapper>> observer_;
+  bool suppress_decoding_;
+  rtc::scoped_refptr<webrtc::TransformedFrameCallback> callback_;
+  std::map<uint32_t, rtc::scoped_refptr<webrtc::TransformedFrameCallback>>
+      sink_callbacks_;
+};
+
+// Replaces any transformer previously set on the receiver, so it can't be
+// created on a receiver decrypted by a FrameCryptor.
+// A video sink keeps its lazily received track running (see
+// VideoTrack::add_receive_hold) until it is dropped.
+class EncodedFrameSink {
+ public:
+  EncodedFrameSink(rtc::scoped_refptr<webrtc::RtpReceiverInterface> receiver,
+                   std::shared_ptr<VideoTrack> video_track,
+                   rust::Box<EncodedFrameSinkWrapper> observer,
+                   bool suppress_decoding);
+  ~EncodedFrameSink();
+
+  // Resuming the decoding requests a keyframe, so does dropping the sink
+  // while decoding is suppressed
+  void set_suppress_decoding(bool suppress) const;
+  bool suppress_decoding() const;
+
+ private:
+  void RequestKeyFrame() const;
+
+  rtc::scoped_refptr<webrtc::RtpReceiverInterface> receiver_;
+  std::shared_ptr<VideoTrack> video_track_;  // null for audio
+  rtc::scoped_refptr<EncodedFrameTap> tap_;
+};
+
+// Throws when the receiver has a FrameCryptor
+std::shared_ptr<EncodedFrameSink> new_encoded_frame_sink(
+    std::shared_ptr<RtpReceiver> receiver,
+    rust::Box<EncodedFrameSinkWrapper> observer,
+    bool suppress_decoding);
+
+}  // namespace livekit
@@ -18,26 +18,92 @@
 
 #include <stdint.h>
 
+#include <atomic>
+#include <deque>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "api/crypto/frame_crypto_transformer.h"
+#include "api/frame_transformer_interface.h"
 #include "api/scoped_refptr.h"
+#include "livekit/codec_stats.h"
 #include "livekit/peer_connection.h"
 #include "livekit/peer_connection_factory.h"
 #include "livekit/rtp_receiver.h"
 #include "livekit/rtp_sender.h"
 #include "livekit/webrtc.h"
 #include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/thread_annotations.h"
+#include "rtc_base/time_utils.h"
 #include "rust/cxx.h"
 
 namespace livekit {
 
 struct KeyProviderOptions;
+struct FrameCryptorStats;
 enum class Algorithm : ::std::int32_t;
 class RtcFrameCryptorObserverWrapper;
 class NativeFrameCryptorObserver;
+enum class FrameCryptionState : ::std::int32_t;
+
+// Derives the next ratchet steps of each key on a background thread. A
+// ratchet is two PBKDF2 runs: one for the next material, one for the
+// encryption key of that material. The prefetch saves the first one, the
+// second still runs on the caller thread when the material is installed
+// (SetKey derives it, WebRTC doesn't take a precomputed key).
+// The derivations run on a separate provider built with the same options,
+// the ratchet function stays the one of WebRTC. Windows left unused for
+// kWindowIdleTimeoutUs (e.g departed participants) are evicted.
+class RatchetPrefetcher {
+ public:
+  RatchetPrefetcher(const webrtc::KeyProviderOptions& options, size_t depth);
+  ~RatchetPrefetcher();
+
+  // Restart the window of a key from the material now installed. An empty
+  // participant_id is the shared key.
+  void Reset(const std::string& participant_id,
+             int index,
+             std::vector<uint8_t> material);
+
+  // Next ratchet step of `current`, empty if it isn't derived yet or if
+  // `current` isn't the material the window started from (the key was
+  // ratcheted elsewhere, e.g. by a FrameCryptor after a decryption failure)
+  std::vector<uint8_t> Take(const std::string& participant_id,
+                            int index,
+                            const std::vector<uint8_t>& current);
+
+ private:
+  using WindowKey = std::pair<std::string, int>;
+
+  struct Window {
+    uint64_t generation = 0;
+    std::vector<uint8_t> current;
+    std::deque<std::vector<uint8_t>> next;
+    bool filling = false;
+    bool shadow_synced = false;  // shadow_ holds the last derived step
+    int64_t last_used_us = 0;
+  };
+
+  static constexpr int64_t kWindowIdleTimeoutUs =
+      10 * 60 * rtc::kNumMicrosecsPerSec;
+
+  // Runs on thread_
+  void Fill(WindowKey key, uint64_t generation);
+
+  void EvictIdleWindows(int64_t now_us) RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const size_t depth_;
+  std::unique_ptr<rtc::Thread> thread_;
+  rtc::scoped_refptr<webrtc::DefaultKeyProviderImpl> shadow_;
+
+  webrtc::Mutex mutex_;
+  std::map<WindowKey, Window> windows_ RTC_GUARDED_BY(mutex_);
+  uint64_t next_generation_ RTC_GUARDED_BY(mutex_) = 1;
+  int64_t last_eviction_us_ RTC_GUARDED_BY(mutex_) = 0;
+};
 
 /// Shared secret key for frame encryption.
 class KeyProvider {
@@ -48,12 +114,19 @@ class KeyProvider {
   bool set_shared_key(int32_t index, rust::Vec<::std::uint8_t> key) const {
     std::vector<uint8_t> key_vec;
     std::copy(key.begin(), key.end(), std::back_inserter(key_vec));
-    return impl_->SetSharedKey(index, key_vec);
+    webrtc::MutexLock lock(&ratchet_mutex_);
+    if (!impl_->SetSharedKey(index, key_vec)) {
+      return false;
+    }
+    if (prefetcher_) {
+      prefetcher_->Reset("", index, std::move(key_vec));
+    }
+    return true;
   }
 
   rust::Vec<::std::uint8_t> ratchet_shared_key(int32_t key_index) const {
     rust::Vec<uint8_t> vec;
-    auto data = impl_->RatchetSharedKey(key_index);
+    auto data = RatchetKey("", key_index);
     if (data.empty()) {
       throw std::runtime_error("ratchet_shared_key failed");
     }
@@ -79,15 +152,21 @@ class KeyProvider {
                rust::Vec<::std::uint8_t> key) const {
     std::vector<uint8_t> key_vec;
     std::copy(key.begin(), key.end(), std::back_inserter(key_vec));
-    return impl_->SetKey(
-        std::string(participant_id.data(), participant_id.size()), index,
-        key_vec);
+    std::string id(participant_id.data(), participant_id.size());
+    webrtc::MutexLock lock(&ratchet_mutex_);
+    if (!impl_->SetKey(id, index, key_vec)) {
+      return false;
+    }
+    if (prefetcher_ && !id.empty()) {
+      prefetcher_->Reset(id, index, std::move(key_vec));
+    }
+    return true;
   }
 
   rust::Vec<::std::uint8_t> ratchet_key(const ::rust::String participant_id,
                                         int32_t key_index) const {
     rust::Vec<uint8_t> vec;
-    auto data = impl_->RatchetKey(
+    auto data = RatchetKey(
         std::string(participant_id.data(), participant_id.size()), key_index);
     if (data.empty()) {
       throw std::runtime_error("ratchet_key failed");
@@ -118,8 +197,247 @@ class KeyProvider {
 
   rtc::scoped_refptr<webrtc::KeyProvider> rtc_key_provider() { return impl_; }
 
+  // Keys of a participant, the shared keys in shared key mode
+  rtc::scoped_refptr<webrtc::ParticipantKeyHandler> key_handler(
+      const std::string& participant_id) const;
+
  private:
+  // Installs the precomputed step when there is one, an empty
+  // participant_id is the shared key
+  std::vector<uint8_t> RatchetKey(const std::string& participant_id,
+                                  int index) const;
+
+  const bool shared_key_;
+  // Serializes the key changes made through this provider, so the material
+  // compared with the prefetched window is still the installed one
+  mutable webrtc::Mutex ratchet_mutex_;
   rtc::scoped_refptr<webrtc::DefaultKeyProviderImpl> impl_;
+  std::unique_ptr<RatchetPrefetcher> prefetcher_;
+};
+
+constexpr size_t kDataPacketIvSize = 12;
+constexpr size_t kDataPacketTagSize = 16;
+
+struct AeadContext;
+
+// AES-GCM contexts of the keys of a KeyProvider. The key schedule and the
+// GHASH tables are computed once per key instead of for every packet or
+// frame, a context is rebuilt when the key changes (set_key, ratchet).
+class AeadContextCache {
+ public:
+  explicit AeadContextCache(std::shared_ptr<KeyProvider> key_provider);
+  ~AeadContextCache();
+
+  // nullptr if there is no usable key at this index
+  std::shared_ptr<const AeadContext> Get(const std::string& participant_id,
+                                         int32_t key_index) const;
+
+  KeyProvider& key_provider() const { return *key_provider_; }
+
+ private:
+  const std::shared_ptr<KeyProvider> key_provider_;
+  mutable webrtc::Mutex mutex_;
+  mutable std::map<std::pair<std::string, int32_t>,
+                   std::shared_ptr<const AeadContext>>
+      contexts_ RTC_GUARDED_BY(mutex_);
+};
+
+/// AES-GCM encryption of data packets with the keys (and ratchet state) of
+/// a KeyProvider. Packets are encrypted/decrypted in place: the buffer
+/// holds the payload followed by kDataPacketTagSize bytes for the tag.
+class DataPacketCryptor {
+ public:
+  explicit DataPacketCryptor(std::shared_ptr<KeyProvider> key_provider);
+  ~DataPacketCryptor();
+
+  // Fills iv (kDataPacketIvSize) and the tag at the end of data
+  void encrypt(rust::Str participant_id,
+               int32_t key_index,
+               rust::Slice<uint8_t> data,
+               rust::Slice<uint8_t> iv) const;
+
+  // Returns the length of the payload, throws if the packet can't be
+  // authenticated with the key
+  size_t decrypt(rust::Str participant_id,
+                 int32_t key_index,
+                 rust::Slice<const uint8_t> iv,
+                 rust::Slice<uint8_t> data) const;
+
+ private:
+  AeadContextCache contexts_;
+};
+
+std::shared_ptr<DataPacketCryptor> new_data_packet_cryptor(
+    std::shared_ptr<KeyProvider> key_provider);
+
+// AES-GCM frames in the format of webrtc::FrameCryptorTransformer: the
+// clear codec header (authenticated), the ciphertext and its tag, the IV,
+// the IV size and the key index. Frames are sealed straight into the
+// outgoing buffer and opened in place, with the cached context of the key.
+// The FrameCryptorTransformer keeps the other cases: missing keys, the
+// ratchet after a failed decryption, SIF trailers and the codecs with a
+// NALU header (H264/H265, the payload is RBSP escaped).
+class GcmFrameCipher {
+ public:
+  GcmFrameCipher(std::shared_ptr<KeyProvider> key_provider,
+                 std::string participant_id,
+                 bool is_video);
+
+  // Context of the key a batch of frames is encrypted with, nullptr if
+  // there is none
+  std::shared_ptr<const AeadContext> EncryptionContext(int key_index) const;
+
+  // false if the frame must go through the FrameCryptorTransformer, the
+  // frame is then left untouched
+  bool Encrypt(webrtc::TransformableFrameInterface& frame,
+               const AeadContext& ctx,
+               int key_index) const;
+  bool Decrypt(webrtc::TransformableFrameInterface& frame) const;
+
+  // The FrameCryptorTransformer counts failures to decide when a key is
+  // invalid, reset them once a frame decrypts again
+  void MarkValidKey() const;
+
+ private:
+  // Size of the clear header, -1 if the frame isn't handled
+  int ClearHeaderSize(webrtc::TransformableFrameInterface& frame) const;
+
+  const std::string participant_id_;
+  const bool is_video_;
+  AeadContextCache contexts_;
+};
+
+// Runs the wrapped transformer on a crypto thread instead of the thread
+// delivering the frames (encoder queue, worker thread). The frames of a
+// track stay on the same thread so their order is kept, the transformed
+// frames are handed back through the RTP callbacks which are thread safe.
+// Transformers receive whole frames. Frames arriving while a batch is pending
+// are appended to it, so a burst (the simulcast layers of a sender, or frames
+// queued while the thread serves other cryptors) costs one thread hop.
+// With AES-GCM, a batch is encrypted with one context lookup through the
+// GcmFrameCipher, the FrameCryptorTransformer only gets the frames the
+// cipher leaves to it. The state changes of both go through Transition so
+// the observer sees each one once.
+class CryptoWorkerTransformer : public webrtc::FrameTransformerInterface {
+ public:
+  CryptoWorkerTransformer(
+      rtc::Thread* thread,
+      rtc::scoped_refptr<webrtc::FrameCryptorTransformer> transformer,
+      std::unique_ptr<GcmFrameCipher> cipher);
+
+  void Transform(
+      std::unique_ptr<webrtc::TransformableFrameInterface> frame) override;
+
+  void RegisterTransformedFrameCallback(
+      rtc::scoped_refptr<webrtc::TransformedFrameCallback> callback) override;
+  void RegisterTransformedFrameSinkCallback(
+      rtc::scoped_refptr<webrtc::TransformedFrameCallback> callback,
+      uint32_t ssrc) override;
+  void UnregisterTransformedFrameCallback() override;
+  void UnregisterTransformedFrameSinkCallback(uint32_t ssrc) override;
+
+  // State reported by the FrameCryptorTransformer, false if the observer
+  // already got it (from the worker)
+  bool OnTransformerStateChanged(FrameCryptionState state);
+
+  void set_observer(rtc::scoped_refptr<NativeFrameCryptorObserver> observer);
+
+  FrameCryptorStats stats() const;
+  void reset_stats();
+
+ private:
+  // Frames handed back by the transformer, the ones failing to decrypt
+  // (or encrypt) are dropped and never get there
+  struct OutputCounters {
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> bytes{0};
+  };
+
+  class CountingCallback : public webrtc::TransformedFrameCallback {
+   public:
+    CountingCallback(rtc::scoped_refptr<webrtc::TransformedFrameCallback> sink,
+                     std::shared_ptr<OutputCounters> counters);
+
+    void OnTransformedFrame(
+        std::unique_ptr<webrtc::TransformableFrameInterface> frame) override;
+    void StartShortCircuiting() override;
+
+   private:
+    const rtc::scoped_refptr<webrtc::TransformedFrameCallback> sink_;
+    const std::shared_ptr<OutputCounters> counters_;
+  };
+
+  struct QueuedFrame {
+    std::unique_ptr<webrtc::TransformableFrameInterface> frame;
+    int64_t queued_us;
+  };
+
+  // Runs on thread_
+  void Drain();
+
+  // Key a batch is encrypted with, looked up at its first frame
+  struct BatchKey {
+    bool fetched = false;
+    int index = 0;
+    std::shared_ptr<const AeadContext> ctx;
+  };
+
+  // Runs on thread_, false if the frame must go to transformer_
+  bool TransformWithCipher(
+      std::unique_ptr<webrtc::TransformableFrameInterface>& frame,
+      BatchKey& key);
+
+  // Runs on thread_. transformer_ only notifies the failures it enters, its
+  // last state predates the frames handled by cipher_: a dropped frame
+  // reports that failure again if the observer saw an Ok since.
+  void TransformWithFallback(
+      std::unique_ptr<webrtc::TransformableFrameInterface> frame);
+
+  // Records the new state, false if it is the current one. Failures and
+  // ratchets are counted here.
+  bool Transition(FrameCryptionState state);
+  void Report(FrameCryptionState state);
+
+  rtc::scoped_refptr<webrtc::TransformedFrameCallback> callback(
+      uint32_t ssrc) const;
+
+  rtc::Thread* const thread_;
+  const rtc::scoped_refptr<webrtc::FrameCryptorTransformer> transformer_;
+  const std::unique_ptr<GcmFrameCipher> cipher_;
+
+  webrtc::Mutex mutex_;
+  std::deque<QueuedFrame> queue_;
+  bool drain_pending_ = false;
+
+  // The CountingCallbacks registered on transformer_, used for the frames
+  // transformed by cipher_
+  mutable webrtc::Mutex callbacks_mutex_;
+  rtc::scoped_refptr<webrtc::TransformedFrameCallback> callback_
+      RTC_GUARDED_BY(callbacks_mutex_);
+  std::map<uint32_t, rtc::scoped_refptr<webrtc::TransformedFrameCallback>>
+      sink_callbacks_ RTC_GUARDED_BY(callbacks_mutex_);
+
+  // Last state notified, and last one notified by transformer_
+  std::atomic<FrameCryptionState> state_;
+  std::atomic<FrameCryptionState> transformer_state_;
+  webrtc::Mutex observer_mutex_;
+  rtc::scoped_refptr<NativeFrameCryptorObserver> observer_
+      RTC_GUARDED_BY(observer_mutex_);
+  bool mark_valid_key_ = false;  // thread_
+
+  std::atomic<uint64_t> frames_{0};
+  std::atomic<uint64_t> bytes_{0};
+  std::atomic<uint64_t> cpu_time_us_{0};
+  std::atomic<uint32_t> queue_depth_{0};
+  std::atomic<uint32_t> max_queue_depth_{0};
+  AtomicHistogram latency_us_;  // queued + transform time
+  const std::shared_ptr<OutputCounters> output_;
+
+  std::atomic<uint32_t> encryption_failures_{0};
+  std::atomic<uint32_t> decryption_failures_{0};
+  std::atomic<uint32_t> missing_keys_{0};
+  std::atomic<uint32_t> internal_errors_{0};
+  std::atomic<uint32_t> key_ratchets_{0};
 };
 
 class FrameCryptor {
@@ -127,13 +445,13 @@ class FrameCryptor {
   FrameCryptor(std::shared_ptr<RtcRuntime> rtc_runtime,
                const std::string participant_id,
                webrtc::FrameCryptorTransformer::Algorithm algorithm,
-               rtc::scoped_refptr<webrtc::KeyProvider> key_provider,
+               std::shared_ptr<KeyProvider> key_provider,
                rtc::scoped_refptr<webrtc::RtpSenderInterface> sender);
 
   FrameCryptor(std::shared_ptr<RtcRuntime> rtc_runtime,
                const std::string participant_id,
                webrtc::FrameCryptorTransformer::Algorithm algorithm,
-               rtc::scoped_refptr<webrtc::KeyProvider> key_provider,
+               std::shared_ptr<KeyProvider> key_provider,
                rtc::scoped_refptr<webrtc::RtpReceiverInterface> receiver);
   ~FrameCryptor();
 
@@ -157,11 +475,17 @@ class FrameCryptor {
 
   void unregister_observer() const;
 
+  /// Frames and bytes going through the cryptor, queue depth, latency,
+  /// crypto CPU time and the failures/ratchets reported by the transformer
+  FrameCryptorStats stats() const;
+  void reset_stats() const;
+
  private:
   std::shared_ptr<RtcRuntime> rtc_runtime_;
   const rust::String participant_id_;
   mutable webrtc::Mutex mutex_;
   rtc::scoped_refptr<webrtc::FrameCryptorTransformer> e2ee_transformer_;
+  rtc::scoped_refptr<CryptoWorkerTransformer> worker_;
   rtc::scoped_refptr<webrtc::KeyProvider> key_provider_;
   rtc::scoped_refptr<webrtc::RtpSenderInterface> sender_;
   rtc::scoped_refptr<webrtc::RtpReceiverInterface> receiver_;
@@ -171,16 +495,23 @@ class FrameCryptor {
 class NativeFrameCryptorObserver
     : public webrtc::FrameCryptorTransformerObserver {
  public:
-  NativeFrameCryptorObserver(rust::Box<RtcFrameCryptorObserverWrapper> observer,
-                             const FrameCryptor* fc);
+  NativeFrameCryptorObserver(
+      rust::Box<RtcFrameCryptorObserverWrapper> observer,
+      const FrameCryptor* fc,
+      rtc::scoped_refptr<CryptoWorkerTransformer> worker);
   ~NativeFrameCryptorObserver();
 
   void OnFrameCryptionStateChanged(const std::string participant_id,
                                    webrtc::FrameCryptionState error) override;
 
+  // Forwards a state the worker already recorded
+  void Notify(FrameCryptionState state);
+
  private:
   rust::Box<RtcFrameCryptorObserverWrapper> observer_;
   const FrameCryptor* fc_;
+  const rust::String participant_id_;
+  rtc::scoped_refptr<CryptoWorkerTransformer> worker_;
 };
 
 std::shared_ptr<FrameCryptor> new_frame_cryptor_for_rtp_sender(
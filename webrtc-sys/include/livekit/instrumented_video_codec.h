@@ -0,0 +1,150 @@
+/*
+ * Copyright 2023 LiveKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the “License”);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an “AS IS” BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/video/encoded_image.h"
+#include "api/video/video_frame.h"
+#include "api/video_codecs/video_decoder.h"
+#include "api/video_codecs/video_encoder.h"
+#include "livekit/codec_stats.h"
+
+namespace livekit {
+
+// Start time of the frames being encoded/decoded, matched by RTP timestamp
+// when the codec outputs them (possibly on another thread for hardware
+// codecs). Push and Clear are only called by the encode/decode thread, each
+// slot is a seqlock so Find never blocks it.
+class FrameStartTimes {
+ public:
+  struct Entry {
+    uint32_t rtp_timestamp = 0;
+    int64_t start_us = -1;
+    size_t size_bytes = 0;
+  };
+
+  void Push(uint32_t rtp_timestamp, size_t size_bytes);
+  absl::optional<Entry> Find(uint32_t rtp_timestamp) const;
+  void Clear();
+
+ private:
+  struct Slot {
+    std::atomic<uint32_t> sequence{0};  // odd while being written
+    std::atomic<uint32_t> rtp_timestamp{0};
+    std::atomic<int64_t> start_us{-1};
+    std::atomic<uint64_t> size_bytes{0};
+  };
+
+  void Write(Slot& slot, const Entry& entry);
+
+  // Enough for the frames in flight of a hardware encoder
+  static constexpr size_t kSize = 32;
+
+  std::array<Slot, kSize> slots_;
+  size_t next_ = 0;
+};
+
+// Outermost encoder created by the VideoEncoderFactory, records the encode
+// latency, QP and size of every output frame (one sample per simulcast
+// layer) into the CodecStats of the sender.
+class InstrumentedVideoEncoder : public webrtc::VideoEncoder,
+                                 private webrtc::EncodedImageCallback {
+ public:
+  explicit InstrumentedVideoEncoder(
+      std::unique_ptr<webrtc::VideoEncoder> encoder);
+
+  // Set by the selector of the sender, on the encoder queue before the first
+  // InitEncode. Nothing is recorded without stats.
+  void SetStats(std::shared_ptr<CodecStats> stats);
+
+  void SetFecControllerOverride(
+      webrtc::FecControllerOverride* fec_controller_override) override;
+  int InitEncode(const webrtc::VideoCodec* codec_settings,
+                 const webrtc::VideoEncoder::Settings& settings) override;
+  int32_t RegisterEncodeCompleteCallback(
+      webrtc::EncodedImageCallback* callback) override;
+  int32_t Release() override;
+  int32_t Encode(
+      const webrtc::VideoFrame& frame,
+      const std::vector<webrtc::VideoFrameType>* frame_types) override;
+  void SetRates(const RateControlParameters& parameters) override;
+  void OnPacketLossRateUpdate(float packet_loss_rate) override;
+  void OnRttUpdate(int64_t rtt_ms) override;
+  void OnLossNotification(const LossNotification& loss_notification) override;
+  EncoderInfo GetEncoderInfo() const override;
+
+ private:
+  Result OnEncodedImage(
+      const webrtc::EncodedImage& encoded_image,
+      const webrtc::CodecSpecificInfo* codec_specific_info) override;
+  void OnDroppedFrame(DropReason reason) override;
+
+  std::unique_ptr<webrtc::VideoEncoder> encoder_;
+  webrtc::EncodedImageCallback* callback_ = nullptr;
+  // An encoder only serves the sender it was created for, the stats are set
+  // once on the encoder queue and never replaced, the output callbacks
+  // (possibly on the threads of a hardware encoder) only load the pointer
+  std::shared_ptr<CodecStats> stats_owner_;
+  std::atomic<CodecStats*> stats_{nullptr};
+  FrameStartTimes start_times_;
+};
+
+// Wraps the LazyVideoDecoder, records the decode latency, QP and input size
+// of every decoded frame into the CodecStats of the SSRC it decodes (see
+// SharedDecoderStats). Frames stripped by an EncodedFrameTap aren't counted.
+class InstrumentedVideoDecoder : public webrtc::VideoDecoder,
+                                 private webrtc::DecodedImageCallback {
+ public:
+  explicit InstrumentedVideoDecoder(
+      std::unique_ptr<webrtc::VideoDecoder> decoder);
+
+  bool Configure(const Settings& settings) override;
+  int32_t Decode(const webrtc::EncodedImage& input_image,
+                 bool missing_frames,
+                 int64_t render_time_ms) override;
+  int32_t RegisterDecodeCompleteCallback(
+      webrtc::DecodedImageCallback* callback) override;
+  int32_t Release() override;
+  DecoderInfo GetDecoderInfo() const override;
+  const char* ImplementationName() const override;
+
+ private:
+  int32_t Decoded(webrtc::VideoFrame& decoded_image) override;
+  int32_t Decoded(webrtc::VideoFrame& decoded_image,
+                  int64_t decode_time_ms) override;
+  void Decoded(webrtc::VideoFrame& decoded_image,
+               absl::optional<int32_t> decode_time_ms,
+               absl::optional<uint8_t> qp) override;
+
+  void Record(const webrtc::VideoFrame& decoded_image,
+              absl::optional<uint8_t> qp);
+
+  std::unique_ptr<webrtc::VideoDecoder> decoder_;
+  webrtc::DecodedImageCallback* callback_ = nullptr;
+  // A decoder belongs to a single receive stream, the stats of its SSRC are
+  // set by the first decoded frame and never replaced
+  std::shared_ptr<CodecStats> stats_owner_;  // only used on the decoder thread
+  std::atomic<CodecStats*> stats_{nullptr};
+  FrameStartTimes start_times_;
+};
+
+}  // namespace livekit
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2023 LiveKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the “License”);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an “AS IS” BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "absl/types/optional.h"
+#include "api/video/video_frame_buffer.h"
+#include "api/video_codecs/video_decoder.h"
+
+namespace livekit {
+
+// Buffer type the consumers of a receive stream want its decoders to output,
+// kNative keeps the decoder default.
+// Decoders supporting it (libvpx VP8) then decode straight into pooled
+// buffers of that type, the others are converted once by the video sinks.
+// Receivers set it under the SSRC of their stream, the decoders of that SSRC
+// adopt it with their first keyframe and the preference ends with them: a
+// stream renegotiated with the same SSRC starts again from kNative. A
+// preference set before any decoder adopted it waits for the first one.
+using DecoderOutput = std::atomic<webrtc::VideoFrameBuffer::Type>;
+
+void SetPreferredDecoderOutput(uint32_t ssrc,
+                               webrtc::VideoFrameBuffer::Type type);
+std::shared_ptr<DecoderOutput> AdoptPreferredDecoderOutput(uint32_t ssrc);
+
+// Creates the wrapped decoder when the first keyframe arrives. Frames with an
+// empty payload (stripped by an EncodedFrameTap) are acknowledged without
+// being decoded, so a receiver that only taps the encoded frames never
+// instantiates a decoder.
+// max_threads caps the number of cores given to the decoder (dav1d, libvpx),
+// 0 keeps the WebRTC default.
+// The decoder is recreated on the next keyframe when the preferred output
+// it adopted changes.
+class LazyVideoDecoder : public webrtc::VideoDecoder {
+ public:
+  using Factory = std::function<std::unique_ptr<webrtc::VideoDecoder>(
+      webrtc::VideoFrameBuffer::Type output)>;
+
+  LazyVideoDecoder(Factory factory, int max_threads);
+
+  bool Configure(const Settings& settings) override;
+  int32_t Decode(const webrtc::EncodedImage& input_image,
+                 bool missing_frames,
+                 int64_t render_time_ms) override;
+  int32_t RegisterDecodeCompleteCallback(
+      webrtc::DecodedImageCallback* callback) override;
+  int32_t Release() override;
+  DecoderInfo GetDecoderInfo() const override;
+  const char* ImplementationName() const override;
+
+ private:
+  Factory factory_;
+  const int max_threads_;
+  absl::optional<Settings> settings_;
+  webrtc::DecodedImageCallback* callback_ = nullptr;
+  std::unique_ptr<webrtc::VideoDecoder> decoder_;
+  std::shared_ptr<DecoderOutput> preferred_output_;
+  webrtc::VideoFrameBuffer::Type output_ = webrtc::VideoFrameBuffer::Type::kNative;
+};
+
+}  // namespace livekit
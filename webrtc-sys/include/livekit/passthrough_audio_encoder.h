@@ -0,0 +1,145 @@
+/*
+ * Copyright 2023 LiveKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the “License”);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an “AS IS” BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/array_view.h"
+#include "api/audio_codecs/audio_encoder.h"
+#include "api/call/bitrate_allocation.h"
+#include "api/units/time_delta.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/synchronization/mutex.h"
+
+namespace livekit {
+
+// Encoded Opus packets don't travel through the PCM pipeline: muting,
+// remixing or the local sinks would alter them. The AudioTrackSource queues
+// them on an EncodedAudioChannel and only sends 10ms marker blocks of 48kHz
+// mono samples, clocking the PassthroughAudioEncoder and telling it which
+// packet to take from the channel (mono is upmixed by duplicating samples).
+// A marker altered on the way (e.g. faded out by a mute) reads as PCM, its
+// packet is skipped.
+constexpr int kEncodedAudioSampleRate = 48000;
+constexpr size_t kEncodedAudioBlockSamples = kEncodedAudioSampleRate / 100;
+
+struct EncodedAudioMarker {
+  uint32_t channel_id = 0;
+  uint16_t sequence = 0;
+  uint16_t index = 0;
+  uint16_t count = 0;  // 0 = no packet
+};
+
+// Marker carried by the first channel of `audio`, if any
+absl::optional<EncodedAudioMarker> ReadEncodedAudioMarker(
+    rtc::ArrayView<const int16_t> audio,
+    size_t num_channels);
+
+class EncodedAudioChannel {
+ public:
+  static std::shared_ptr<EncodedAudioChannel> Create();
+
+  // Null once the source owning the channel is gone
+  static std::shared_ptr<EncodedAudioChannel> Find(uint32_t id);
+
+  explicit EncodedAudioChannel(uint32_t id);
+
+  uint32_t id() const { return id_; }
+
+  // Queue an Opus packet lasting duration_ms (multiple of 10) and append its
+  // marker blocks to `markers`. Returns false if the packet is invalid.
+  bool Push(rtc::ArrayView<const uint8_t> packet,
+            int duration_ms,
+            std::vector<int16_t>& markers);
+
+  // Block without packet (DTX/gap): nothing is sent but the RTP timestamp
+  // keeps moving forward
+  void AppendEmptyMarker(std::vector<int16_t>& markers) const;
+
+  // Packet of the marker `sequence`, older packets (whose markers got lost)
+  // are dropped. Empty if it isn't queued anymore.
+  rtc::Buffer Take(uint16_t sequence);
+
+  void Clear();
+
+ private:
+  struct Packet {
+    uint16_t sequence;
+    rtc::Buffer data;
+  };
+
+  const uint32_t id_;
+  webrtc::Mutex mutex_;
+  std::deque<Packet> packets_ RTC_GUARDED_BY(mutex_);
+  uint16_t next_sequence_ RTC_GUARDED_BY(mutex_) = 0;
+};
+
+// Opus encoder emitting the packets of the channel markers above as they are,
+// regular PCM is encoded by the wrapped encoder.
+// In-band FEC and DTX are whatever the upstream encoder produced: SetFec and
+// SetDtx only apply to the wrapped encoder, packets of 2 bytes or less are
+// flagged as DTX (not speech) like AudioEncoderOpus does.
+class PassthroughAudioEncoder : public webrtc::AudioEncoder {
+ public:
+  PassthroughAudioEncoder(int payload_type,
+                          std::unique_ptr<webrtc::AudioEncoder> encoder);
+
+  int SampleRateHz() const override;
+  size_t NumChannels() const override;
+  int RtpTimestampRateHz() const override;
+  size_t Num10MsFramesInNextPacket() const override;
+  size_t Max10MsFramesInAPacket() const override;
+  int GetTargetBitrate() const override;
+  void Reset() override;
+  bool SetFec(bool enable) override;
+  bool SetDtx(bool enable) override;
+  bool GetDtx() const override;
+  bool SetApplication(Application application) override;
+  void SetMaxPlaybackRate(int frequency_hz) override;
+  void OnReceivedUplinkPacketLossFraction(
+      float uplink_packet_loss_fraction) override;
+  void OnReceivedUplinkBandwidth(
+      int target_audio_bitrate_bps,
+      absl::optional<int64_t> bwe_period_ms) override;
+  void OnReceivedUplinkAllocation(webrtc::BitrateAllocationUpdate update) override;
+  void OnReceivedRtt(int rtt_ms) override;
+  void OnReceivedOverhead(size_t overhead_bytes_per_packet) override;
+  absl::optional<std::pair<webrtc::TimeDelta, webrtc::TimeDelta>>
+  GetFrameLengthRange() const override;
+
+ protected:
+  EncodedInfo EncodeImpl(uint32_t rtp_timestamp,
+                         rtc::ArrayView<const int16_t> audio,
+                         rtc::Buffer* encoded) override;
+
+ private:
+  const int payload_type_;
+  std::unique_ptr<webrtc::AudioEncoder> encoder_;
+
+  std::shared_ptr<EncodedAudioChannel> channel_;
+  bool passthrough_ = false;
+  rtc::Buffer packet_;
+  uint16_t sequence_ = 0;
+  size_t packet_blocks_ = 0;
+  size_t next_block_ = 0;
+  uint32_t first_timestamp_ = 0;
+};
+
+}  // namespace livekit
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2023 LiveKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the “License”);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an “AS IS” BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "api/ref_counted_base.h"
+#include "api/scoped_refptr.h"
+#include "api/video/encoded_image.h"
+#include "api/video/video_codec_type.h"
+#include "api/video/video_frame_buffer.h"
+#include "api/video_codecs/video_encoder.h"
+
+namespace livekit {
+
+// Notified when the remote side asks for a keyframe (PLI/FIR) while
+// pre-encoded frames are being forwarded.
+class KeyFrameRequestListener : public rtc::RefCountInterface {
+ public:
+  virtual void OnKeyFrameRequested() = 0;
+};
+
+// Native buffer carrying an already encoded frame through the capture
+// pipeline, it is unwrapped by PassthroughVideoEncoder.
+class EncodedFrameBuffer : public webrtc::VideoFrameBuffer {
+ public:
+  EncodedFrameBuffer(rtc::scoped_refptr<webrtc::EncodedImageBuffer> data,
+                     webrtc::VideoCodecType codec,
+                     bool is_keyframe,
+                     int width,
+                     int height,
+                     uint64_t sequence,
+                     rtc::scoped_refptr<KeyFrameRequestListener> listener);
+
+  Type type() const override;
+  int width() const override;
+  int height() const override;
+
+  // Local sinks (previews) only see a black frame
+  rtc::scoped_refptr<webrtc::I420BufferInterface> ToI420() override;
+
+  // The encoded payload can't be scaled, the same buffer is returned
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> CropAndScale(
+      int offset_x,
+      int offset_y,
+      int crop_width,
+      int crop_height,
+      int scaled_width,
+      int scaled_height) override;
+
+  rtc::scoped_refptr<webrtc::EncodedImageBuffer> data() const { return data_; }
+  webrtc::VideoCodecType codec() const { return codec_; }
+  bool is_keyframe() const { return is_keyframe_; }
+  uint64_t sequence() const { return sequence_; }
+  KeyFrameRequestListener* listener() const { return listener_.get(); }
+
+ private:
+  rtc::scoped_refptr<webrtc::EncodedImageBuffer> data_;
+  webrtc::VideoCodecType codec_;
+  bool is_keyframe_;
+  int width_;
+  int height_;
+  uint64_t sequence_;
+  rtc::scoped_refptr<KeyFrameRequestListener> listener_;
+};
+
+// Emits EncodedFrameBuffer payloads as they are, raw frames are forwarded to
+// the wrapped encoder. Only H264 (Annex B) and VP8 payloads can be forwarded,
+// and simulcast must be disabled on the published track.
+// Native handles are always advertised so the EncodedFrameBuffers reach
+// Encode, each frame is then forwarded or encoded depending on its buffer.
+class PassthroughVideoEncoder : public webrtc::VideoEncoder {
+ public:
+  PassthroughVideoEncoder(webrtc::VideoCodecType codec_type,
+                          std::unique_ptr<webrtc::VideoEncoder> encoder);
+
+  void SetFecControllerOverride(
+      webrtc::FecControllerOverride* fec_controller_override) override;
+  int InitEncode(const webrtc::VideoCodec* codec_settings,
+                 const webrtc::VideoEncoder::Settings& settings) override;
+  int32_t RegisterEncodeCompleteCallback(
+      webrtc::EncodedImageCallback* callback) override;
+  int32_t Release() override;
+  int32_t Encode(
+      const webrtc::VideoFrame& frame,
+      const std::vector<webrtc::VideoFrameType>* frame_types) override;
+  void SetRates(const RateControlParameters& parameters) override;
+  void OnPacketLossRateUpdate(float packet_loss_rate) override;
+  void OnRttUpdate(int64_t rtt_ms) override;
+  void OnLossNotification(const LossNotification& loss_notification) override;
+  EncoderInfo GetEncoderInfo() const override;
+
+ private:
+  int32_t EncodePassthrough(
+      const webrtc::VideoFrame& frame,
+      const EncodedFrameBuffer& buffer,
+      const std::vector<webrtc::VideoFrameType>* frame_types);
+
+  const webrtc::VideoCodecType codec_type_;
+  std::unique_ptr<webrtc::VideoEncoder> encoder_;
+  webrtc::EncodedImageCallback* callback_ = nullptr;
+
+  std::atomic<bool> passthrough_{false};
+  bool waiting_keyframe_ = true;  // a delta frame can't start the stream
+  int64_t keyframe_requested_ms_ = -1;
+  uint64_t last_sequence_ = 0;
+  bool codec_mismatch_logged_ = false;
+};
+
+}  // namespace livekit
@@ -20,6 +20,7 @@
 #include "api/scoped_refptr.h"
 #include "api/task_queue/task_queue_factory.h"
 #include "livekit/audio_device.h"
+#include "livekit/video_decoder_factory.h"
 #include "media_stream.h"
 #include "rtp_parameters.h"
 #include "rust/cxx.h"
@@ -60,11 +61,19 @@ class PeerConnectionFactory {
 
   RtpCapabilities rtp_receiver_capabilities(MediaType type) const;
 
+  // Applies to the decoders created after this call
+  void set_video_decoder_threads(uint32_t max_threads) const;
+
+  // Size of the pool running the frame cryptors, applies to the cryptors
+  // created after this call
+  void set_crypto_threads(uint32_t count) const;
+
   std::shared_ptr<RtcRuntime> rtc_runtime() const { return rtc_runtime_; }
 
  private:
   std::shared_ptr<RtcRuntime> rtc_runtime_;
   rtc::scoped_refptr<AudioDevice> audio_device_;
+  VideoDecoderFactory* video_decoder_factory_;  // owned by peer_factory_
   rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> peer_factory_;
   webrtc::TaskQueueFactory* task_queue_factory_;
 };
@@ -18,12 +18,15 @@
 
 #include <memory>
 
+#include "absl/types/optional.h"
 #include "api/peer_connection_interface.h"
 #include "api/rtp_receiver_interface.h"
 #include "api/scoped_refptr.h"
+#include "livekit/codec_stats.h"
 #include "livekit/helper.h"
 #include "livekit/media_stream.h"
 #include "livekit/rtp_parameters.h"
+#include "livekit/video_frame_buffer.h"
 #include "livekit/webrtc.h"
 #include "rust/cxx.h"
 
@@ -62,11 +65,25 @@ class RtpReceiver {
   void set_jitter_buffer_minimum_delay(bool is_some,
                                        double delay_seconds) const;
 
+  // Stats of the video decoders of this receiver, null until the SSRC of the
+  // remote stream is known
+  std::shared_ptr<CodecStats> decoder_stats() const;
+
+  // I420 or NV12 output of the video decoders (Native resets it), applied
+  // from the next keyframe and kept while they run (see
+  // SetPreferredDecoderOutput). False until the SSRC of the remote stream is
+  // known
+  bool set_preferred_decoder_output(VideoFrameBufferType buffer_type) const;
+
   rtc::scoped_refptr<webrtc::RtpReceiverInterface> rtc_receiver() const {
     return receiver_;
   }
 
+  std::shared_ptr<RtcRuntime> rtc_runtime() const { return rtc_runtime_; }
+
  private:
+  absl::optional<uint32_t> video_ssrc() const;
+
   std::shared_ptr<RtcRuntime> rtc_runtime_;
   rtc::scoped_refptr<webrtc::RtpReceiverInterface> receiver_;
   rtc::scoped_refptr<webrtc::PeerConnectionInterface> peer_connection_;
@@ -21,6 +21,7 @@
 #include "api/peer_connection_interface.h"
 #include "api/rtp_sender_interface.h"
 #include "api/scoped_refptr.h"
+#include "livekit/codec_stats.h"
 #include "livekit/media_stream.h"
 #include "livekit/rtc_error.h"
 #include "livekit/rtp_parameters.h"
@@ -65,6 +66,12 @@ class RtpSender {
 
   void set_parameters(RtpParameters params) const;
 
+  // Applied to the encoders created after this call (the send stream is
+  // recreated if it already exists)
+  // Returns the stats of the encoders created from now on
+  std::shared_ptr<CodecStats> set_video_encoder_settings(
+      VideoEncoderSettings settings) const;
+
   rtc::scoped_refptr<webrtc::RtpSenderInterface> rtc_sender() const {
     return sender_;
   }
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2023 LiveKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the “License”);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an “AS IS” BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "api/scoped_refptr.h"
+#include "api/video/i420_buffer.h"
+#include "api/video/nv12_buffer.h"
+#include "api/video/video_frame_buffer.h"
+#include "api/video_codecs/video_encoder.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace livekit {
+
+// Cascade of half resolution downscales of a frame, built lazily.
+// Each scaling request is served from the closest level instead of the full
+// resolution source, so simulcast layers share the downscaling work.
+class ScalingPyramid {
+ public:
+  explicit ScalingPyramid(rtc::scoped_refptr<webrtc::VideoFrameBuffer> source);
+
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> Scale(int width, int height);
+
+ private:
+  webrtc::Mutex mutex_;
+  std::vector<rtc::scoped_refptr<webrtc::VideoFrameBuffer>> levels_
+      RTC_GUARDED_BY(mutex_);  // levels_[0] is the source
+};
+
+// I420/NV12 buffers forwarding their planes as is, but scaling through a
+// ScalingPyramid.
+class PyramidI420Buffer : public webrtc::I420BufferInterface {
+ public:
+  explicit PyramidI420Buffer(
+      rtc::scoped_refptr<webrtc::I420BufferInterface> buffer);
+
+  int width() const override;
+  int height() const override;
+  const uint8_t* DataY() const override;
+  const uint8_t* DataU() const override;
+  const uint8_t* DataV() const override;
+  int StrideY() const override;
+  int StrideU() const override;
+  int StrideV() const override;
+
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> CropAndScale(
+      int offset_x,
+      int offset_y,
+      int crop_width,
+      int crop_height,
+      int scaled_width,
+      int scaled_height) override;
+
+ private:
+  rtc::scoped_refptr<webrtc::I420BufferInterface> buffer_;
+  ScalingPyramid pyramid_;
+};
+
+class PyramidNV12Buffer : public webrtc::NV12BufferInterface {
+ public:
+  explicit PyramidNV12Buffer(
+      rtc::scoped_refptr<webrtc::NV12BufferInterface> buffer);
+
+  int width() const override;
+  int height() const override;
+  const uint8_t* DataY() const override;
+  const uint8_t* DataUV() const override;
+  int StrideY() const override;
+  int StrideUV() const override;
+
+  rtc::scoped_refptr<webrtc::I420BufferInterface> ToI420() override;
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> CropAndScale(
+      int offset_x,
+      int offset_y,
+      int crop_width,
+      int crop_height,
+      int scaled_width,
+      int scaled_height) override;
+
+ private:
+  rtc::scoped_refptr<webrtc::NV12BufferInterface> buffer_;
+  ScalingPyramid pyramid_;
+};
+
+// Wraps the SimulcastEncoderAdapter so the input frames it scales for each
+// layer go through a shared ScalingPyramid. Frames are passed as is when the
+// adapter hands all the layers to one simulcast capable encoder.
+class PyramidSimulcastEncoder : public webrtc::VideoEncoder {
+ public:
+  explicit PyramidSimulcastEncoder(
+      std::unique_ptr<webrtc::VideoEncoder> encoder);
+
+  void SetFecControllerOverride(
+      webrtc::FecControllerOverride* fec_controller_override) override;
+  int InitEncode(const webrtc::VideoCodec* codec_settings,
+                 const webrtc::VideoEncoder::Settings& settings) override;
+  int32_t RegisterEncodeCompleteCallback(
+      webrtc::EncodedImageCallback* callback) override;
+  int32_t Release() override;
+  int32_t Encode(
+      const webrtc::VideoFrame& frame,
+      const std::vector<webrtc::VideoFrameType>* frame_types) override;
+  void SetRates(const RateControlParameters& parameters) override;
+  void OnPacketLossRateUpdate(float packet_loss_rate) override;
+  void OnRttUpdate(int64_t rtt_ms) override;
+  void OnLossNotification(const LossNotification& loss_notification) override;
+  EncoderInfo GetEncoderInfo() const override;
+
+ private:
+  std::unique_ptr<webrtc::VideoEncoder> encoder_;
+  bool simulcast_ = false;
+};
+
+}  // namespace livekit
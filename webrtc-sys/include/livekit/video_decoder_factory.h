@@ -16,6 +16,9 @@
 
 #pragma once
 
+#include <atomic>
+
+#include "api/video/video_frame_buffer.h"
 #include "api/video_codecs/video_decoder.h"
 #include "api/video_codecs/video_decoder_factory.h"
 #include "absl/strings/match.h"
@@ -33,7 +36,16 @@ class VideoDecoderFactory : public webrtc::VideoDecoderFactory {
   std::unique_ptr<webrtc::VideoDecoder> Create(
       const webrtc::Environment& env, const webrtc::SdpVideoFormat& format) override;
 
+  // Max number of threads of the decoders created from now on, 0 = default
+  void set_max_threads(int max_threads) { max_threads_ = max_threads; }
+
  private:
+  std::unique_ptr<webrtc::VideoDecoder> CreateInternal(
+      const webrtc::Environment& env,
+      const webrtc::SdpVideoFormat& format,
+      webrtc::VideoFrameBuffer::Type output);
+
   std::vector<std::unique_ptr<webrtc::VideoDecoderFactory>> factories_;
+  std::atomic<int> max_threads_{0};
 };
 }  // namespace livekit
@@ -16,11 +16,21 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "api/video_codecs/sdp_video_format.h"
 #include "api/video_codecs/video_encoder.h"
 #include "api/video_codecs/video_encoder_factory.h"
 
 namespace livekit {
 class VideoEncoderFactory : public webrtc::VideoEncoderFactory {
+  // The formats of the built-in and platform factories are listed once at
+  // construction and indexed by codec name, negotiation then only looks at
+  // the few formats of a single codec.
   class InternalFactory : public webrtc::VideoEncoderFactory {
    public:
     InternalFactory();
@@ -34,8 +44,27 @@ class VideoEncoderFactory : public webrtc::VideoEncoderFactory {
     std::unique_ptr<webrtc::VideoEncoder> Create(
         const webrtc::Environment& env, const webrtc::SdpVideoFormat& format) override;
 
+    bool IsSupported(const webrtc::SdpVideoFormat& format) const;
+
    private:
+    struct CaseInsensitiveLess {
+      using is_transparent = void;
+      bool operator()(absl::string_view a, absl::string_view b) const;
+    };
+
+    struct CodecFormats {
+      // Platform (hardware) encoders are preferred
+      std::vector<std::pair<webrtc::VideoEncoderFactory*, webrtc::SdpVideoFormat>>
+          platform;
+      std::vector<webrtc::SdpVideoFormat> builtin;
+    };
+
+    const CodecFormats* Find(const webrtc::SdpVideoFormat& format) const;
+
+    std::unique_ptr<webrtc::VideoEncoderFactory> builtin_factory_;
     std::vector<std::unique_ptr<webrtc::VideoEncoderFactory>> factories_;
+    std::vector<webrtc::SdpVideoFormat> formats_;
+    std::map<std::string, CodecFormats, CaseInsensitiveLess> codecs_;
   };
 
  public:
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2023 LiveKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the “License”);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an “AS IS” BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/units/data_rate.h"
+#include "api/video_codecs/sdp_video_format.h"
+#include "api/video_codecs/video_codec.h"
+#include "api/video_codecs/video_encoder.h"
+#include "api/video_codecs/video_encoder_factory.h"
+#include "livekit/codec_stats.h"
+
+namespace livekit {
+
+class InstrumentedVideoEncoder;
+class TunedVideoEncoder;
+
+// Per-sender overrides of the software encoder configuration
+struct VideoEncoderOverrides {
+  int max_threads = 0;  // 0 = decided from the core count
+  absl::optional<webrtc::VideoCodecComplexity> complexity;
+};
+
+// Wrappers of an encoder built by VideoEncoderFactory::Create. WebRTC doesn't
+// tell the selector of a sender which encoder OnCurrentEncoder is about: the
+// VideoStreamEncoder creates the encoder and calls OnCurrentEncoder right
+// after, within the same task on its encoder queue. Create records the
+// encoder it returns (or none) for that call, and OnCurrentEncoder takes it.
+struct CreatedVideoEncoder {
+  TunedVideoEncoder* tuned = nullptr;
+  InstrumentedVideoEncoder* instrumented = nullptr;
+};
+
+void SetCreatedVideoEncoder(CreatedVideoEncoder encoder);
+CreatedVideoEncoder TakeCreatedVideoEncoder();
+
+// Set on an RtpSender to configure the encoders created for it. The
+// overrides and the stats are given to the encoder in OnCurrentEncoder,
+// before it is initialized.
+class VideoEncoderOverridesSelector
+    : public webrtc::VideoEncoderFactory::EncoderSelectorInterface {
+ public:
+  VideoEncoderOverridesSelector(VideoEncoderOverrides overrides,
+                                std::shared_ptr<CodecStats> stats);
+
+  void OnCurrentEncoder(const webrtc::SdpVideoFormat& format) override;
+  absl::optional<webrtc::SdpVideoFormat> OnAvailableBitrate(
+      const webrtc::DataRate& rate) override;
+  absl::optional<webrtc::SdpVideoFormat> OnEncoderBroken() override;
+
+ private:
+  const VideoEncoderOverrides overrides_;
+  const std::shared_ptr<CodecStats> stats_;
+};
+
+// Applies the overrides of the sender (if any) to the codec settings: the
+// thread count is capped and the complexity (cpu-used/speed of libvpx and
+// libaom) replaced. Row based multithreading is enabled by these encoders
+// whenever more than one thread is used.
+class TunedVideoEncoder : public webrtc::VideoEncoder {
+ public:
+  explicit TunedVideoEncoder(std::unique_ptr<webrtc::VideoEncoder> encoder);
+
+  // Set by the selector of the sender, on the encoder queue before the first
+  // InitEncode
+  void SetOverrides(const VideoEncoderOverrides& overrides);
+
+  void SetFecControllerOverride(
+      webrtc::FecControllerOverride* fec_controller_override) override;
+  int InitEncode(const webrtc::VideoCodec* codec_settings,
+                 const webrtc::VideoEncoder::Settings& settings) override;
+  int32_t RegisterEncodeCompleteCallback(
+      webrtc::EncodedImageCallback* callback) override;
+  int32_t Release() override;
+  int32_t Encode(
+      const webrtc::VideoFrame& frame,
+      const std::vector<webrtc::VideoFrameType>* frame_types) override;
+  void SetRates(const RateControlParameters& parameters) override;
+  void OnPacketLossRateUpdate(float packet_loss_rate) override;
+  void OnRttUpdate(int64_t rtt_ms) override;
+  void OnLossNotification(const LossNotification& loss_notification) override;
+  EncoderInfo GetEncoderInfo() const override;
+
+ private:
+  std::unique_ptr<webrtc::VideoEncoder> encoder_;
+  absl::optional<VideoEncoderOverrides> overrides_;
+};
+
+}  // namespace livekit
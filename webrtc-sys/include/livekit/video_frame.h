@@ -60,6 +60,7 @@ class VideoFrameBuilder {
   void set_timestamp_us(int64_t timestamp_us);
   void set_rotation(VideoRotation rotation);
   void set_id(uint16_t id);
+  void set_update_rect(int x, int y, int width, int height);
   std::unique_ptr<VideoFrame> build();
 
  private:
@@ -24,6 +24,7 @@
 #include "api/video/i010_buffer.h"
 #include "api/video/nv12_buffer.h"
 #include "api/video/video_frame_buffer.h"
+#include "livekit/scaling_pyramid.h"
 
 namespace livekit {
 class VideoFrameBuffer;
@@ -38,6 +39,7 @@ class I422Buffer;
 class I444Buffer;
 class I010Buffer;
 class NV12Buffer;
+class I420ScalingPyramid;
 }  // namespace livekit
 
 #ifdef __APPLE__
@@ -184,9 +186,28 @@ class NV12Buffer : public BiplanarYuv8Buffer {
   explicit NV12Buffer(rtc::scoped_refptr<webrtc::NV12BufferInterface> buffer);
 };
 
+// Scales a buffer to several sizes the way the PyramidSimulcastEncoder scales
+// the simulcast layers
+class I420ScalingPyramid {
+ public:
+  explicit I420ScalingPyramid(
+      rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer);
+
+  std::unique_ptr<I420Buffer> scale(int width, int height) const;
+
+ private:
+  mutable ScalingPyramid pyramid_;
+};
+
 std::unique_ptr<I420Buffer> copy_i420_buffer(
     const std::unique_ptr<I420Buffer>& i420);
 std::unique_ptr<I420Buffer> new_i420_buffer(int width, int height, int stride_y, int stride_u, int stride_v);
+std::unique_ptr<I420Buffer> scale_i420_buffer(
+    const std::unique_ptr<I420Buffer>& i420,
+    int width,
+    int height);
+std::unique_ptr<I420ScalingPyramid> new_i420_scaling_pyramid(
+    const std::unique_ptr<I420Buffer>& i420);
 std::unique_ptr<I422Buffer> new_i422_buffer(int width, int height, int stride_y, int stride_u, int stride_v);
 std::unique_ptr<I444Buffer> new_i444_buffer(int width, int height, int stride_y, int stride_u, int stride_v);
 std::unique_ptr<I010Buffer> new_i010_buffer(int width, int height, int stride_y, int stride_u, int stride_v);
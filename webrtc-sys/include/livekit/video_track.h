@@ -16,15 +16,23 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <vector>
 
+#include "absl/types/optional.h"
 #include "api/media_stream_interface.h"
+#include "api/video/i420_buffer.h"
+#include "api/video/nv12_buffer.h"
 #include "api/video/video_frame.h"
+#include "common_video/include/video_frame_buffer_pool.h"
 #include "livekit/helper.h"
 #include "livekit/media_stream_track.h"
+#include "livekit/passthrough_video_encoder.h"
 #include "livekit/video_frame.h"
 #include "livekit/webrtc.h"
 #include "media/base/adapted_video_track_source.h"
+#include "media/base/video_adapter.h"
 #include "rtc_base/synchronization/mutex.h"
 #include "rtc_base/timestamp_aligner.h"
 #include "rust/cxx.h"
@@ -47,11 +55,25 @@ class VideoTrack : public MediaStreamTrack {
  public:
   ~VideoTrack();
 
-  void add_sink(const std::shared_ptr<NativeVideoSink>& sink) const;
+  // Also used to update the wants of an already added sink. The wants are
+  // applied by the sink itself, the source never adapts to them
+  void add_sink(const std::shared_ptr<NativeVideoSink>& sink,
+                const VideoSinkWants& wants) const;
   void remove_sink(const std::shared_ptr<NativeVideoSink>& sink) const;
 
   void set_should_receive(bool should_receive) const;
   bool should_receive() const;
+
+  // Remote tracks only receive (and decode) while at least one sink is
+  // attached, enabled by default for remote tracks
+  void set_lazy_receive(bool lazy_receive) const;
+  bool lazy_receive() const;
+
+  // Keeps a lazily received track running without a video sink, taken by
+  // each EncodedFrameSink of the receiver
+  void add_receive_hold() const;
+  void remove_receive_hold() const;
+
   ContentHint content_hint() const;
   void set_content_hint(ContentHint hint) const;
 
@@ -60,7 +82,13 @@ class VideoTrack : public MediaStreamTrack {
     return static_cast<webrtc::VideoTrackInterface*>(track_.get());
   }
 
+  // Must be called with mutex_ held
+  void update_receive() const;
+
   mutable webrtc::Mutex mutex_;
+  mutable bool should_receive_ = true;  // set by the user
+  mutable bool lazy_receive_ = false;
+  mutable int receive_holds_ = 0;
 
   // Same for AudioTrack:
   // Keep a strong reference to the added sinks, so we don't need to
@@ -70,27 +98,55 @@ class VideoTrack : public MediaStreamTrack {
 
 class NativeVideoSink : public rtc::VideoSinkInterface<webrtc::VideoFrame> {
  public:
-  explicit NativeVideoSink(rust::Box<VideoSinkWrapper> observer);
+  // When format isn't Native, frames are converted into pooled buffers of
+  // that format (I420 or NV12) before being delivered, the buffers already
+  // in that format are delivered as is
+  NativeVideoSink(rust::Box<VideoSinkWrapper> observer,
+                  VideoFrameBufferType format);
 
   void OnFrame(const webrtc::VideoFrame& frame) override;
   void OnDiscardedFrame() override;
   void OnConstraintsChanged(
       const webrtc::VideoTrackSourceConstraints& constraints) override;
 
+  // Frames are scaled/decimated on the delivering thread to match the wants
+  void set_sink_wants(const VideoSinkWants& wants);
+
  private:
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> convert_buffer(
+      rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer);
+
   rust::Box<VideoSinkWrapper> observer_;
+  VideoFrameBufferType format_;
+  webrtc::VideoFrameBufferPool pool_;  // only used on the delivering thread
+
+  cricket::VideoAdapter adapter_;  // thread safe
+  std::atomic<bool> adapt_{false};
 };
 
 std::shared_ptr<NativeVideoSink> new_native_video_sink(
-    rust::Box<VideoSinkWrapper> observer);
+    rust::Box<VideoSinkWrapper> observer,
+    VideoFrameBufferType format);
+
+// Forwards the keyframe requests of PassthroughVideoEncoder to Rust
+class KeyFrameRequestForwarder : public KeyFrameRequestListener {
+ public:
+  void set_observer(rust::Box<KeyFrameRequestObserverWrapper> observer);
+  void OnKeyFrameRequested() override;
+
+ private:
+  webrtc::Mutex mutex_;
+  absl::optional<rust::Box<KeyFrameRequestObserverWrapper>> observer_;
+};
 
 class VideoTrackSource {
   class InternalSource : public rtc::AdaptedVideoTrackSource {
    public:
     InternalSource(const VideoResolution&
-                       resolution);  // (0, 0) means no resolution/optional, the
-                                     // source will guess the resolution at the
-                                     // first captured frame
+                       resolution,  // (0, 0) means no resolution/optional, the
+                                    // source will guess the resolution at the
+                                    // first captured frame
+                   bool is_screencast);
     ~InternalSource() override;
 
     bool is_screencast() const override;
@@ -99,21 +155,63 @@ class VideoTrackSource {
     bool remote() const override;
     VideoResolution video_resolution() const;
     bool on_captured_frame(const webrtc::VideoFrame& frame);
+    bool on_captured_encoded_frame(
+        rtc::scoped_refptr<webrtc::EncodedImageBuffer> data,
+        webrtc::VideoCodecType codec,
+        bool is_keyframe,
+        int width,
+        int height,
+        int64_t timestamp_us);
+    rtc::scoped_refptr<KeyFrameRequestForwarder> keyframe_forwarder() const;
 
    private:
+    // Rotate a NV12 buffer straight into an I420 buffer (one pass instead of
+    // ToI420 followed by I420Buffer::Rotate)
+    rtc::scoped_refptr<webrtc::I420Buffer> rotate_nv12(
+        const webrtc::NV12BufferInterface& src,
+        webrtc::VideoRotation rotation);
+
+    // Compare the frame with the last forwarded one (hashing bands of rows)
+    // and return the changed region, empty when the content is the same.
+    // The hashes of the frame are written to `hashes`.
+    webrtc::VideoFrame::UpdateRect detect_changes(
+        const webrtc::VideoFrameBuffer& buffer,
+        std::vector<uint32_t>& hashes);
+
     mutable webrtc::Mutex mutex_;
     rtc::TimestampAligner timestamp_aligner_;
     VideoResolution resolution_;
+    webrtc::VideoFrameBufferPool rotation_pool_;
+
+    const bool is_screencast_;
+    std::vector<uint32_t> band_hashes_;
+    int hashed_width_ = 0;
+    int hashed_height_ = 0;
+    int64_t last_forwarded_us_ = 0;
+
+    rtc::scoped_refptr<KeyFrameRequestForwarder> keyframe_forwarder_;
+    uint64_t encoded_sequence_ = 0;
   };
 
  public:
-  VideoTrackSource(const VideoResolution& resolution);
+  VideoTrackSource(const VideoResolution& resolution, bool is_screencast);
 
   VideoResolution video_resolution() const;
+  bool is_screencast() const;
 
   bool on_captured_frame(const std::unique_ptr<VideoFrame>& frame)
       const;  // frames pushed from Rust (+interior mutability)
 
+  // Already encoded frames, forwarded as is by the PassthroughVideoEncoder
+  bool on_captured_encoded_frame(rust::Slice<const uint8_t> data,
+                                 VideoCodecType codec,
+                                 bool is_keyframe,
+                                 uint32_t width,
+                                 uint32_t height,
+                                 int64_t timestamp_us) const;
+  void set_keyframe_request_observer(
+      rust::Box<KeyFrameRequestObserverWrapper> observer) const;
+
   rtc::scoped_refptr<InternalSource> get() const;
 
  private:
@@ -121,7 +219,8 @@ class VideoTrackSource {
 };
 
 std::shared_ptr<VideoTrackSource> new_video_track_source(
-    const VideoResolution& resolution);
+    const VideoResolution& resolution,
+    bool is_screencast);
 
 static std::shared_ptr<MediaStreamTrack> video_to_media(
     std::shared_ptr<VideoTrack> track) {
@@ -17,6 +17,8 @@
 #pragma once
 
 #include <memory>
+#include <set>
+#include <vector>
 
 #include "api/media_stream_interface.h"
 #include "api/rtp_receiver_interface.h"
@@ -25,6 +27,8 @@
 #include "rtc_base/logging.h"
 #include "rtc_base/physical_socket_server.h"
 #include "rtc_base/ssl_adapter.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread.h"
 #include "rust/cxx.h"
 
 #ifdef WEBRTC_WIN
@@ -59,6 +63,19 @@ class RtcRuntime : public std::enable_shared_from_this<RtcRuntime> {
   rtc::Thread* worker_thread() const;
   rtc::Thread* signaling_thread() const;
 
+  // Threads running the FrameCryptors, each cryptor is pinned to one of them
+  // (round robin). Threads are started on demand and kept until the runtime
+  // is destroyed, lowering the count only affects the next cryptors.
+  rtc::Thread* next_crypto_thread();
+  void set_crypto_thread_count(int count);
+
+  // Receivers decrypted by a FrameCryptor, setting another frame transformer
+  // on them (e.g an EncodedFrameSink) would replace the cryptor
+  void add_encrypted_receiver(const webrtc::RtpReceiverInterface* receiver);
+  void remove_encrypted_receiver(const webrtc::RtpReceiverInterface* receiver);
+  bool is_encrypted_receiver(
+      const webrtc::RtpReceiverInterface* receiver) const;
+
   std::shared_ptr<MediaStreamTrack> get_or_create_media_stream_track(
       rtc::scoped_refptr<webrtc::MediaStreamTrackInterface> track);
 
@@ -75,6 +92,12 @@ class RtcRuntime : public std::enable_shared_from_this<RtcRuntime> {
   std::unique_ptr<rtc::Thread> worker_thread_;
   std::unique_ptr<rtc::Thread> signaling_thread_;
 
+  mutable webrtc::Mutex crypto_mutex_;
+  std::vector<std::unique_ptr<rtc::Thread>> crypto_threads_;
+  size_t crypto_thread_count_ = 2;
+  size_t next_crypto_thread_ = 0;
+  std::multiset<const webrtc::RtpReceiverInterface*> encrypted_receivers_;
+
   // Lists used to make sure we don't create multiple wrappers for one
   // underlying webrtc object. (e.g: webrtc::VideoTrackInterface should only
   // have one livekit::VideoTrack associated with it).
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2023 LiveKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the “License”);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an “AS IS” BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "livekit/audio_encoder_factory.h"
+
+#include "absl/strings/match.h"
+#include "api/audio_codecs/builtin_audio_encoder_factory.h"
+#include "livekit/passthrough_audio_encoder.h"
+
+namespace livekit {
+
+AudioEncoderFactory::AudioEncoderFactory()
+    : factory_(webrtc::CreateBuiltinAudioEncoderFactory()) {}
+
+std::vector<webrtc::AudioCodecSpec>
+AudioEncoderFactory::GetSupportedEncoders() {
+  return factory_->GetSupportedEncoders();
+}
+
+absl::optional<webrtc::AudioCodecInfo> AudioEncoderFactory::QueryAudioEncoder(
+    const webrtc::SdpAudioFormat& format) {
+  return factory_->QueryAudioEncoder(format);
+}
+
+std::unique_ptr<webrtc::AudioEncoder> AudioEncoderFactory::MakeAudioEncoder(
+    int payload_type,
+    const webrtc::SdpAudioFormat& format,
+    absl::optional<webrtc::AudioCodecPairId> codec_pair_id) {
+  std::unique_ptr<webrtc::AudioEncoder> encoder =
+      factory_->MakeAudioEncoder(payload_type, format, codec_pair_id);
+
+  if (encoder && absl::EqualsIgnoreCase(format.name, "opus")) {
+    // Opus packets captured by AudioTrackSource::capture_encoded_frame are
+    // sent as they are
+    encoder = std::make_unique<PassthroughAudioEncoder>(payload_type,
+                                                        std::move(encoder));
+  }
+
+  return encoder;
+}
+
+}  // namespace livekit
@@ -27,6 +27,7 @@
 #include "audio/remix_resample.h"
 #include "common_audio/include/audio_util.h"
 #include "livekit/global_task_queue.h"
+#include "livekit/passthrough_audio_encoder.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/ref_counted_object.h"
@@ -135,7 +136,11 @@ AudioTrackSource::InternalSource::InternalSource(
     : sample_rate_(sample_rate),
       num_channels_(num_channels),
       capture_userdata_(nullptr),
-      on_complete_(nullptr) {
+      on_complete_(nullptr),
+      encoded_channel_(EncodedAudioChannel::Create()),
+      silent_block_(kEncodedAudioBlockSamples, 0) {
+  encoded_channel_->AppendEmptyMarker(empty_marker_);
+
   if (!queue_size_ms)
     return;  // no audio queue
 
@@ -162,11 +167,14 @@ AudioTrackSource::InternalSource::InternalSource(
         webrtc::MutexLock lock(&mutex_);
 
         if (buffer_.size() >= samples10ms) {
-          for (auto sink : sinks_)
-            sink->OnData(buffer_.data(), sizeof(int16_t) * 8, sample_rate_,
-                         num_channels_, samples10ms / num_channels_);
+          send_block(buffer_.data(), sample_rate_, num_channels_,
+                     samples10ms / num_channels_);
 
           buffer_.erase(buffer_.begin(), buffer_.begin() + samples10ms);
+        } else if (encoded_) {
+          // Keep the RTP timestamps going while the upstream is in DTX
+          send_block(empty_marker_.data(), kEncodedAudioSampleRate, 1,
+                     kEncodedAudioBlockSamples);
         } else {
           missed_frames_++;
           if (missed_frames_ >= silence_frames_threshold) {
@@ -200,6 +208,9 @@ bool AudioTrackSource::InternalSource::capture_frame(
     void (*on_complete)(const SourceContext*)) {
   webrtc::MutexLock lock(&mutex_);
 
+  // Back to PCM, stop filling the gaps with empty markers
+  encoded_ = false;
+
   if (queue_size_samples_) {
     int available =
         (queue_size_samples_ + notify_threshold_samples_) - buffer_.size();
@@ -228,9 +239,66 @@ bool AudioTrackSource::InternalSource::capture_frame(
   return true;
 }
 
+bool AudioTrackSource::InternalSource::capture_encoded_frame(
+    rust::Slice<const uint8_t> data,
+    uint32_t duration_ms) {
+  webrtc::MutexLock lock(&mutex_);
+
+  if (sample_rate_ != kEncodedAudioSampleRate || num_channels_ != 1) {
+    RTC_LOG(LS_ERROR) << "encoded frames require a 48kHz mono source";
+    return false;
+  }
+
+  encoded_ = true;
+  rtc::ArrayView<const uint8_t> packet(data.data(), data.size());
+
+  if (queue_size_samples_) {
+    size_t available =
+        (queue_size_samples_ + notify_threshold_samples_) - buffer_.size();
+    if (available < duration_ms / 10 * kEncodedAudioBlockSamples)
+      return false;
+
+    return encoded_channel_->Push(packet, duration_ms, buffer_);
+  }
+
+  // capture directly when the queue buffer is 0 (the caller paces the frames)
+  std::vector<int16_t> markers;
+  if (!encoded_channel_->Push(packet, duration_ms, markers))
+    return false;
+
+  for (size_t offset = 0; offset < markers.size();
+       offset += kEncodedAudioBlockSamples) {
+    send_block(markers.data() + offset, kEncodedAudioSampleRate, 1,
+               kEncodedAudioBlockSamples);
+  }
+  return true;
+}
+
 void AudioTrackSource::InternalSource::clear_buffer() {
   webrtc::MutexLock lock(&mutex_);
   buffer_.clear();
+  encoded_channel_->Clear();
+  // The source restarts, it is in encoded mode again once an encoded frame
+  // is captured
+  encoded_ = false;
+}
+
+void AudioTrackSource::InternalSource::send_block(const int16_t* data,
+                                                  int sample_rate,
+                                                  size_t number_of_channels,
+                                                  size_t number_of_frames) {
+  // Markers are 48kHz mono blocks, the size of silent_block_
+  rtc::ArrayView<const int16_t> block(data, number_of_frames);
+  bool marker = number_of_channels == 1 &&
+                ReadEncodedAudioMarker(block, 1).has_value();
+
+  for (auto sink : sinks_) {
+    sink->OnData(marker && dynamic_cast<NativeAudioSink*>(sink)
+                     ? silent_block_.data()
+                     : data,
+                 sizeof(int16_t) * 8, sample_rate, number_of_channels,
+                 number_of_frames);
+  }
 }
 
 webrtc::MediaSourceInterface::SourceState
@@ -297,6 +365,11 @@ bool AudioTrackSource::capture_frame(
                                 number_of_frames, ctx, on_complete);
 }
 
+bool AudioTrackSource::capture_encoded_frame(rust::Slice<const uint8_t> data,
+                                             uint32_t duration_ms) const {
+  return source_->capture_encoded_frame(data, duration_ms);
+}
+
 void AudioTrackSource::clear_buffer() const {
   source_->clear_buffer();
 }
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2023 LiveKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the “License”);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an “AS IS” BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "livekit/codec_stats.h"
+
+#include <algorithm>
+#include <map>
+
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+#include "webrtc-sys/src/codec_stats.rs.h"
+
+namespace livekit {
+
+namespace {
+
+constexpr size_t kLatencyBuckets = 24;  // up to ~8s
+constexpr uint64_t kQpBucketWidth = 4;
+constexpr size_t kQpBuckets = 64;     // 0-255 covers every codec
+constexpr size_t kSizeBuckets = 25;   // up to ~16MB
+
+webrtc::Mutex decoder_stats_mutex;
+std::map<uint32_t, std::weak_ptr<CodecStats>> decoder_stats
+    RTC_GUARDED_BY(decoder_stats_mutex);
+
+}  // namespace
+
+AtomicHistogram::AtomicHistogram(Scale scale, uint64_t width, size_t buckets)
+    : scale_(scale),
+      width_(std::max<uint64_t>(width, 1)),
+      size_(buckets),
+      buckets_(new std::atomic<uint64_t>[buckets]) {
+  Reset();
+}
+
+size_t AtomicHistogram::BucketIndex(uint64_t value) const {
+  size_t index = 0;
+  if (scale_ == Scale::kLinear) {
+    index = static_cast<size_t>(value / width_);
+  } else {
+    while (value != 0) {  // bit width
+      ++index;
+      value >>= 1;
+    }
+  }
+  return std::min(index, size_ - 1);
+}
+
+void AtomicHistogram::Add(uint64_t value) {
+  buckets_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+
+  uint64_t max = max_.load(std::memory_order_relaxed);
+  while (value > max &&
+         !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+  }
+}
+
+HistogramSnapshot AtomicHistogram::Snapshot() const {
+  HistogramSnapshot snapshot{};
+  snapshot.count = count_.load(std::memory_order_relaxed);
+  snapshot.sum = sum_.load(std::memory_order_relaxed);
+  snapshot.max = max_.load(std::memory_order_relaxed);
+  snapshot.buckets.reserve(size_);
+  for (size_t i = 0; i < size_; ++i) {
+    snapshot.buckets.push_back(buckets_[i].load(std::memory_order_relaxed));
+  }
+  return snapshot;
+}
+
+void AtomicHistogram::Reset() {
+  for (size_t i = 0; i < size_; ++i) {
+    buckets_[i].store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+CodecStats::CodecStats()
+    : latency_us_(AtomicHistogram::Scale::kLog2, 1, kLatencyBuckets),
+      qp_(AtomicHistogram::Scale::kLinear, kQpBucketWidth, kQpBuckets),
+      size_bytes_(AtomicHistogram::Scale::kLog2, 1, kSizeBuckets) {}
+
+void CodecStats::RecordFrame(int64_t latency_us, int qp, size_t size_bytes) {
+  frames_.fetch_add(1, std::memory_order_relaxed);
+  latency_us_.Add(static_cast<uint64_t>(std::max<int64_t>(latency_us, 0)));
+  if (qp >= 0) {
+    qp_.Add(static_cast<uint64_t>(qp));
+  }
+  size_bytes_.Add(size_bytes);
+}
+
+void CodecStats::RecordDropped() {
+  dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CodecStats::RecordError() {
+  errors_.fetch_add(1, std::memory_order_relaxed);
+}
+
+CodecStatsSnapshot CodecStats::snapshot() const {
+  CodecStatsSnapshot snapshot{};
+  snapshot.frames = frames_.load(std::memory_order_relaxed);
+  snapshot.dropped = dropped_.load(std::memory_order_relaxed);
+  snapshot.errors = errors_.load(std::memory_order_relaxed);
+  snapshot.latency_us = latency_us_.Snapshot();
+  snapshot.qp = qp_.Snapshot();
+  snapshot.size_bytes = size_bytes_.Snapshot();
+  return snapshot;
+}
+
+void CodecStats::reset() const {
+  frames_.store(0, std::memory_order_relaxed);
+  dropped_.store(0, std::memory_order_relaxed);
+  errors_.store(0, std::memory_order_relaxed);
+  latency_us_.Reset();
+  qp_.Reset();
+  size_bytes_.Reset();
+}
+
+std::shared_ptr<CodecStats> SharedDecoderStats(uint32_t ssrc) {
+  webrtc::MutexLock lock(&decoder_stats_mutex);
+  std::weak_ptr<CodecStats>& entry = decoder_stats[ssrc];
+  std::shared_ptr<CodecStats> stats = entry.lock();
+  if (stats) {
+    return stats;
+  }
+
+  // Released streams leave expired entries behind
+  for (auto it = decoder_stats.begin(); it != decoder_stats.end();) {
+    it = it->second.expired() && it->first != ssrc ? decoder_stats.erase(it)
+                                                   : std::next(it);
+  }
+
+  stats = std::make_shared<CodecStats>();
+  entry = stats;
+  return stats;
+}
+
+}  // namespace livekit
@@ -0,0 +1,47 @@
+// Copyright 2023 LiveKit, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+use crate::impl_thread_safety;
+
+#[cxx::bridge(namespace = "livekit")]
+pub mod ffi {
+    #[derive(Debug, Clone, Default)]
+    pub struct HistogramSnapshot {
+        pub count: u64,
+        pub sum: u64,
+        pub max: u64,
+        pub buckets: Vec<u64>,
+    }
+
+    #[derive(Debug, Clone, Default)]
+    pub struct CodecStatsSnapshot {
+        pub frames: u64,
+        pub dropped: u64,
+        pub errors: u64,
+        pub latency_us: HistogramSnapshot,
+        pub qp: HistogramSnapshot,
+        pub size_bytes: HistogramSnapshot,
+    }
+
+    unsafe extern "C++" {
+        include!("livekit/codec_stats.h");
+
+        type CodecStats;
+
+        fn snapshot(self: &CodecStats) -> CodecStatsSnapshot;
+        fn reset(self: &CodecStats);
+    }
+}
+
+impl_thread_safety!(ffi::CodecStats, Send + Sync);
@@ -76,6 +76,34 @@ bool DataChannel::send(const DataBuffer& buffer) const {
       rtc::CopyOnWriteBuffer(buffer.ptr, buffer.len), buffer.binary});
 }
 
+bool DataChannel::send_buffer(std::unique_ptr<DataSendBuffer> buffer,
+                              bool binary) const {
+  return data_channel_->Send(webrtc::DataBuffer{buffer->release(), binary});
+}
+
+std::unique_ptr<DataSendBuffer> new_data_send_buffer(size_t size) {
+  return std::make_unique<DataSendBuffer>(size);
+}
+
+rust::Vec<bool> DataChannel::send_batch(
+    std::unique_ptr<DataSendBatch> batch) const {
+  rust::Vec<bool> results;
+  results.reserve(batch->len());
+
+  // The channel proxy runs Send on the network thread, calling it from
+  // there skips the hop per message
+  rtc_runtime_->network_thread()->BlockingCall([&] {
+    for (const webrtc::DataBuffer& buffer : batch->buffers()) {
+      results.push_back(data_channel_->Send(buffer));
+    }
+  });
+  return results;
+}
+
+std::unique_ptr<DataSendBatch> new_data_send_batch() {
+  return std::make_unique<DataSendBatch>();
+}
+
 int DataChannel::id() const {
   return data_channel_->id();
 }
@@ -96,6 +124,14 @@ uint64_t DataChannel::buffered_amount() const {
   return data_channel_->buffered_amount();
 }
 
+void DataChannel::set_buffered_amount_low_threshold(uint64_t threshold) const {
+  buffered_amount_low_threshold_.store(threshold, std::memory_order_relaxed);
+}
+
+uint64_t DataChannel::buffered_amount_low_threshold() const {
+  return buffered_amount_low_threshold_.load(std::memory_order_relaxed);
+}
+
 NativeDataChannelObserver::NativeDataChannelObserver(
     rust::Box<DataChannelObserverWrapper> observer,
     const DataChannel* dc)
@@ -106,16 +142,27 @@ void NativeDataChannelObserver::OnStateChange() {
 }
 
 void NativeDataChannelObserver::OnMessage(const webrtc::DataBuffer& buffer) {
-  DataBuffer data{};
-  data.ptr = buffer.data.data();
-  data.len = buffer.data.size();
-  data.binary = buffer.binary;
-  observer_->on_message(data);
+  observer_->on_message(std::make_unique<DataReceiveBuffer>(buffer.data),
+                        buffer.binary);
 }
 
 void NativeDataChannelObserver::OnBufferedAmountChange(
     uint64_t sent_data_size) {
-  observer_->on_buffered_amount_change(sent_data_size);
+  unreported_sent_ += sent_data_size;
+
+  uint64_t threshold = dc_->buffered_amount_low_threshold();
+  if (threshold != DataChannel::kNoThreshold) {
+    // Called right after the bytes left the buffer, nothing was queued in
+    // between so the previous amount is amount + sent_data_size
+    uint64_t amount = dc_->buffered_amount();
+    bool crossed = amount <= threshold && amount + sent_data_size > threshold;
+    bool drained = amount == 0 && sent_data_size > 0;
+    if (!crossed && !drained) {
+      return;
+    }
+  }
+
+  observer_->on_buffered_amount_change(std::exchange(unreported_sent_, 0));
 }
 
 }  // namespace livekit
@@ -14,6 +14,8 @@
 
 use std::sync::Arc;
 
+use cxx::UniquePtr;
+
 use crate::impl_thread_safety;
 
 #[cxx::bridge(namespace = "livekit")]
@@ -66,29 +68,58 @@ pub mod ffi {
         fn unregister_observer(self: &DataChannel);
 
         fn send(self: &DataChannel, data: &DataBuffer) -> bool;
+        fn send_buffer(self: &DataChannel, buffer: UniquePtr<DataSendBuffer>, binary: bool)
+            -> bool;
+        fn send_batch(self: &DataChannel, batch: UniquePtr<DataSendBatch>) -> Vec<bool>;
         fn id(self: &DataChannel) -> i32;
         fn label(self: &DataChannel) -> String;
         fn state(self: &DataChannel) -> DataState;
         fn close(self: &DataChannel);
         fn buffered_amount(self: &DataChannel) -> u64;
+        fn set_buffered_amount_low_threshold(self: &DataChannel, threshold: u64);
 
         fn _shared_data_channel() -> SharedPtr<DataChannel>; // Ignore
+
+        type DataSendBuffer;
+
+        fn new_data_send_buffer(size: usize) -> UniquePtr<DataSendBuffer>;
+        fn data(self: Pin<&mut DataSendBuffer>) -> &mut [u8];
+
+        type DataSendBatch;
+
+        fn new_data_send_batch() -> UniquePtr<DataSendBatch>;
+        fn add(self: Pin<&mut DataSendBatch>, size: usize, binary: bool) -> &mut [u8];
+        fn pop(self: Pin<&mut DataSendBatch>);
+        fn len(self: &DataSendBatch) -> usize;
+
+        type DataReceiveBuffer;
+
+        fn data(self: &DataReceiveBuffer) -> &[u8];
     }
 
     extern "Rust" {
         type DataChannelObserverWrapper;
 
         fn on_state_change(self: &DataChannelObserverWrapper, state: DataState);
-        fn on_message(self: &DataChannelObserverWrapper, buffer: DataBuffer);
+        fn on_message(
+            self: &DataChannelObserverWrapper,
+            buffer: UniquePtr<DataReceiveBuffer>,
+            binary: bool,
+        );
         fn on_buffered_amount_change(self: &DataChannelObserverWrapper, sent_data_size: u64);
     }
 }
 
 impl_thread_safety!(ffi::DataChannel, Send + Sync);
+impl_thread_safety!(ffi::DataSendBuffer, Send);
+impl_thread_safety!(ffi::DataSendBatch, Send);
+impl_thread_safety!(ffi::DataReceiveBuffer, Send + Sync);
 
 pub trait DataChannelObserver: Send + Sync {
     fn on_state_change(&self, state: ffi::DataState);
-    fn on_message(&self, data: &[u8], is_binary: bool);
+    /// The buffer can be kept after the call returns, the bytes are not
+    /// copied out of WebRTC
+    fn on_message(&self, buffer: UniquePtr<ffi::DataReceiveBuffer>, is_binary: bool);
     fn on_buffered_amount_change(&self, sent_data_size: u64);
 }
 
@@ -105,11 +136,8 @@ impl DataChannelObserverWrapper {
         self.observer.on_state_change(state);
     }
 
-    fn on_message(&self, buffer: ffi::DataBuffer) {
-        unsafe {
-            let data = std::slice::from_raw_parts(buffer.ptr, buffer.len);
-            self.observer.on_message(data, buffer.binary);
-        }
+    fn on_message(&self, buffer: UniquePtr<ffi::DataReceiveBuffer>, binary: bool) {
+        self.observer.on_message(buffer, binary);
     }
 
     fn on_buffered_amount_change(&self, sent_data_size: u64) {
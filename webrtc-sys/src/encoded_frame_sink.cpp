@@ -0,0 +1,190 @@
+/*
+ * Copyright 2023 LiveKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the “License”);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an “AS IS” BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "livekit/encoded_frame_sink.h"
+
+#include <stdexcept>
+#include <utility>
+
+#include "api/make_ref_counted.h"
+#include "api/media_stream_interface.h"
+#include "webrtc-sys/src/encoded_frame_sink.rs.h"
+
+namespace livekit {
+
+EncodedFrameTap::EncodedFrameTap(bool is_video,
+                                 rust::Box<EncodedFrameSinkWrapper> observer,
+                                 bool suppress_decoding)
+    : is_video_(is_video),
+      observer_(std::move(observer)),
+      suppress_decoding_(suppress_decoding) {}
+
+void EncodedFrameTap::Transform(
+    std::unique_ptr<webrtc::TransformableFrameInterface> frame) {
+  rtc::scoped_refptr<webrtc::TransformedFrameCallback> callback;
+  {
+    webrtc::MutexLock lock(&mutex_);
+    if (observer_) {
+      EncodedFrameInfo info{};
+      info.rtp_timestamp = frame->GetTimestamp();
+      info.ssrc = frame->GetSsrc();
+      info.payload_type = frame->GetPayloadType();
+      if (is_video_) {
+        auto video_frame =
+            static_cast<webrtc::TransformableVideoFrameInterface*>(frame.get());
+        webrtc::VideoFrameMetadata metadata = video_frame->Metadata();
+        info.is_keyframe = video_frame->IsKeyFrame();
+        info.width = metadata.GetWidth();
+        info.height = metadata.GetHeight();
+      }
+
+      rtc::ArrayView<const uint8_t> data = frame->GetData();
+      (*observer_)->on_encoded_frame(
+          rust::Slice<const uint8_t>(data.data(), data.size()), info);
+
+      // Audio has no lazy decoder to skip the empty frames
+      if (suppress_decoding_ && is_video_) {
+        frame->SetData(rtc::ArrayView<const uint8_t>());
+      }
+    }
+
+    auto it = sink_callbacks_.find(frame->GetSsrc());
+    callback = it != sink_callbacks_.end() ? it->second : callback_;
+  }
+
+  if (callback) {
+    callback->OnTransformedFrame(std::move(frame));
+  }
+}
+
+void EncodedFrameTap::RegisterTransformedFrameCallback(
+    rtc::scoped_refptr<webrtc::TransformedFrameCallback> callback) {
+  webrtc::MutexLock lock(&mutex_);
+  callback_ = std::move(callback);
+}
+
+void EncodedFrameTap::RegisterTransformedFrameSinkCallback(
+    rtc::scoped_refptr<webrtc::TransformedFrameCallback> callback,
+    uint32_t ssrc) {
+  webrtc::MutexLock lock(&mutex_);
+  sink_callbacks_[ssrc] = std::move(callback);
+}
+
+void EncodedFrameTap::UnregisterTransformedFrameCallback() {
+  webrtc::MutexLock lock(&mutex_);
+  callback_ = nullptr;
+}
+
+void EncodedFrameTap::UnregisterTransformedFrameSinkCallback(uint32_t ssrc) {
+  webrtc::MutexLock lock(&mutex_);
+  sink_callbacks_.erase(ssrc);
+}
+
+bool EncodedFrameTap::set_suppress_decoding(bool suppress) {
+  webrtc::MutexLock lock(&mutex_);
+  bool resumed = suppress_decoding_ && !suppress;
+  suppress_decoding_ = suppress;
+  return resumed && is_video_;
+}
+
+bool EncodedFrameTap::suppress_decoding() const {
+  webrtc::MutexLock lock(&mutex_);
+  return suppress_decoding_;
+}
+
+void EncodedFrameTap::detach() {
+  webrtc::MutexLock lock(&mutex_);
+  observer_.reset();
+}
+
+EncodedFrameSink::EncodedFrameSink(
+    rtc::scoped_refptr<webrtc::RtpReceiverInterface> receiver,
+    std::shared_ptr<VideoTrack> video_track,
+    rust::Box<EncodedFrameSinkWrapper> observer,
+    bool suppress_decoding)
+    : receiver_(std::move(receiver)), video_track_(std::move(video_track)) {
+  tap_ = rtc::make_ref_counted<EncodedFrameTap>(
+      receiver_->media_type() == cricket::MEDIA_TYPE_VIDEO,
+      std::move(observer), suppress_decoding);
+  receiver_->SetDepacketizerToDecoderFrameTransformer(tap_);
+
+  // Lazy receive would stop the stream (and the tap) without a video sink
+  if (video_track_) {
+    video_track_->add_receive_hold();
+  }
+}
+
+EncodedFrameSink::~EncodedFrameSink() {
+  // The frames following the detach reach the decoder again
+  if (tap_->set_suppress_decoding(false)) {
+    RequestKeyFrame();
+  }
+  tap_->detach();
+
+  if (video_track_) {
+    video_track_->remove_receive_hold();
+  }
+}
+
+void EncodedFrameSink::set_suppress_decoding(bool suppress) const {
+  if (tap_->set_suppress_decoding(suppress)) {
+    RequestKeyFrame();
+  }
+}
+
+void EncodedFrameSink::RequestKeyFrame() const {
+  // The decoder only saw empty frames, it can't resume before a keyframe
+  rtc::scoped_refptr<webrtc::MediaStreamTrackInterface> track =
+      receiver_->track();
+  if (!track) {
+    return;
+  }
+  webrtc::VideoTrackSourceInterface* source =
+      static_cast<webrtc::VideoTrackInterface*>(track.get())->GetSource();
+  if (source) {
+    source->GenerateKeyFrame();
+  }
+}
+
+bool EncodedFrameSink::suppress_decoding() const {
+  return tap_->suppress_decoding();
+}
+
+std::shared_ptr<EncodedFrameSink> new_encoded_frame_sink(
+    std::shared_ptr<RtpReceiver> receiver,
+    rust::Box<EncodedFrameSinkWrapper> observer,
+    bool suppress_decoding) {
+  if (receiver->rtc_runtime()->is_encrypted_receiver(
+          receiver->rtc_receiver().get())) {
+    throw std::runtime_error(
+        "the receiver is decrypted by a FrameCryptor, an encoded frame sink "
+        "would replace it");
+  }
+  std::shared_ptr<VideoTrack> video_track;
+  rtc::scoped_refptr<webrtc::MediaStreamTrackInterface> track =
+      receiver->rtc_receiver()->track();
+  if (track && track->kind() == webrtc::MediaStreamTrackInterface::kVideoKind) {
+    video_track = receiver->rtc_runtime()->get_or_create_video_track(
+        rtc::scoped_refptr<webrtc::VideoTrackInterface>(
+            static_cast<webrtc::VideoTrackInterface*>(track.get())));
+  }
+  return std::make_shared<EncodedFrameSink>(receiver->rtc_receiver(),
+                                            std::move(video_track),
+                                            std::move(observer),
+                                            suppress_decoding);
+}
+
+}  // namespace livekit
@@ -0,0 +1,77 @@
+// Copyright 2023 LiveKit, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+use std::sync::Arc;
+
+use crate::impl_thread_safety;
+
+#[cxx::bridge(namespace = "livekit")]
+pub mod ffi {
+    #[derive(Debug, Clone, Copy, Default)]
+    pub struct EncodedFrameInfo {
+        pub rtp_timestamp: u32,
+        pub ssrc: u32,
+        pub payload_type: u8,
+        pub is_keyframe: bool,
+        pub width: u32,
+        pub height: u32,
+    }
+
+    extern "C++" {
+        include!("livekit/rtp_receiver.h");
+
+        type RtpReceiver = crate::rtp_receiver::ffi::RtpReceiver;
+    }
+
+    unsafe extern "C++" {
+        include!("livekit/encoded_frame_sink.h");
+
+        type EncodedFrameSink;
+
+        fn new_encoded_frame_sink(
+            receiver: SharedPtr<RtpReceiver>,
+            observer: Box<EncodedFrameSinkWrapper>,
+            suppress_decoding: bool,
+        ) -> Result<SharedPtr<EncodedFrameSink>>;
+
+        fn set_suppress_decoding(self: &EncodedFrameSink, suppress: bool);
+        fn suppress_decoding(self: &EncodedFrameSink) -> bool;
+    }
+
+    extern "Rust" {
+        type EncodedFrameSinkWrapper;
+
+        fn on_encoded_frame(self: &EncodedFrameSinkWrapper, data: &[u8], info: EncodedFrameInfo);
+    }
+}
+
+impl_thread_safety!(ffi::EncodedFrameSink, Send + Sync);
+
+pub trait EncodedFrameSinkObserver: Send + Sync {
+    fn on_encoded_frame(&self, data: &[u8], info: ffi::EncodedFrameInfo);
+}
+
+pub struct EncodedFrameSinkWrapper {
+    observer: Arc<dyn EncodedFrameSinkObserver>,
+}
+
+impl EncodedFrameSinkWrapper {
+    pub fn new(observer: Arc<dyn EncodedFrameSinkObserver>) -> Self {
+        Self { observer }
+    }
+
+    fn on_encoded_frame(&self, data: &[u8], info: ffi::EncodedFrameInfo) {
+        self.observer.on_encoded_frame(data, info);
+    }
+}
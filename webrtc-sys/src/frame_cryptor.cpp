@@ -16,14 +16,21 @@
 
 #include "livekit/frame_cryptor.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "absl/types/optional.h"
 #include "api/make_ref_counted.h"
+#include "api/video/video_codec_type.h"
 #include "livekit/peer_connection.h"
 #include "livekit/peer_connection_factory.h"
 #include "livekit/webrtc.h"
+#include "openssl/aead.h"
+#include "openssl/rand.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/cpu_time.h"
 #include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
 #include "webrtc-sys/src/frame_cryptor.rs.h"
 
 namespace livekit {
@@ -40,7 +47,40 @@ webrtc::FrameCryptorTransformer::Algorithm AlgorithmToFrameCryptorAlgorithm(
   }
 }
 
-KeyProvider::KeyProvider(KeyProviderOptions options) {
+namespace {
+
+constexpr size_t kLatencyBuckets = 24;  // up to ~8s
+
+// Frames transformed per task, the other cryptors sharing the thread get a
+// turn between batches
+constexpr size_t kMaxBatchSize = 16;
+
+// Ratchet steps derived ahead of time per key, each one is a full key
+// derivation
+constexpr size_t kMaxPrefetchedRatchets = 8;
+
+// AES-GCM frames of webrtc::FrameCryptorTransformer, the trailer holds the
+// IV size and the key index
+constexpr size_t kFrameIvSize = 12;
+constexpr size_t kFrameTagSize = 16;
+constexpr size_t kFrameTrailerSize = 2;
+
+bool IsFailure(FrameCryptionState state) {
+  return state == FrameCryptionState::EncryptionFailed ||
+         state == FrameCryptionState::DecryptionFailed ||
+         state == FrameCryptionState::MissingKey ||
+         state == FrameCryptionState::InternalError;
+}
+
+}  // namespace
+
+struct AeadContext {
+  std::vector<uint8_t> key;
+  bssl::ScopedEVP_AEAD_CTX aead;
+};
+
+KeyProvider::KeyProvider(KeyProviderOptions options)
+    : shared_key_(options.shared_key) {
   webrtc::KeyProviderOptions rtc_options;
   rtc_options.shared_key = options.shared_key;
 
@@ -54,27 +94,506 @@ KeyProvider::KeyProvider(KeyProviderOptions options) {
 
   impl_ =
       new rtc::RefCountedObject<webrtc::DefaultKeyProviderImpl>(rtc_options);
+
+  if (options.ratchet_window_size > 0) {
+    prefetcher_ = std::make_unique<RatchetPrefetcher>(
+        rtc_options, std::min<size_t>(options.ratchet_window_size,
+                                      kMaxPrefetchedRatchets));
+  }
+}
+
+std::vector<uint8_t> KeyProvider::RatchetKey(const std::string& participant_id,
+                                             int index) const {
+  bool shared = participant_id.empty();
+  webrtc::MutexLock lock(&ratchet_mutex_);
+  if (prefetcher_) {
+    std::vector<uint8_t> current =
+        shared ? impl_->ExportSharedKey(index)
+               : impl_->ExportKey(participant_id, index);
+    std::vector<uint8_t> next =
+        prefetcher_->Take(participant_id, index, current);
+    if (!next.empty()) {
+      bool installed = shared ? impl_->SetSharedKey(index, next)
+                              : impl_->SetKey(participant_id, index, next);
+      if (installed) {
+        return next;
+      }
+    }
+  }
+
+  // Nothing prefetched for the installed material (e.g. the FrameCryptor
+  // ratcheted it after a decryption failure), derive it here
+  std::vector<uint8_t> next = shared ? impl_->RatchetSharedKey(index)
+                                     : impl_->RatchetKey(participant_id, index);
+  if (prefetcher_ && !next.empty()) {
+    prefetcher_->Reset(participant_id, index, next);
+  }
+  return next;
+}
+
+rtc::scoped_refptr<webrtc::ParticipantKeyHandler> KeyProvider::key_handler(
+    const std::string& participant_id) const {
+  return shared_key_ ? impl_->GetSharedKey(participant_id)
+                     : impl_->GetKey(participant_id);
+}
+
+RatchetPrefetcher::RatchetPrefetcher(const webrtc::KeyProviderOptions& options,
+                                     size_t depth)
+    : depth_(depth),
+      thread_(rtc::Thread::Create()),
+      shadow_(rtc::make_ref_counted<webrtc::DefaultKeyProviderImpl>(options)) {
+  thread_->SetName("ratchet_thread", thread_.get());
+  thread_->Start();
+}
+
+RatchetPrefetcher::~RatchetPrefetcher() {
+  thread_->Stop();
+}
+
+void RatchetPrefetcher::Reset(const std::string& participant_id,
+                              int index,
+                              std::vector<uint8_t> material) {
+  WindowKey key(participant_id, index);
+  uint64_t generation;
+  {
+    webrtc::MutexLock lock(&mutex_);
+    int64_t now_us = rtc::TimeMicros();
+    EvictIdleWindows(now_us);
+
+    Window& window = windows_[key];
+    window.last_used_us = now_us;
+    window.generation = generation = next_generation_++;
+    window.current = std::move(material);
+    window.next.clear();
+    window.shadow_synced = false;
+    if (window.filling) {
+      return;  // the running Fill picks up the new generation
+    }
+    window.filling = true;
+  }
+
+  thread_->PostTask([this, key = std::move(key), generation]() {
+    Fill(key, generation);
+  });
+}
+
+std::vector<uint8_t> RatchetPrefetcher::Take(
+    const std::string& participant_id,
+    int index,
+    const std::vector<uint8_t>& current) {
+  WindowKey key(participant_id, index);
+  std::vector<uint8_t> next;
+  uint64_t generation;
+  {
+    webrtc::MutexLock lock(&mutex_);
+    EvictIdleWindows(rtc::TimeMicros());
+    auto it = windows_.find(key);
+    if (it == windows_.end() || it->second.current != current ||
+        it->second.next.empty()) {
+      return next;
+    }
+
+    Window& window = it->second;
+    window.last_used_us = rtc::TimeMicros();
+    next = std::move(window.next.front());
+    window.next.pop_front();
+    window.current = next;
+    generation = window.generation;
+    if (window.filling) {
+      return next;
+    }
+    window.filling = true;
+  }
+
+  // Slide the window
+  thread_->PostTask([this, key = std::move(key), generation]() {
+    Fill(key, generation);
+  });
+  return next;
+}
+
+void RatchetPrefetcher::Fill(WindowKey key, uint64_t generation) {
+  const std::string& participant_id = key.first;
+  const int index = key.second;
+  bool shared = participant_id.empty();
+
+  while (true) {
+    std::vector<uint8_t> from;
+    {
+      webrtc::MutexLock lock(&mutex_);
+      Window& window = windows_[key];
+      if (window.generation != generation) {
+        // Reset while deriving, restart from the new material
+        generation = window.generation;
+      }
+      if (window.next.size() >= depth_) {
+        window.filling = false;
+        return;
+      }
+      if (!window.shadow_synced) {
+        from = window.next.empty() ? window.current : window.next.back();
+      }
+    }
+
+    if (!from.empty()) {
+      if (shared) {
+        shadow_->SetSharedKey(index, from);
+      } else {
+        shadow_->SetKey(participant_id, index, from);
+      }
+    }
+
+    std::vector<uint8_t> next =
+        shared ? shadow_->RatchetSharedKey(index)
+               : shadow_->RatchetKey(participant_id, index);
+
+    webrtc::MutexLock lock(&mutex_);
+    Window& window = windows_[key];
+    if (next.empty()) {
+      window.filling = false;
+      return;
+    }
+    if (window.generation == generation) {
+      window.next.push_back(std::move(next));
+      window.shadow_synced = true;
+    }
+  }
+}
+
+void RatchetPrefetcher::EvictIdleWindows(int64_t now_us) {
+  if (now_us - last_eviction_us_ < kWindowIdleTimeoutUs) {
+    return;
+  }
+  last_eviction_us_ = now_us;
+
+  for (auto it = windows_.begin(); it != windows_.end();) {
+    // A filling window is still referenced by Fill
+    bool idle = !it->second.filling &&
+                now_us - it->second.last_used_us >= kWindowIdleTimeoutUs;
+    it = idle ? windows_.erase(it) : std::next(it);
+  }
+}
+
+CryptoWorkerTransformer::CryptoWorkerTransformer(
+    rtc::Thread* thread,
+    rtc::scoped_refptr<webrtc::FrameCryptorTransformer> transformer,
+    std::unique_ptr<GcmFrameCipher> cipher)
+    : thread_(thread),
+      transformer_(std::move(transformer)),
+      cipher_(std::move(cipher)),
+      state_(FrameCryptionState::New),
+      transformer_state_(FrameCryptionState::New),
+      latency_us_(AtomicHistogram::Scale::kLog2, 1, kLatencyBuckets),
+      output_(std::make_shared<OutputCounters>()) {}
+
+CryptoWorkerTransformer::CountingCallback::CountingCallback(
+    rtc::scoped_refptr<webrtc::TransformedFrameCallback> sink,
+    std::shared_ptr<OutputCounters> counters)
+    : sink_(std::move(sink)), counters_(std::move(counters)) {}
+
+void CryptoWorkerTransformer::CountingCallback::OnTransformedFrame(
+    std::unique_ptr<webrtc::TransformableFrameInterface> frame) {
+  counters_->frames.fetch_add(1, std::memory_order_relaxed);
+  counters_->bytes.fetch_add(frame->GetData().size(),
+                             std::memory_order_relaxed);
+  sink_->OnTransformedFrame(std::move(frame));
+}
+
+void CryptoWorkerTransformer::CountingCallback::StartShortCircuiting() {
+  sink_->StartShortCircuiting();
+}
+
+void CryptoWorkerTransformer::Transform(
+    std::unique_ptr<webrtc::TransformableFrameInterface> frame) {
+  uint32_t depth = queue_depth_.fetch_add(1, std::memory_order_relaxed) + 1;
+  uint32_t max = max_queue_depth_.load(std::memory_order_relaxed);
+  while (depth > max && !max_queue_depth_.compare_exchange_weak(
+                            max, depth, std::memory_order_relaxed)) {
+  }
+
+  {
+    webrtc::MutexLock lock(&mutex_);
+    queue_.push_back({std::move(frame), rtc::TimeMicros()});
+    if (drain_pending_) {
+      return;
+    }
+    drain_pending_ = true;
+  }
+
+  thread_->PostTask(
+      [self = rtc::scoped_refptr<CryptoWorkerTransformer>(this)]() {
+        self->Drain();
+      });
+}
+
+void CryptoWorkerTransformer::Drain() {
+  std::vector<QueuedFrame> batch;
+  batch.reserve(kMaxBatchSize);
+  {
+    webrtc::MutexLock lock(&mutex_);
+    while (!queue_.empty() && batch.size() < kMaxBatchSize) {
+      batch.push_back(std::move(queue_.front()));
+      queue_.pop_front();
+    }
+  }
+
+  int64_t cpu_start_ns = rtc::GetThreadCpuTimeNanos();
+  BatchKey key;
+  for (QueuedFrame& queued : batch) {
+    queue_depth_.fetch_sub(1, std::memory_order_relaxed);
+    // Counted together when handed over, queued frames are in queue_depth
+    frames_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(queued.frame->GetData().size(),
+                     std::memory_order_relaxed);
+    if (!TransformWithCipher(queued.frame, key)) {
+      TransformWithFallback(std::move(queued.frame));
+    }
+    int64_t latency_us = rtc::TimeMicros() - queued.queued_us;
+    latency_us_.Add(static_cast<uint64_t>(std::max<int64_t>(latency_us, 0)));
+  }
+  int64_t cpu_ns = rtc::GetThreadCpuTimeNanos() - cpu_start_ns;
+  if (cpu_start_ns >= 0 && cpu_ns > 0) {
+    cpu_time_us_.fetch_add(static_cast<uint64_t>(cpu_ns / 1000),
+                           std::memory_order_relaxed);
+  }
+
+  {
+    webrtc::MutexLock lock(&mutex_);
+    if (queue_.empty()) {
+      drain_pending_ = false;
+      return;
+    }
+  }
+
+  // More frames came in, queue behind the tasks already posted
+  thread_->PostTask(
+      [self = rtc::scoped_refptr<CryptoWorkerTransformer>(this)]() {
+        self->Drain();
+      });
+}
+
+bool CryptoWorkerTransformer::TransformWithCipher(
+    std::unique_ptr<webrtc::TransformableFrameInterface>& frame,
+    BatchKey& key) {
+  if (!cipher_ || frame->GetData().empty() || !transformer_->enabled()) {
+    return false;
+  }
+  rtc::scoped_refptr<webrtc::TransformedFrameCallback> sink =
+      callback(frame->GetSsrc());
+  if (!sink) {
+    return false;
+  }
+
+  if (frame->GetDirection() ==
+      webrtc::TransformableFrameInterface::Direction::kSender) {
+    if (!key.fetched) {
+      key.fetched = true;
+      key.index = transformer_->key_index();
+      key.ctx = cipher_->EncryptionContext(key.index);
+    }
+    if (!key.ctx || !cipher_->Encrypt(*frame, *key.ctx, key.index)) {
+      return false;
+    }
+  } else {
+    if (!cipher_->Decrypt(*frame)) {
+      return false;
+    }
+    if (mark_valid_key_) {
+      mark_valid_key_ = false;
+      cipher_->MarkValidKey();
+    }
+  }
+
+  Report(FrameCryptionState::Ok);
+  sink->OnTransformedFrame(std::move(frame));
+  return true;
+}
+
+void CryptoWorkerTransformer::TransformWithFallback(
+    std::unique_ptr<webrtc::TransformableFrameInterface> frame) {
+  uint64_t delivered = output_->frames.load(std::memory_order_relaxed);
+  transformer_->Transform(std::move(frame));
+  if (!cipher_ ||
+      output_->frames.load(std::memory_order_relaxed) != delivered) {
+    return;
+  }
+
+  // Dropped, the next frame decrypting with the current key validates it
+  // again for the FrameCryptorTransformer
+  mark_valid_key_ = true;
+  FrameCryptionState state =
+      transformer_state_.load(std::memory_order_relaxed);
+  if (IsFailure(state)) {
+    Report(state);
+  }
+}
+
+rtc::scoped_refptr<webrtc::TransformedFrameCallback>
+CryptoWorkerTransformer::callback(uint32_t ssrc) const {
+  webrtc::MutexLock lock(&callbacks_mutex_);
+  auto it = sink_callbacks_.find(ssrc);
+  return it != sink_callbacks_.end() ? it->second : callback_;
+}
+
+void CryptoWorkerTransformer::RegisterTransformedFrameCallback(
+    rtc::scoped_refptr<webrtc::TransformedFrameCallback> callback) {
+  auto counting =
+      rtc::make_ref_counted<CountingCallback>(std::move(callback), output_);
+  {
+    webrtc::MutexLock lock(&callbacks_mutex_);
+    callback_ = counting;
+  }
+  transformer_->RegisterTransformedFrameCallback(counting);
+}
+
+void CryptoWorkerTransformer::RegisterTransformedFrameSinkCallback(
+    rtc::scoped_refptr<webrtc::TransformedFrameCallback> callback,
+    uint32_t ssrc) {
+  auto counting =
+      rtc::make_ref_counted<CountingCallback>(std::move(callback), output_);
+  {
+    webrtc::MutexLock lock(&callbacks_mutex_);
+    sink_callbacks_[ssrc] = counting;
+  }
+  transformer_->RegisterTransformedFrameSinkCallback(counting, ssrc);
+}
+
+void CryptoWorkerTransformer::UnregisterTransformedFrameCallback() {
+  {
+    webrtc::MutexLock lock(&callbacks_mutex_);
+    callback_ = nullptr;
+  }
+  transformer_->UnregisterTransformedFrameCallback();
+}
+
+void CryptoWorkerTransformer::UnregisterTransformedFrameSinkCallback(
+    uint32_t ssrc) {
+  {
+    webrtc::MutexLock lock(&callbacks_mutex_);
+    sink_callbacks_.erase(ssrc);
+  }
+  transformer_->UnregisterTransformedFrameSinkCallback(ssrc);
+}
+
+bool CryptoWorkerTransformer::OnTransformerStateChanged(
+    FrameCryptionState state) {
+  transformer_state_.store(state, std::memory_order_relaxed);
+  return Transition(state);
+}
+
+void CryptoWorkerTransformer::set_observer(
+    rtc::scoped_refptr<NativeFrameCryptorObserver> observer) {
+  webrtc::MutexLock lock(&observer_mutex_);
+  observer_ = std::move(observer);
+}
+
+void CryptoWorkerTransformer::Report(FrameCryptionState state) {
+  if (!Transition(state)) {
+    return;
+  }
+  rtc::scoped_refptr<NativeFrameCryptorObserver> observer;
+  {
+    webrtc::MutexLock lock(&observer_mutex_);
+    observer = observer_;
+  }
+  if (observer) {
+    observer->Notify(state);
+  }
+}
+
+bool CryptoWorkerTransformer::Transition(FrameCryptionState state) {
+  // Every frame reports Ok, skip the write when nothing changes
+  if (state_.load(std::memory_order_relaxed) == state ||
+      state_.exchange(state, std::memory_order_relaxed) == state) {
+    return false;
+  }
+  switch (state) {
+    case FrameCryptionState::EncryptionFailed:
+      encryption_failures_.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case FrameCryptionState::DecryptionFailed:
+      decryption_failures_.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case FrameCryptionState::MissingKey:
+      missing_keys_.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case FrameCryptionState::InternalError:
+      internal_errors_.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case FrameCryptionState::KeyRatcheted:
+      key_ratchets_.fetch_add(1, std::memory_order_relaxed);
+      break;
+    default:
+      break;
+  }
+  return true;
+}
+
+FrameCryptorStats CryptoWorkerTransformer::stats() const {
+  FrameCryptorStats stats{};
+  stats.frames = frames_.load(std::memory_order_relaxed);
+  stats.bytes = bytes_.load(std::memory_order_relaxed);
+  stats.frames_out = output_->frames.load(std::memory_order_relaxed);
+  stats.bytes_out = output_->bytes.load(std::memory_order_relaxed);
+  stats.cpu_time_us = cpu_time_us_.load(std::memory_order_relaxed);
+  stats.encryption_failures =
+      encryption_failures_.load(std::memory_order_relaxed);
+  stats.decryption_failures =
+      decryption_failures_.load(std::memory_order_relaxed);
+  stats.missing_keys = missing_keys_.load(std::memory_order_relaxed);
+  stats.internal_errors = internal_errors_.load(std::memory_order_relaxed);
+  stats.key_ratchets = key_ratchets_.load(std::memory_order_relaxed);
+  stats.queue_depth = queue_depth_.load(std::memory_order_relaxed);
+  stats.max_queue_depth = max_queue_depth_.load(std::memory_order_relaxed);
+  stats.latency_us = latency_us_.Snapshot();
+  return stats;
+}
+
+void CryptoWorkerTransformer::reset_stats() {
+  frames_.store(0, std::memory_order_relaxed);
+  bytes_.store(0, std::memory_order_relaxed);
+  output_->frames.store(0, std::memory_order_relaxed);
+  output_->bytes.store(0, std::memory_order_relaxed);
+  cpu_time_us_.store(0, std::memory_order_relaxed);
+  encryption_failures_.store(0, std::memory_order_relaxed);
+  decryption_failures_.store(0, std::memory_order_relaxed);
+  missing_keys_.store(0, std::memory_order_relaxed);
+  internal_errors_.store(0, std::memory_order_relaxed);
+  key_ratchets_.store(0, std::memory_order_relaxed);
+  max_queue_depth_.store(queue_depth_.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+  latency_us_.Reset();
 }
 
 FrameCryptor::FrameCryptor(
     std::shared_ptr<RtcRuntime> rtc_runtime,
     const std::string participant_id,
     webrtc::FrameCryptorTransformer::Algorithm algorithm,
-    rtc::scoped_refptr<webrtc::KeyProvider> key_provider,
+    std::shared_ptr<KeyProvider> key_provider,
     rtc::scoped_refptr<webrtc::RtpSenderInterface> sender)
     : rtc_runtime_(rtc_runtime),
       participant_id_(participant_id),
-      key_provider_(key_provider),
+      key_provider_(key_provider->rtc_key_provider()),
       sender_(sender) {
   auto mediaType =
       sender->track()->kind() == "audio"
           ? webrtc::FrameCryptorTransformer::MediaType::kAudioFrame
           : webrtc::FrameCryptorTransformer::MediaType::kVideoFrame;
+  // Encryption and the state notifications run on a crypto thread, away
+  // from the signaling thread
+  rtc::Thread* crypto_thread = rtc_runtime->next_crypto_thread();
   e2ee_transformer_ = rtc::scoped_refptr<webrtc::FrameCryptorTransformer>(
-      new webrtc::FrameCryptorTransformer(rtc_runtime->signaling_thread(),
-                                          participant_id, mediaType, algorithm,
-                                          key_provider_));
-  sender->SetEncoderToPacketizerFrameTransformer(e2ee_transformer_);
+      new webrtc::FrameCryptorTransformer(crypto_thread, participant_id,
+                                          mediaType, algorithm, key_provider_));
+  std::unique_ptr<GcmFrameCipher> cipher;
+  if (algorithm == webrtc::FrameCryptorTransformer::Algorithm::kAesGcm) {
+    cipher = std::make_unique<GcmFrameCipher>(
+        key_provider, participant_id,
+        mediaType == webrtc::FrameCryptorTransformer::MediaType::kVideoFrame);
+  }
+  worker_ = rtc::make_ref_counted<CryptoWorkerTransformer>(
+      crypto_thread, e2ee_transformer_, std::move(cipher));
+  sender->SetEncoderToPacketizerFrameTransformer(worker_);
   e2ee_transformer_->SetEnabled(false);
 }
 
@@ -82,21 +601,32 @@ FrameCryptor::FrameCryptor(
     std::shared_ptr<RtcRuntime> rtc_runtime,
     const std::string participant_id,
     webrtc::FrameCryptorTransformer::Algorithm algorithm,
-    rtc::scoped_refptr<webrtc::KeyProvider> key_provider,
+    std::shared_ptr<KeyProvider> key_provider,
     rtc::scoped_refptr<webrtc::RtpReceiverInterface> receiver)
     : rtc_runtime_(rtc_runtime),
       participant_id_(participant_id),
-      key_provider_(key_provider),
+      key_provider_(key_provider->rtc_key_provider()),
       receiver_(receiver) {
   auto mediaType =
       receiver->track()->kind() == "audio"
           ? webrtc::FrameCryptorTransformer::MediaType::kAudioFrame
           : webrtc::FrameCryptorTransformer::MediaType::kVideoFrame;
+  // Encryption and the state notifications run on a crypto thread, away
+  // from the signaling thread
+  rtc::Thread* crypto_thread = rtc_runtime->next_crypto_thread();
   e2ee_transformer_ = rtc::scoped_refptr<webrtc::FrameCryptorTransformer>(
-      new webrtc::FrameCryptorTransformer(rtc_runtime->signaling_thread(),
-                                          participant_id, mediaType, algorithm,
-                                          key_provider_));
-  receiver->SetDepacketizerToDecoderFrameTransformer(e2ee_transformer_);
+      new webrtc::FrameCryptorTransformer(crypto_thread, participant_id,
+                                          mediaType, algorithm, key_provider_));
+  std::unique_ptr<GcmFrameCipher> cipher;
+  if (algorithm == webrtc::FrameCryptorTransformer::Algorithm::kAesGcm) {
+    cipher = std::make_unique<GcmFrameCipher>(
+        key_provider, participant_id,
+        mediaType == webrtc::FrameCryptorTransformer::MediaType::kVideoFrame);
+  }
+  worker_ = rtc::make_ref_counted<CryptoWorkerTransformer>(
+      crypto_thread, e2ee_transformer_, std::move(cipher));
+  receiver->SetDepacketizerToDecoderFrameTransformer(worker_);
+  rtc_runtime_->add_encrypted_receiver(receiver.get());
   e2ee_transformer_->SetEnabled(false);
 }
 
@@ -104,34 +634,50 @@ FrameCryptor::~FrameCryptor() {
   if (observer_) {
     unregister_observer();
   }
+  if (receiver_) {
+    rtc_runtime_->remove_encrypted_receiver(receiver_.get());
+  }
 }
 
 void FrameCryptor::register_observer(
     rust::Box<RtcFrameCryptorObserverWrapper> observer) const {
   webrtc::MutexLock lock(&mutex_);
   observer_ = rtc::make_ref_counted<NativeFrameCryptorObserver>(
-      std::move(observer), this);
+      std::move(observer), this, worker_);
+  worker_->set_observer(observer_);
   e2ee_transformer_->RegisterFrameCryptorTransformerObserver(observer_);
 }
 
 void FrameCryptor::unregister_observer() const {
   webrtc::MutexLock lock(&mutex_);
   observer_ = nullptr;
+  worker_->set_observer(nullptr);
   e2ee_transformer_->UnRegisterFrameCryptorTransformerObserver();
 }
 
 NativeFrameCryptorObserver::NativeFrameCryptorObserver(
     rust::Box<RtcFrameCryptorObserverWrapper> observer,
-    const FrameCryptor* fc)
-    : observer_(std::move(observer)), fc_(fc) {}
+    const FrameCryptor* fc,
+    rtc::scoped_refptr<CryptoWorkerTransformer> worker)
+    : observer_(std::move(observer)),
+      fc_(fc),
+      participant_id_(fc->participant_id()),
+      worker_(std::move(worker)) {}
 
 NativeFrameCryptorObserver::~NativeFrameCryptorObserver() {}
 
 void NativeFrameCryptorObserver::OnFrameCryptionStateChanged(
     const std::string participant_id,
     webrtc::FrameCryptionState state) {
-  observer_->on_frame_cryption_state_change(
-      participant_id, static_cast<FrameCryptionState>(state));
+  if (worker_->OnTransformerStateChanged(
+          static_cast<FrameCryptionState>(state))) {
+    observer_->on_frame_cryption_state_change(
+        participant_id, static_cast<FrameCryptionState>(state));
+  }
+}
+
+void NativeFrameCryptorObserver::Notify(FrameCryptionState state) {
+  observer_->on_frame_cryption_state_change(participant_id_, state);
 }
 
 void FrameCryptor::set_enabled(bool enabled) const {
@@ -154,6 +700,230 @@ int32_t FrameCryptor::key_index() const {
   return e2ee_transformer_->key_index();
 }
 
+FrameCryptorStats FrameCryptor::stats() const {
+  return worker_->stats();
+}
+
+void FrameCryptor::reset_stats() const {
+  worker_->reset_stats();
+}
+
+AeadContextCache::AeadContextCache(std::shared_ptr<KeyProvider> key_provider)
+    : key_provider_(std::move(key_provider)) {}
+
+AeadContextCache::~AeadContextCache() = default;
+
+std::shared_ptr<const AeadContext> AeadContextCache::Get(
+    const std::string& participant_id,
+    int32_t key_index) const {
+  rtc::scoped_refptr<webrtc::ParticipantKeyHandler> handler =
+      key_provider_->key_handler(participant_id);
+  if (!handler) {
+    return nullptr;
+  }
+  rtc::scoped_refptr<webrtc::ParticipantKeyHandler::KeySet> key_set =
+      handler->GetKeySet(key_index);
+  if (!key_set || key_set->encryption_key.empty()) {
+    return nullptr;
+  }
+
+  std::pair<std::string, int32_t> id(participant_id, key_index);
+  webrtc::MutexLock lock(&mutex_);
+  auto it = contexts_.find(id);
+  if (it != contexts_.end() && it->second->key == key_set->encryption_key) {
+    return it->second;
+  }
+
+  const EVP_AEAD* aead = nullptr;
+  switch (key_set->encryption_key.size()) {
+    case 16:
+      aead = EVP_aead_aes_128_gcm();
+      break;
+    case 32:
+      aead = EVP_aead_aes_256_gcm();
+      break;
+    default:
+      return nullptr;
+  }
+
+  auto context = std::make_shared<AeadContext>();
+  context->key = key_set->encryption_key;
+  if (!EVP_AEAD_CTX_init(context->aead.get(), aead, context->key.data(),
+                         context->key.size(), kDataPacketTagSize, nullptr)) {
+    return nullptr;
+  }
+  contexts_[id] = context;
+  return context;
+}
+
+DataPacketCryptor::DataPacketCryptor(std::shared_ptr<KeyProvider> key_provider)
+    : contexts_(std::move(key_provider)) {}
+
+DataPacketCryptor::~DataPacketCryptor() = default;
+
+void DataPacketCryptor::encrypt(rust::Str participant_id,
+                                int32_t key_index,
+                                rust::Slice<uint8_t> data,
+                                rust::Slice<uint8_t> iv) const {
+  if (data.size() < kDataPacketTagSize || iv.size() != kDataPacketIvSize) {
+    throw std::runtime_error("invalid buffer size");
+  }
+
+  std::shared_ptr<const AeadContext> ctx = contexts_.Get(
+      std::string(participant_id.data(), participant_id.size()), key_index);
+  if (!ctx) {
+    throw std::runtime_error("no key at index");
+  }
+  // A reused IV would break AES-GCM, never seal with an unfilled one
+  if (RAND_bytes(iv.data(), iv.size()) != 1) {
+    throw std::runtime_error("failed to generate the iv");
+  }
+
+  size_t len = data.size() - kDataPacketTagSize;
+  size_t out_len = 0;
+  if (!EVP_AEAD_CTX_seal(ctx->aead.get(), data.data(), &out_len, data.size(),
+                         iv.data(), iv.size(), data.data(), len, nullptr,
+                         0)) {
+    throw std::runtime_error("encryption failed");
+  }
+}
+
+size_t DataPacketCryptor::decrypt(rust::Str participant_id,
+                                  int32_t key_index,
+                                  rust::Slice<const uint8_t> iv,
+                                  rust::Slice<uint8_t> data) const {
+  if (data.size() < kDataPacketTagSize || iv.size() != kDataPacketIvSize) {
+    throw std::runtime_error("invalid buffer size");
+  }
+
+  std::shared_ptr<const AeadContext> ctx = contexts_.Get(
+      std::string(participant_id.data(), participant_id.size()), key_index);
+  if (!ctx) {
+    throw std::runtime_error("no key at index");
+  }
+
+  size_t out_len = 0;
+  if (!EVP_AEAD_CTX_open(ctx->aead.get(), data.data(), &out_len, data.size(),
+                         iv.data(), iv.size(), data.data(), data.size(),
+                         nullptr, 0)) {
+    throw std::runtime_error("decryption failed");
+  }
+  return out_len;
+}
+
+std::shared_ptr<DataPacketCryptor> new_data_packet_cryptor(
+    std::shared_ptr<KeyProvider> key_provider) {
+  return std::make_shared<DataPacketCryptor>(std::move(key_provider));
+}
+
+GcmFrameCipher::GcmFrameCipher(std::shared_ptr<KeyProvider> key_provider,
+                               std::string participant_id,
+                               bool is_video)
+    : participant_id_(std::move(participant_id)),
+      is_video_(is_video),
+      contexts_(std::move(key_provider)) {}
+
+int GcmFrameCipher::ClearHeaderSize(
+    webrtc::TransformableFrameInterface& frame) const {
+  if (!is_video_) {
+    return 1;  // Opus TOC
+  }
+
+  auto& video_frame =
+      static_cast<webrtc::TransformableVideoFrameInterface&>(frame);
+  switch (video_frame.Metadata().GetCodec()) {
+    case webrtc::kVideoCodecVP8:
+      // Frame tag, and the start code and size of keyframes
+      return video_frame.IsKeyFrame() ? 10 : 3;
+    case webrtc::kVideoCodecVP9:
+    case webrtc::kVideoCodecAV1:
+      return 0;
+    default:
+      return -1;
+  }
+}
+
+std::shared_ptr<const AeadContext> GcmFrameCipher::EncryptionContext(
+    int key_index) const {
+  return contexts_.Get(participant_id_, key_index);
+}
+
+bool GcmFrameCipher::Encrypt(webrtc::TransformableFrameInterface& frame,
+                             const AeadContext& ctx,
+                             int key_index) const {
+  rtc::ArrayView<const uint8_t> data = frame.GetData();
+  int header = ClearHeaderSize(frame);
+  if (header < 0 || data.size() <= static_cast<size_t>(header) ||
+      key_index < 0 || key_index > 255) {
+    return false;
+  }
+
+  // header | ciphertext | tag | IV | IV size | key index
+  size_t payload = data.size() - header;
+  rtc::Buffer out(data.size() + kFrameTagSize + kFrameIvSize +
+                  kFrameTrailerSize);
+  std::copy(data.begin(), data.begin() + header, out.begin());
+  uint8_t* iv = out.data() + header + payload + kFrameTagSize;
+  if (RAND_bytes(iv, kFrameIvSize) != 1) {
+    return false;
+  }
+
+  size_t sealed = 0;
+  if (!EVP_AEAD_CTX_seal(ctx.aead.get(), out.data() + header, &sealed,
+                         payload + kFrameTagSize, iv, kFrameIvSize,
+                         data.data() + header, payload, data.data(),
+                         header)) {
+    return false;
+  }
+  iv[kFrameIvSize] = kFrameIvSize;
+  iv[kFrameIvSize + 1] = static_cast<uint8_t>(key_index);
+
+  frame.SetData(out);
+  return true;
+}
+
+bool GcmFrameCipher::Decrypt(webrtc::TransformableFrameInterface& frame) const {
+  rtc::ArrayView<const uint8_t> data = frame.GetData();
+  int header = ClearHeaderSize(frame);
+  if (header < 0 || data.size() < header + kFrameTagSize + kFrameIvSize +
+                                       kFrameTrailerSize) {
+    return false;
+  }
+
+  const uint8_t* trailer = data.data() + data.size() - kFrameTrailerSize;
+  if (trailer[0] != kFrameIvSize) {
+    return false;  // SIF trailer or another cipher
+  }
+  std::shared_ptr<const AeadContext> ctx =
+      contexts_.Get(participant_id_, trailer[1]);
+  if (!ctx) {
+    return false;
+  }
+
+  // Opened in place, the IV and the trailer are read from the frame
+  const uint8_t* iv = trailer - kFrameIvSize;
+  rtc::Buffer out(data.data(), iv - data.data());
+  size_t sealed = out.size() - header;
+  size_t opened = 0;
+  if (!EVP_AEAD_CTX_open(ctx->aead.get(), out.data() + header, &opened,
+                         sealed, iv, kFrameIvSize, out.data() + header, sealed,
+                         out.data(), header)) {
+    return false;
+  }
+  out.SetSize(header + opened);
+
+  frame.SetData(out);
+  return true;
+}
+
+void GcmFrameCipher::MarkValidKey() const {
+  rtc::scoped_refptr<webrtc::ParticipantKeyHandler> handler =
+      contexts_.key_provider().key_handler(participant_id_);
+  if (handler) {
+    handler->SetHasValidKey();
+  }
+}
+
 std::shared_ptr<KeyProvider> new_key_provider(KeyProviderOptions options) {
   return std::make_shared<KeyProvider>(options);
 }
@@ -167,8 +937,8 @@ std::shared_ptr<FrameCryptor> new_frame_cryptor_for_rtp_sender(
   return std::make_shared<FrameCryptor>(
       peer_factory->rtc_runtime(),
       std::string(participant_id.data(), participant_id.size()),
-      AlgorithmToFrameCryptorAlgorithm(algorithm),
-      key_provider->rtc_key_provider(), sender->rtc_sender());
+      AlgorithmToFrameCryptorAlgorithm(algorithm), std::move(key_provider),
+      sender->rtc_sender());
 }
 
 std::shared_ptr<FrameCryptor> new_frame_cryptor_for_rtp_receiver(
@@ -180,8 +950,8 @@ std::shared_ptr<FrameCryptor> new_frame_cryptor_for_rtp_receiver(
   return std::make_shared<FrameCryptor>(
       peer_factory->rtc_runtime(),
       std::string(participant_id.data(), participant_id.size()),
-      AlgorithmToFrameCryptorAlgorithm(algorithm),
-      key_provider->rtc_key_provider(), receiver->rtc_receiver());
+      AlgorithmToFrameCryptorAlgorithm(algorithm), std::move(key_provider),
+      receiver->rtc_receiver());
 }
 
 }  // namespace livekit
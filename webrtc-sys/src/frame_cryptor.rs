@@ -46,6 +46,23 @@ pub mod ffi {
         InternalError,
     }
 
+    #[derive(Debug)]
+    pub struct FrameCryptorStats {
+        pub frames: u64,
+        pub bytes: u64,
+        pub frames_out: u64,
+        pub bytes_out: u64,
+        pub cpu_time_us: u64,
+        pub queue_depth: u32,
+        pub max_queue_depth: u32,
+        pub latency_us: HistogramSnapshot,
+        pub encryption_failures: u32,
+        pub decryption_failures: u32,
+        pub missing_keys: u32,
+        pub internal_errors: u32,
+        pub key_ratchets: u32,
+    }
+
     unsafe extern "C++" {
         include!("livekit/frame_cryptor.h");
 
@@ -79,6 +96,28 @@ pub mod ffi {
             participant_id: String,
             key_index: i32,
         ) -> Result<Vec<u8>>;
+
+        pub type DataPacketCryptor;
+
+        pub fn new_data_packet_cryptor(
+            key_provider: SharedPtr<KeyProvider>,
+        ) -> SharedPtr<DataPacketCryptor>;
+
+        pub fn encrypt(
+            self: &DataPacketCryptor,
+            participant_id: &str,
+            key_index: i32,
+            data: &mut [u8],
+            iv: &mut [u8],
+        ) -> Result<()>;
+
+        pub fn decrypt(
+            self: &DataPacketCryptor,
+            participant_id: &str,
+            key_index: i32,
+            iv: &[u8],
+            data: &mut [u8],
+        ) -> Result<usize>;
     }
 
     unsafe extern "C++" {
@@ -86,7 +125,9 @@ pub mod ffi {
         include!("livekit/rtp_sender.h");
         include!("livekit/rtp_receiver.h");
         include!("livekit/peer_connection_factory.h");
+        include!("livekit/codec_stats.h");
 
+        type HistogramSnapshot = crate::codec_stats::ffi::HistogramSnapshot;
         type RtpSender = crate::rtp_sender::ffi::RtpSender;
         type RtpReceiver = crate::rtp_receiver::ffi::RtpReceiver;
         type PeerConnectionFactory = crate::peer_connection_factory::ffi::PeerConnectionFactory;
@@ -125,6 +166,10 @@ pub mod ffi {
         );
 
         pub fn unregister_observer(self: &FrameCryptor);
+
+        pub fn stats(self: &FrameCryptor) -> FrameCryptorStats;
+
+        pub fn reset_stats(self: &FrameCryptor);
     }
 
     extern "Rust" {
@@ -140,6 +185,7 @@ pub mod ffi {
 
 impl_thread_safety!(ffi::FrameCryptor, Send + Sync);
 impl_thread_safety!(ffi::KeyProvider, Send + Sync);
+impl_thread_safety!(ffi::DataPacketCryptor, Send + Sync);
 
 use ffi::FrameCryptionState;
 
@@ -0,0 +1,247 @@
+/*
+ * Copyright 2023 LiveKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the “License”);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an “AS IS” BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "livekit/instrumented_video_codec.h"
+
+#include "modules/video_coding/include/video_error_codes.h"
+#include "rtc_base/time_utils.h"
+
+namespace livekit {
+
+void FrameStartTimes::Write(Slot& slot, const Entry& entry) {
+  uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+  slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.rtp_timestamp.store(entry.rtp_timestamp, std::memory_order_relaxed);
+  slot.start_us.store(entry.start_us, std::memory_order_relaxed);
+  slot.size_bytes.store(entry.size_bytes, std::memory_order_relaxed);
+  slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void FrameStartTimes::Push(uint32_t rtp_timestamp, size_t size_bytes) {
+  Write(slots_[next_], {rtp_timestamp, rtc::TimeMicros(), size_bytes});
+  next_ = (next_ + 1) % kSize;
+}
+
+absl::optional<FrameStartTimes::Entry> FrameStartTimes::Find(
+    uint32_t rtp_timestamp) const {
+  for (const Slot& slot : slots_) {
+    uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence & 1) {
+      continue;  // being overwritten, too old to be the frame looked for
+    }
+
+    Entry entry;
+    entry.rtp_timestamp = slot.rtp_timestamp.load(std::memory_order_relaxed);
+    entry.start_us = slot.start_us.load(std::memory_order_relaxed);
+    entry.size_bytes = static_cast<size_t>(
+        slot.size_bytes.load(std::memory_order_relaxed));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+      continue;
+    }
+
+    if (entry.start_us >= 0 && entry.rtp_timestamp == rtp_timestamp) {
+      return entry;
+    }
+  }
+  return absl::nullopt;
+}
+
+void FrameStartTimes::Clear() {
+  for (Slot& slot : slots_) {
+    Write(slot, Entry{});
+  }
+  next_ = 0;
+}
+
+InstrumentedVideoEncoder::InstrumentedVideoEncoder(
+    std::unique_ptr<webrtc::VideoEncoder> encoder)
+    : encoder_(std::move(encoder)) {}
+
+void InstrumentedVideoEncoder::SetFecControllerOverride(
+    webrtc::FecControllerOverride* fec_controller_override) {
+  encoder_->SetFecControllerOverride(fec_controller_override);
+}
+
+void InstrumentedVideoEncoder::SetStats(std::shared_ptr<CodecStats> stats) {
+  if (stats && !stats_owner_) {
+    stats_owner_ = std::move(stats);
+    stats_.store(stats_owner_.get(), std::memory_order_release);
+  }
+}
+
+int InstrumentedVideoEncoder::InitEncode(
+    const webrtc::VideoCodec* codec_settings,
+    const webrtc::VideoEncoder::Settings& settings) {
+  start_times_.Clear();
+  return encoder_->InitEncode(codec_settings, settings);
+}
+
+int32_t InstrumentedVideoEncoder::RegisterEncodeCompleteCallback(
+    webrtc::EncodedImageCallback* callback) {
+  callback_ = callback;
+  return encoder_->RegisterEncodeCompleteCallback(callback ? this : nullptr);
+}
+
+int32_t InstrumentedVideoEncoder::Release() {
+  return encoder_->Release();
+}
+
+int32_t InstrumentedVideoEncoder::Encode(
+    const webrtc::VideoFrame& frame,
+    const std::vector<webrtc::VideoFrameType>* frame_types) {
+  CodecStats* stats = stats_.load(std::memory_order_relaxed);
+  if (stats) {
+    start_times_.Push(frame.timestamp(), 0);
+  }
+
+  int32_t result = encoder_->Encode(frame, frame_types);
+  if (stats && result < WEBRTC_VIDEO_CODEC_OK) {
+    stats->RecordError();
+  }
+  return result;
+}
+
+webrtc::EncodedImageCallback::Result InstrumentedVideoEncoder::OnEncodedImage(
+    const webrtc::EncodedImage& encoded_image,
+    const webrtc::CodecSpecificInfo* codec_specific_info) {
+  if (CodecStats* stats = stats_.load(std::memory_order_acquire)) {
+    // Simulcast layers share the timestamp, each one is a sample
+    if (auto start = start_times_.Find(encoded_image.RtpTimestamp())) {
+      stats->RecordFrame(rtc::TimeMicros() - start->start_us,
+                         encoded_image.qp_, encoded_image.size());
+    }
+  }
+  return callback_->OnEncodedImage(encoded_image, codec_specific_info);
+}
+
+void InstrumentedVideoEncoder::OnDroppedFrame(DropReason reason) {
+  if (CodecStats* stats = stats_.load(std::memory_order_acquire)) {
+    stats->RecordDropped();
+  }
+  callback_->OnDroppedFrame(reason);
+}
+
+void InstrumentedVideoEncoder::SetRates(
+    const RateControlParameters& parameters) {
+  encoder_->SetRates(parameters);
+}
+
+void InstrumentedVideoEncoder::OnPacketLossRateUpdate(float packet_loss_rate) {
+  encoder_->OnPacketLossRateUpdate(packet_loss_rate);
+}
+
+void InstrumentedVideoEncoder::OnRttUpdate(int64_t rtt_ms) {
+  encoder_->OnRttUpdate(rtt_ms);
+}
+
+void InstrumentedVideoEncoder::OnLossNotification(
+    const LossNotification& loss_notification) {
+  encoder_->OnLossNotification(loss_notification);
+}
+
+webrtc::VideoEncoder::EncoderInfo InstrumentedVideoEncoder::GetEncoderInfo()
+    const {
+  return encoder_->GetEncoderInfo();
+}
+
+InstrumentedVideoDecoder::InstrumentedVideoDecoder(
+    std::unique_ptr<webrtc::VideoDecoder> decoder)
+    : decoder_(std::move(decoder)) {}
+
+bool InstrumentedVideoDecoder::Configure(const Settings& settings) {
+  start_times_.Clear();
+  return decoder_->Configure(settings);
+}
+
+int32_t InstrumentedVideoDecoder::Decode(const webrtc::EncodedImage& input_image,
+                                         bool missing_frames,
+                                         int64_t render_time_ms) {
+  if (input_image.size() == 0) {
+    // Stripped by an EncodedFrameTap, nothing gets decoded
+    return decoder_->Decode(input_image, missing_frames, render_time_ms);
+  }
+
+  const webrtc::RtpPacketInfos& packets = input_image.PacketInfos();
+  if (!stats_owner_ && !packets.empty()) {
+    stats_owner_ = SharedDecoderStats(packets[0].ssrc());
+    stats_.store(stats_owner_.get(), std::memory_order_release);
+  }
+
+  CodecStats* stats = stats_.load(std::memory_order_relaxed);
+  if (stats) {
+    start_times_.Push(input_image.RtpTimestamp(), input_image.size());
+  }
+
+  int32_t result =
+      decoder_->Decode(input_image, missing_frames, render_time_ms);
+  if (stats && result < WEBRTC_VIDEO_CODEC_OK) {
+    stats->RecordError();
+  }
+  return result;
+}
+
+int32_t InstrumentedVideoDecoder::RegisterDecodeCompleteCallback(
+    webrtc::DecodedImageCallback* callback) {
+  callback_ = callback;
+  return decoder_->RegisterDecodeCompleteCallback(callback ? this : nullptr);
+}
+
+int32_t InstrumentedVideoDecoder::Release() {
+  return decoder_->Release();
+}
+
+webrtc::VideoDecoder::DecoderInfo InstrumentedVideoDecoder::GetDecoderInfo()
+    const {
+  return decoder_->GetDecoderInfo();
+}
+
+const char* InstrumentedVideoDecoder::ImplementationName() const {
+  return decoder_->ImplementationName();
+}
+
+int32_t InstrumentedVideoDecoder::Decoded(webrtc::VideoFrame& decoded_image) {
+  Record(decoded_image, absl::nullopt);
+  return callback_->Decoded(decoded_image);
+}
+
+int32_t InstrumentedVideoDecoder::Decoded(webrtc::VideoFrame& decoded_image,
+                                          int64_t decode_time_ms) {
+  Record(decoded_image, absl::nullopt);
+  return callback_->Decoded(decoded_image, decode_time_ms);
+}
+
+void InstrumentedVideoDecoder::Decoded(webrtc::VideoFrame& decoded_image,
+                                       absl::optional<int32_t> decode_time_ms,
+                                       absl::optional<uint8_t> qp) {
+  Record(decoded_image, qp);
+  callback_->Decoded(decoded_image, decode_time_ms, qp);
+}
+
+void InstrumentedVideoDecoder::Record(const webrtc::VideoFrame& decoded_image,
+                                      absl::optional<uint8_t> qp) {
+  CodecStats* stats = stats_.load(std::memory_order_acquire);
+  if (!stats) {
+    return;
+  }
+  if (auto start = start_times_.Find(decoded_image.timestamp())) {
+    stats->RecordFrame(rtc::TimeMicros() - start->start_us,
+                       qp ? static_cast<int>(*qp) : -1, start->size_bytes);
+  }
+}
+
+}  // namespace livekit
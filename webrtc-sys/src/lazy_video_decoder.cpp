@@ -0,0 +1,179 @@
+/*
+ * Copyright 2023 LiveKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the “License”);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an “AS IS” BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "livekit/lazy_video_decoder.h"
+
+#include <algorithm>
+#include <map>
+
+#include "modules/video_coding/include/video_error_codes.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace livekit {
+
+namespace {
+
+struct PreferredOutputEntry {
+  std::weak_ptr<DecoderOutput> output;  // held by the decoders
+  bool adopted = false;
+  // Keeps the preference alive until a decoder adopts it
+  std::shared_ptr<DecoderOutput> pending;
+};
+
+webrtc::Mutex preferred_output_mutex;
+std::map<uint32_t, PreferredOutputEntry> preferred_output
+    RTC_GUARDED_BY(preferred_output_mutex);
+
+// Must be called with preferred_output_mutex held
+std::shared_ptr<DecoderOutput> FindOrCreateOutput(PreferredOutputEntry& entry) {
+  std::shared_ptr<DecoderOutput> output = entry.output.lock();
+  if (!output) {
+    output = std::make_shared<DecoderOutput>(
+        webrtc::VideoFrameBuffer::Type::kNative);
+    entry.output = output;
+    entry.adopted = false;
+  }
+  return output;
+}
+
+}  // namespace
+
+void SetPreferredDecoderOutput(uint32_t ssrc,
+                               webrtc::VideoFrameBuffer::Type type) {
+  webrtc::MutexLock lock(&preferred_output_mutex);
+  PreferredOutputEntry& entry = preferred_output[ssrc];
+  std::shared_ptr<DecoderOutput> output = FindOrCreateOutput(entry);
+  output->store(type, std::memory_order_relaxed);
+  if (!entry.adopted) {
+    // No decoder yet, wait for the first one unless it's the default
+    entry.pending =
+        type != webrtc::VideoFrameBuffer::Type::kNative ? output : nullptr;
+  }
+}
+
+std::shared_ptr<DecoderOutput> AdoptPreferredDecoderOutput(uint32_t ssrc) {
+  webrtc::MutexLock lock(&preferred_output_mutex);
+  // The streams released since the last adoption left expired entries
+  for (auto it = preferred_output.begin(); it != preferred_output.end();) {
+    bool released = it->first != ssrc && !it->second.pending &&
+                    it->second.output.expired();
+    it = released ? preferred_output.erase(it) : std::next(it);
+  }
+
+  PreferredOutputEntry& entry = preferred_output[ssrc];
+  std::shared_ptr<DecoderOutput> output = FindOrCreateOutput(entry);
+  entry.adopted = true;
+  entry.pending = nullptr;
+  return output;
+}
+
+LazyVideoDecoder::LazyVideoDecoder(Factory factory, int max_threads)
+    : factory_(std::move(factory)), max_threads_(max_threads) {}
+
+bool LazyVideoDecoder::Configure(const Settings& settings) {
+  settings_ = settings;
+  if (max_threads_ > 0) {
+    settings_->set_number_of_cores(
+        std::min(settings_->number_of_cores(), max_threads_));
+  }
+  if (decoder_) {
+    return decoder_->Configure(*settings_);
+  }
+  return true;
+}
+
+int32_t LazyVideoDecoder::Decode(const webrtc::EncodedImage& input_image,
+                                 bool missing_frames,
+                                 int64_t render_time_ms) {
+  if (input_image.size() == 0) {
+    // Decoding suppressed. NO_OUTPUT has the VCMDecodedFrameCallback drop
+    // the timestamp of the frame instead of counting it as a dropped frame
+    return WEBRTC_VIDEO_CODEC_NO_OUTPUT;
+  }
+
+  const bool keyframe =
+      input_image._frameType == webrtc::VideoFrameType::kVideoFrameKey;
+  webrtc::VideoFrameBuffer::Type output = output_;
+  if (keyframe && !preferred_output_ && !input_image.PacketInfos().empty()) {
+    preferred_output_ =
+        AdoptPreferredDecoderOutput(input_image.PacketInfos()[0].ssrc());
+  }
+  if (keyframe && preferred_output_) {
+    output = preferred_output_->load(std::memory_order_relaxed);
+  }
+
+  if (decoder_ && output != output_) {
+    decoder_->Release();
+    decoder_ = nullptr;
+  }
+
+  if (!decoder_) {
+    if (!keyframe) {
+      return WEBRTC_VIDEO_CODEC_OK_REQUEST_KEYFRAME;
+    }
+
+    output_ = output;
+    decoder_ = factory_(output);
+    if (!decoder_ || (settings_ && !decoder_->Configure(*settings_))) {
+      RTC_LOG(LS_ERROR) << "Failed to create the video decoder";
+      decoder_ = nullptr;
+      return WEBRTC_VIDEO_CODEC_ERROR;
+    }
+
+    if (callback_) {
+      decoder_->RegisterDecodeCompleteCallback(callback_);
+    }
+  }
+
+  return decoder_->Decode(input_image, missing_frames, render_time_ms);
+}
+
+int32_t LazyVideoDecoder::RegisterDecodeCompleteCallback(
+    webrtc::DecodedImageCallback* callback) {
+  callback_ = callback;
+  if (decoder_) {
+    return decoder_->RegisterDecodeCompleteCallback(callback);
+  }
+  return WEBRTC_VIDEO_CODEC_OK;
+}
+
+int32_t LazyVideoDecoder::Release() {
+  if (!decoder_) {
+    return WEBRTC_VIDEO_CODEC_OK;
+  }
+
+  int32_t ret = decoder_->Release();
+  decoder_ = nullptr;
+  return ret;
+}
+
+webrtc::VideoDecoder::DecoderInfo LazyVideoDecoder::GetDecoderInfo() const {
+  if (decoder_) {
+    return decoder_->GetDecoderInfo();
+  }
+
+  DecoderInfo info;
+  info.implementation_name = "lazy (not created)";
+  return info;
+}
+
+const char* LazyVideoDecoder::ImplementationName() const {
+  return decoder_ ? decoder_->ImplementationName() : "lazy (not created)";
+}
+
+}  // namespace livekit
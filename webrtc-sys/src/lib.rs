@@ -18,7 +18,9 @@ pub mod apm;
 pub mod audio_resampler;
 pub mod audio_track;
 pub mod candidate;
+pub mod codec_stats;
 pub mod data_channel;
+pub mod encoded_frame_sink;
 pub mod frame_cryptor;
 pub mod helper;
 pub mod jsep;
@@ -0,0 +1,315 @@
+/*
+ * Copyright 2023 LiveKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the “License”);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an “AS IS” BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "livekit/passthrough_audio_encoder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+
+namespace livekit {
+
+namespace {
+
+// Marker layout (int16 samples, the rest of the block is silent):
+// [0..3] magic, [4..5] channel id, [6] packet sequence, [7] block index,
+// [8] block count (0 = no packet)
+constexpr int16_t kMagic[] = {0x4c4b, 0x4f50, 0x5553, 0x5054};
+constexpr size_t kIdOffset = 4;
+constexpr size_t kSequenceOffset = 6;
+constexpr size_t kIndexOffset = 7;
+constexpr size_t kCountOffset = 8;
+
+// Packets whose markers never reach an encoder (track not published, markers
+// muted) are dropped past this
+constexpr size_t kMaxQueuedPackets = 512;
+
+void WriteMarker(const EncodedAudioMarker& marker, std::vector<int16_t>& out) {
+  size_t begin = out.size();
+  out.resize(begin + kEncodedAudioBlockSamples, 0);
+  int16_t* block = out.data() + begin;
+
+  std::copy(std::begin(kMagic), std::end(kMagic), block);
+  block[kIdOffset] = static_cast<int16_t>(marker.channel_id >> 16);
+  block[kIdOffset + 1] = static_cast<int16_t>(marker.channel_id & 0xffff);
+  block[kSequenceOffset] = static_cast<int16_t>(marker.sequence);
+  block[kIndexOffset] = static_cast<int16_t>(marker.index);
+  block[kCountOffset] = static_cast<int16_t>(marker.count);
+}
+
+webrtc::Mutex channels_mutex;
+std::map<uint32_t, std::weak_ptr<EncodedAudioChannel>> channels
+    RTC_GUARDED_BY(channels_mutex);
+uint32_t next_channel_id RTC_GUARDED_BY(channels_mutex) = 1;
+
+}  // namespace
+
+absl::optional<EncodedAudioMarker> ReadEncodedAudioMarker(
+    rtc::ArrayView<const int16_t> audio,
+    size_t num_channels) {
+  if (num_channels == 0 ||
+      audio.size() != kEncodedAudioBlockSamples * num_channels) {
+    return absl::nullopt;
+  }
+
+  for (size_t i = 0; i < std::size(kMagic); ++i) {
+    if (audio[i * num_channels] != kMagic[i]) {
+      return absl::nullopt;
+    }
+  }
+
+  auto sample = [&](size_t offset) {
+    return static_cast<uint16_t>(audio[offset * num_channels]);
+  };
+
+  EncodedAudioMarker marker;
+  marker.channel_id = static_cast<uint32_t>(sample(kIdOffset)) << 16 |
+                      sample(kIdOffset + 1);
+  marker.sequence = sample(kSequenceOffset);
+  marker.index = sample(kIndexOffset);
+  marker.count = sample(kCountOffset);
+  return marker;
+}
+
+std::shared_ptr<EncodedAudioChannel> EncodedAudioChannel::Create() {
+  webrtc::MutexLock lock(&channels_mutex);
+  for (auto it = channels.begin(); it != channels.end();) {
+    it = it->second.expired() ? channels.erase(it) : std::next(it);
+  }
+
+  uint32_t id = next_channel_id++;
+  if (next_channel_id == 0) {
+    next_channel_id = 1;
+  }
+
+  auto channel = std::make_shared<EncodedAudioChannel>(id);
+  channels[id] = channel;
+  return channel;
+}
+
+std::shared_ptr<EncodedAudioChannel> EncodedAudioChannel::Find(uint32_t id) {
+  webrtc::MutexLock lock(&channels_mutex);
+  auto it = channels.find(id);
+  return it != channels.end() ? it->second.lock() : nullptr;
+}
+
+EncodedAudioChannel::EncodedAudioChannel(uint32_t id) : id_(id) {}
+
+bool EncodedAudioChannel::Push(rtc::ArrayView<const uint8_t> packet,
+                               int duration_ms,
+                               std::vector<int16_t>& markers) {
+  if (duration_ms < 10 || duration_ms % 10 != 0 || duration_ms > 120 ||
+      packet.empty()) {
+    return false;
+  }
+
+  webrtc::MutexLock lock(&mutex_);
+  if (packets_.size() >= kMaxQueuedPackets) {
+    packets_.pop_front();
+  }
+
+  EncodedAudioMarker marker;
+  marker.channel_id = id_;
+  marker.sequence = next_sequence_++;
+  marker.count = static_cast<uint16_t>(duration_ms / 10);
+  packets_.push_back(Packet{marker.sequence, rtc::Buffer(packet)});
+
+  for (marker.index = 0; marker.index < marker.count; ++marker.index) {
+    WriteMarker(marker, markers);
+  }
+  return true;
+}
+
+void EncodedAudioChannel::AppendEmptyMarker(
+    std::vector<int16_t>& markers) const {
+  EncodedAudioMarker marker;
+  marker.channel_id = id_;
+  WriteMarker(marker, markers);
+}
+
+rtc::Buffer EncodedAudioChannel::Take(uint16_t sequence) {
+  webrtc::MutexLock lock(&mutex_);
+  while (!packets_.empty()) {
+    int16_t age = static_cast<int16_t>(sequence - packets_.front().sequence);
+    if (age < 0) {
+      break;  // newer than the marker, it was dropped already
+    }
+
+    rtc::Buffer data = std::move(packets_.front().data);
+    packets_.pop_front();
+    if (age == 0) {
+      return data;
+    }
+  }
+  return rtc::Buffer();
+}
+
+void EncodedAudioChannel::Clear() {
+  webrtc::MutexLock lock(&mutex_);
+  packets_.clear();
+}
+
+PassthroughAudioEncoder::PassthroughAudioEncoder(
+    int payload_type,
+    std::unique_ptr<webrtc::AudioEncoder> encoder)
+    : payload_type_(payload_type), encoder_(std::move(encoder)) {}
+
+int PassthroughAudioEncoder::SampleRateHz() const {
+  return encoder_->SampleRateHz();
+}
+
+size_t PassthroughAudioEncoder::NumChannels() const {
+  return encoder_->NumChannels();
+}
+
+int PassthroughAudioEncoder::RtpTimestampRateHz() const {
+  return encoder_->RtpTimestampRateHz();
+}
+
+size_t PassthroughAudioEncoder::Num10MsFramesInNextPacket() const {
+  return passthrough_ && packet_blocks_ ? packet_blocks_
+                                        : encoder_->Num10MsFramesInNextPacket();
+}
+
+size_t PassthroughAudioEncoder::Max10MsFramesInAPacket() const {
+  return std::max<size_t>(encoder_->Max10MsFramesInAPacket(), 12);
+}
+
+int PassthroughAudioEncoder::GetTargetBitrate() const {
+  return encoder_->GetTargetBitrate();
+}
+
+void PassthroughAudioEncoder::Reset() {
+  packet_.Clear();
+  packet_blocks_ = 0;
+  encoder_->Reset();
+}
+
+bool PassthroughAudioEncoder::SetFec(bool enable) {
+  return encoder_->SetFec(enable);
+}
+
+bool PassthroughAudioEncoder::SetDtx(bool enable) {
+  return encoder_->SetDtx(enable);
+}
+
+bool PassthroughAudioEncoder::GetDtx() const {
+  return encoder_->GetDtx();
+}
+
+bool PassthroughAudioEncoder::SetApplication(Application application) {
+  return encoder_->SetApplication(application);
+}
+
+void PassthroughAudioEncoder::SetMaxPlaybackRate(int frequency_hz) {
+  encoder_->SetMaxPlaybackRate(frequency_hz);
+}
+
+void PassthroughAudioEncoder::OnReceivedUplinkPacketLossFraction(
+    float uplink_packet_loss_fraction) {
+  encoder_->OnReceivedUplinkPacketLossFraction(uplink_packet_loss_fraction);
+}
+
+void PassthroughAudioEncoder::OnReceivedUplinkBandwidth(
+    int target_audio_bitrate_bps,
+    absl::optional<int64_t> bwe_period_ms) {
+  encoder_->OnReceivedUplinkBandwidth(target_audio_bitrate_bps, bwe_period_ms);
+}
+
+void PassthroughAudioEncoder::OnReceivedUplinkAllocation(
+    webrtc::BitrateAllocationUpdate update) {
+  encoder_->OnReceivedUplinkAllocation(update);
+}
+
+void PassthroughAudioEncoder::OnReceivedRtt(int rtt_ms) {
+  encoder_->OnReceivedRtt(rtt_ms);
+}
+
+void PassthroughAudioEncoder::OnReceivedOverhead(
+    size_t overhead_bytes_per_packet) {
+  encoder_->OnReceivedOverhead(overhead_bytes_per_packet);
+}
+
+absl::optional<std::pair<webrtc::TimeDelta, webrtc::TimeDelta>>
+PassthroughAudioEncoder::GetFrameLengthRange() const {
+  return encoder_->GetFrameLengthRange();
+}
+
+webrtc::AudioEncoder::EncodedInfo PassthroughAudioEncoder::EncodeImpl(
+    uint32_t rtp_timestamp,
+    rtc::ArrayView<const int16_t> audio,
+    rtc::Buffer* encoded) {
+  absl::optional<EncodedAudioMarker> marker =
+      ReadEncodedAudioMarker(audio, NumChannels());
+  if (!marker) {
+    if (passthrough_) {
+      // Back to PCM
+      passthrough_ = false;
+      packet_.Clear();
+      packet_blocks_ = 0;
+    }
+    return encoder_->Encode(rtp_timestamp, audio, encoded);
+  }
+
+  if (!passthrough_) {
+    // Drop what the wrapped encoder buffered, it would be sent with a stale
+    // timestamp when switching back to PCM
+    passthrough_ = true;
+    encoder_->Reset();
+  }
+
+  EncodedInfo info;
+  if (marker->count == 0) {
+    return info;  // DTX, the upstream encoder didn't send anything
+  }
+
+  if (marker->index == 0) {
+    if (!channel_ || channel_->id() != marker->channel_id) {
+      channel_ = EncodedAudioChannel::Find(marker->channel_id);
+    }
+
+    packet_ = channel_ ? channel_->Take(marker->sequence) : rtc::Buffer();
+    packet_blocks_ = packet_.empty() ? 0 : marker->count;
+    sequence_ = marker->sequence;
+    first_timestamp_ = rtp_timestamp;
+  } else if (packet_blocks_ != marker->count ||
+             marker->index != next_block_ || marker->sequence != sequence_) {
+    // A marker got lost (source queue cleared, track muted), skip the packet
+    packet_.Clear();
+    packet_blocks_ = 0;
+    return info;
+  }
+  next_block_ = marker->index + 1;
+
+  if (packet_blocks_ == 0 || next_block_ < packet_blocks_) {
+    return info;  // same as the Opus encoder, wait for the whole packet
+  }
+
+  encoded->AppendData(packet_);
+  info.encoded_bytes = packet_.size();
+  info.encoded_timestamp = first_timestamp_;
+  info.payload_type = payload_type_;
+  info.encoder_type = CodecType::kOpus;
+  info.send_even_if_empty = true;  // same as AudioEncoderOpus
+  info.speech = packet_.size() > 2;
+
+  packet_.Clear();
+  packet_blocks_ = 0;
+  return info;
+}
+
+}  // namespace livekit
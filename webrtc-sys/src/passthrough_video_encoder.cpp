@@ -0,0 +1,280 @@
+/*
+ * Copyright 2023 LiveKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the “License”);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an “AS IS” BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "livekit/passthrough_video_encoder.h"
+
+#include <algorithm>
+
+#include "api/video/i420_buffer.h"
+#include "api/video/video_frame.h"
+#include "api/video_codecs/video_codec.h"
+#include "modules/video_coding/codecs/interface/common_constants.h"
+#include "modules/video_coding/include/video_codec_interface.h"
+#include "modules/video_coding/include/video_error_codes.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/time_utils.h"
+
+namespace livekit {
+
+namespace {
+
+// Keyframe requests are forwarded again if no keyframe came after this delay
+constexpr int64_t kKeyFrameRequestIntervalMs = 1000;
+
+}  // namespace
+
+EncodedFrameBuffer::EncodedFrameBuffer(
+    rtc::scoped_refptr<webrtc::EncodedImageBuffer> data,
+    webrtc::VideoCodecType codec,
+    bool is_keyframe,
+    int width,
+    int height,
+    uint64_t sequence,
+    rtc::scoped_refptr<KeyFrameRequestListener> listener)
+    : data_(std::move(data)),
+      codec_(codec),
+      is_keyframe_(is_keyframe),
+      width_(width),
+      height_(height),
+      sequence_(sequence),
+      listener_(std::move(listener)) {}
+
+webrtc::VideoFrameBuffer::Type EncodedFrameBuffer::type() const {
+  return Type::kNative;
+}
+
+int EncodedFrameBuffer::width() const {
+  return width_;
+}
+
+int EncodedFrameBuffer::height() const {
+  return height_;
+}
+
+rtc::scoped_refptr<webrtc::I420BufferInterface> EncodedFrameBuffer::ToI420() {
+  rtc::scoped_refptr<webrtc::I420Buffer> black =
+      webrtc::I420Buffer::Create(width_, height_);
+  webrtc::I420Buffer::SetBlack(black.get());
+  return black;
+}
+
+rtc::scoped_refptr<webrtc::VideoFrameBuffer> EncodedFrameBuffer::CropAndScale(
+    int offset_x,
+    int offset_y,
+    int crop_width,
+    int crop_height,
+    int scaled_width,
+    int scaled_height) {
+  return rtc::scoped_refptr<webrtc::VideoFrameBuffer>(this);
+}
+
+PassthroughVideoEncoder::PassthroughVideoEncoder(
+    webrtc::VideoCodecType codec_type,
+    std::unique_ptr<webrtc::VideoEncoder> encoder)
+    : codec_type_(codec_type), encoder_(std::move(encoder)) {}
+
+void PassthroughVideoEncoder::SetFecControllerOverride(
+    webrtc::FecControllerOverride* fec_controller_override) {
+  encoder_->SetFecControllerOverride(fec_controller_override);
+}
+
+int PassthroughVideoEncoder::InitEncode(
+    const webrtc::VideoCodec* codec_settings,
+    const webrtc::VideoEncoder::Settings& settings) {
+  waiting_keyframe_ = true;
+  last_sequence_ = 0;
+  return encoder_->InitEncode(codec_settings, settings);
+}
+
+int32_t PassthroughVideoEncoder::RegisterEncodeCompleteCallback(
+    webrtc::EncodedImageCallback* callback) {
+  callback_ = callback;
+  return encoder_->RegisterEncodeCompleteCallback(callback);
+}
+
+int32_t PassthroughVideoEncoder::Release() {
+  return encoder_->Release();
+}
+
+int32_t PassthroughVideoEncoder::Encode(
+    const webrtc::VideoFrame& frame,
+    const std::vector<webrtc::VideoFrameType>* frame_types) {
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer =
+      frame.video_frame_buffer();
+  if (buffer->type() == webrtc::VideoFrameBuffer::Type::kNative) {
+    if (auto encoded = dynamic_cast<const EncodedFrameBuffer*>(buffer.get())) {
+      return EncodePassthrough(frame, *encoded, frame_types);
+    }
+  }
+
+  if (passthrough_.exchange(false)) {
+    // Back to raw frames, the encoder state is older than what the receivers
+    // last decoded
+    waiting_keyframe_ = true;
+    last_sequence_ = 0;
+    std::vector<webrtc::VideoFrameType> key_types(
+        frame_types ? std::max<size_t>(frame_types->size(), 1) : 1,
+        webrtc::VideoFrameType::kVideoFrameKey);
+    return encoder_->Encode(frame, &key_types);
+  }
+
+  if (buffer->type() == webrtc::VideoFrameBuffer::Type::kNative) {
+    // GetEncoderInfo always claims native support, do the conversion the
+    // VideoStreamEncoder would have done for the wrapped encoder
+    EncoderInfo info = encoder_->GetEncoderInfo();
+    if (!info.supports_native_handle) {
+      rtc::scoped_refptr<webrtc::VideoFrameBuffer> mapped =
+          buffer->GetMappedFrameBuffer(info.preferred_pixel_formats);
+      if (!mapped) {
+        mapped = buffer->ToI420();
+      }
+      if (!mapped) {
+        RTC_LOG(LS_ERROR) << "Failed to convert the native frame";
+        return WEBRTC_VIDEO_CODEC_ERROR;
+      }
+      webrtc::VideoFrame converted_frame(frame);
+      converted_frame.set_video_frame_buffer(mapped);
+      return encoder_->Encode(converted_frame, frame_types);
+    }
+  }
+
+  return encoder_->Encode(frame, frame_types);
+}
+
+int32_t PassthroughVideoEncoder::EncodePassthrough(
+    const webrtc::VideoFrame& frame,
+    const EncodedFrameBuffer& buffer,
+    const std::vector<webrtc::VideoFrameType>* frame_types) {
+  if (!callback_) {
+    return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+  }
+
+  if (buffer.codec() != codec_type_ ||
+      (codec_type_ != webrtc::kVideoCodecH264 &&
+       codec_type_ != webrtc::kVideoCodecVP8)) {
+    if (!codec_mismatch_logged_) {
+      RTC_LOG(LS_ERROR) << "Can't forward "
+                        << webrtc::CodecTypeToPayloadString(buffer.codec())
+                        << " frames, the negotiated codec is "
+                        << webrtc::CodecTypeToPayloadString(codec_type_);
+      codec_mismatch_logged_ = true;
+    }
+    return WEBRTC_VIDEO_CODEC_OK;  // dropped
+  }
+
+  passthrough_.store(true);
+
+  // Frames dropped by the VideoStreamEncoder (pacing, bandwidth) break the
+  // reference chain, wait for the next keyframe
+  if (last_sequence_ != 0 && buffer.sequence() != last_sequence_ + 1) {
+    waiting_keyframe_ = true;
+  }
+  last_sequence_ = buffer.sequence();
+
+  bool keyframe_wanted =
+      waiting_keyframe_ ||
+      (frame_types &&
+       std::find(frame_types->begin(), frame_types->end(),
+                 webrtc::VideoFrameType::kVideoFrameKey) != frame_types->end());
+
+  if (buffer.is_keyframe()) {
+    waiting_keyframe_ = false;
+    keyframe_requested_ms_ = -1;
+  } else if (keyframe_wanted && buffer.listener()) {
+    int64_t now_ms = rtc::TimeMillis();
+    if (keyframe_requested_ms_ < 0 ||
+        now_ms - keyframe_requested_ms_ >= kKeyFrameRequestIntervalMs) {
+      keyframe_requested_ms_ = now_ms;
+      buffer.listener()->OnKeyFrameRequested();
+    }
+  }
+
+  if (waiting_keyframe_) {
+    return WEBRTC_VIDEO_CODEC_OK;
+  }
+
+  webrtc::EncodedImage image;
+  image.SetEncodedData(buffer.data());
+  image.SetRtpTimestamp(frame.timestamp());
+  image.capture_time_ms_ = frame.render_time_ms();
+  image._encodedWidth = buffer.width();
+  image._encodedHeight = buffer.height();
+  image._frameType = buffer.is_keyframe()
+                         ? webrtc::VideoFrameType::kVideoFrameKey
+                         : webrtc::VideoFrameType::kVideoFrameDelta;
+  image.rotation_ = frame.rotation();
+
+  webrtc::CodecSpecificInfo info;
+  info.codecType = codec_type_;
+  if (codec_type_ == webrtc::kVideoCodecH264) {
+    info.codecSpecific.H264.packetization_mode =
+        webrtc::H264PacketizationMode::NonInterleaved;
+    info.codecSpecific.H264.temporal_idx = webrtc::kNoTemporalIdx;
+    info.codecSpecific.H264.base_layer_sync = false;
+    info.codecSpecific.H264.idr_frame = buffer.is_keyframe();
+  } else {
+    info.codecSpecific.VP8.nonReference = false;
+    info.codecSpecific.VP8.temporalIdx = webrtc::kNoTemporalIdx;
+    info.codecSpecific.VP8.layerSync = false;
+    info.codecSpecific.VP8.keyIdx = webrtc::kNoKeyIdx;
+  }
+
+  webrtc::EncodedImageCallback::Result result =
+      callback_->OnEncodedImage(image, &info);
+  if (result.error != webrtc::EncodedImageCallback::Result::OK) {
+    return WEBRTC_VIDEO_CODEC_ERROR;
+  }
+  return WEBRTC_VIDEO_CODEC_OK;
+}
+
+void PassthroughVideoEncoder::SetRates(
+    const RateControlParameters& parameters) {
+  encoder_->SetRates(parameters);
+}
+
+void PassthroughVideoEncoder::OnPacketLossRateUpdate(float packet_loss_rate) {
+  encoder_->OnPacketLossRateUpdate(packet_loss_rate);
+}
+
+void PassthroughVideoEncoder::OnRttUpdate(int64_t rtt_ms) {
+  encoder_->OnRttUpdate(rtt_ms);
+}
+
+void PassthroughVideoEncoder::OnLossNotification(
+    const LossNotification& loss_notification) {
+  encoder_->OnLossNotification(loss_notification);
+}
+
+webrtc::VideoEncoder::EncoderInfo PassthroughVideoEncoder::GetEncoderInfo()
+    const {
+  EncoderInfo info = encoder_->GetEncoderInfo();
+
+  // Otherwise the VideoStreamEncoder converts EncodedFrameBuffer to I420
+  // before Encode. Whether a frame is forwarded is decided by its buffer, the
+  // other native frames are converted in Encode if the wrapped encoder can't
+  // take them
+  info.supports_native_handle = true;
+
+  if (passthrough_.load()) {
+    // The bitrate/resolution is decided by whoever encoded the frames
+    info.implementation_name = "Passthrough";
+    info.scaling_settings = EncoderInfo::ScalingSettings::kOff;
+    info.has_trusted_rate_controller = true;
+  }
+  return info;
+}
+
+}  // namespace livekit
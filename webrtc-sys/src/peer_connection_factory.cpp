@@ -20,7 +20,6 @@
 #include <utility>
 
 #include "api/audio_codecs/builtin_audio_decoder_factory.h"
-#include "api/audio_codecs/builtin_audio_encoder_factory.h"
 #include "api/peer_connection_interface.h"
 #include "api/rtc_error.h"
 #include "api/enable_media.h"
@@ -29,6 +28,7 @@
 #include "api/video_codecs/builtin_video_decoder_factory.h"
 #include "api/video_codecs/builtin_video_encoder_factory.h"
 #include "livekit/audio_device.h"
+#include "livekit/audio_encoder_factory.h"
 #include "livekit/audio_track.h"
 #include "livekit/peer_connection.h"
 #include "livekit/rtc_error.h"
@@ -67,9 +67,11 @@ PeerConnectionFactory::PeerConnectionFactory(
 
   dependencies.video_encoder_factory =
       std::move(std::make_unique<livekit::VideoEncoderFactory>());
-  dependencies.video_decoder_factory =
-      std::move(std::make_unique<livekit::VideoDecoderFactory>());
-  dependencies.audio_encoder_factory = webrtc::CreateBuiltinAudioEncoderFactory();
+  auto video_decoder_factory = std::make_unique<livekit::VideoDecoderFactory>();
+  video_decoder_factory_ = video_decoder_factory.get();
+  dependencies.video_decoder_factory = std::move(video_decoder_factory);
+  dependencies.audio_encoder_factory =
+      rtc::make_ref_counted<livekit::AudioEncoderFactory>();
   dependencies.audio_decoder_factory = webrtc::CreateBuiltinAudioDecoderFactory();
   dependencies.audio_processing = webrtc::AudioProcessingBuilder().Create();
 
@@ -111,9 +113,15 @@ std::shared_ptr<PeerConnection> PeerConnectionFactory::create_peer_connection(
 std::shared_ptr<VideoTrack> PeerConnectionFactory::create_video_track(
     rust::String label,
     std::shared_ptr<VideoTrackSource> source) const {
+  rtc::scoped_refptr<webrtc::VideoTrackInterface> track =
+      peer_factory_->CreateVideoTrack(source->get(), label.c_str());
+  if (source->is_screencast()) {
+    // Favor sharpness over motion for screen content
+    track->set_content_hint(webrtc::VideoTrackInterface::ContentHint::kDetailed);
+  }
+
   return std::static_pointer_cast<VideoTrack>(
-      rtc_runtime_->get_or_create_media_stream_track(
-          peer_factory_->CreateVideoTrack(source->get(), label.c_str())));
+      rtc_runtime_->get_or_create_media_stream_track(track));
 }
 
 std::shared_ptr<AudioTrack> PeerConnectionFactory::create_audio_track(
@@ -136,6 +144,15 @@ RtpCapabilities PeerConnectionFactory::rtp_receiver_capabilities(
       static_cast<cricket::MediaType>(type)));
 }
 
+void PeerConnectionFactory::set_video_decoder_threads(
+    uint32_t max_threads) const {
+  video_decoder_factory_->set_max_threads(static_cast<int>(max_threads));
+}
+
+void PeerConnectionFactory::set_crypto_threads(uint32_t count) const {
+  rtc_runtime_->set_crypto_thread_count(static_cast<int>(count));
+}
+
 std::shared_ptr<PeerConnectionFactory> create_peer_connection_factory() {
   return std::make_shared<PeerConnectionFactory>(RtcRuntime::create());
 }
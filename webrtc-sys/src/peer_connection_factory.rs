@@ -116,6 +116,10 @@ pub mod ffi {
             self: &PeerConnectionFactory,
             kind: MediaType,
         ) -> RtpCapabilities;
+
+        fn set_video_decoder_threads(self: &PeerConnectionFactory, max_threads: u32);
+
+        fn set_crypto_threads(self: &PeerConnectionFactory, count: u32);
     }
 
     extern "Rust" {
@@ -22,6 +22,7 @@
 #include "absl/types/optional.h"
 #include "api/peer_connection_interface.h"
 #include "api/scoped_refptr.h"
+#include "livekit/lazy_video_decoder.h"
 
 namespace livekit {
 
@@ -78,4 +79,39 @@ void RtpReceiver::set_jitter_buffer_minimum_delay(bool is_some,
       is_some ? absl::make_optional(delay_seconds) : absl::nullopt);
 }
 
+absl::optional<uint32_t> RtpReceiver::video_ssrc() const {
+  if (receiver_->media_type() != cricket::MEDIA_TYPE_VIDEO) {
+    return absl::nullopt;
+  }
+
+  webrtc::RtpParameters parameters = receiver_->GetParameters();
+  if (parameters.encodings.empty()) {
+    return absl::nullopt;
+  }
+  return parameters.encodings[0].ssrc;
+}
+
+std::shared_ptr<CodecStats> RtpReceiver::decoder_stats() const {
+  absl::optional<uint32_t> ssrc = video_ssrc();
+  return ssrc ? SharedDecoderStats(*ssrc) : nullptr;
+}
+
+bool RtpReceiver::set_preferred_decoder_output(
+    VideoFrameBufferType buffer_type) const {
+  absl::optional<uint32_t> ssrc = video_ssrc();
+  if (!ssrc) {
+    return false;
+  }
+
+  using Type = webrtc::VideoFrameBuffer::Type;
+  Type type = Type::kNative;
+  if (buffer_type == VideoFrameBufferType::I420) {
+    type = Type::kI420;
+  } else if (buffer_type == VideoFrameBufferType::NV12) {
+    type = Type::kNV12;
+  }
+  SetPreferredDecoderOutput(*ssrc, type);
+  return true;
+}
+
 }  // namespace livekit
@@ -24,12 +24,16 @@ pub mod ffi {
         include!("livekit/rtp_parameters.h");
         include!("livekit/helper.h");
         include!("livekit/media_stream.h");
+        include!("livekit/codec_stats.h");
+        include!("livekit/video_frame_buffer.h");
 
         type MediaType = crate::webrtc::ffi::MediaType;
         type RtpParameters = crate::rtp_parameters::ffi::RtpParameters;
         type MediaStreamPtr = crate::helper::ffi::MediaStreamPtr;
         type MediaStreamTrack = crate::media_stream::ffi::MediaStreamTrack;
         type MediaStream = crate::media_stream::ffi::MediaStream;
+        type CodecStats = crate::codec_stats::ffi::CodecStats;
+        type VideoFrameBufferType = crate::video_frame_buffer::ffi::VideoFrameBufferType;
     }
 
     unsafe extern "C++" {
@@ -49,6 +53,11 @@ pub mod ffi {
         fn id(self: &RtpReceiver) -> String;
         fn get_parameters(self: &RtpReceiver) -> RtpParameters;
         fn set_jitter_buffer_minimum_delay(self: &RtpReceiver, is_some: bool, delay_seconds: f64);
+        fn decoder_stats(self: &RtpReceiver) -> SharedPtr<CodecStats>;
+        fn set_preferred_decoder_output(
+            self: &RtpReceiver,
+            buffer_type: VideoFrameBufferType,
+        ) -> bool;
 
         fn _shared_rtp_receiver() -> SharedPtr<RtpReceiver>;
     }
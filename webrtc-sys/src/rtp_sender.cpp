@@ -16,6 +16,7 @@
 
 #include "livekit/rtp_sender.h"
 #include "livekit/jsep.h"
+#include "livekit/video_encoder_overrides.h"
 
 #include "rust/cxx.h"
 #include "webrtc-sys/src/rtp_sender.rs.h"
@@ -90,4 +91,20 @@ void RtpSender::set_parameters(RtpParameters params) const {
     throw std::runtime_error(serialize_error(to_error(error)));
 }
 
+std::shared_ptr<CodecStats> RtpSender::set_video_encoder_settings(
+    VideoEncoderSettings settings) const {
+  VideoEncoderOverrides overrides;
+  overrides.max_threads = static_cast<int>(settings.max_threads);
+  if (settings.has_complexity) {
+    overrides.complexity =
+        static_cast<webrtc::VideoCodecComplexity>(settings.complexity);
+  }
+
+  // The encoders are recreated with the new selector
+  auto stats = std::make_shared<CodecStats>();
+  sender_->SetEncoderSelector(
+      std::make_unique<VideoEncoderOverridesSelector>(overrides, stats));
+  return stats;
+}
+
 }  // namespace livekit
@@ -19,15 +19,34 @@ use crate::impl_thread_safety;
 #[cxx::bridge(namespace = "livekit")]
 pub mod ffi {
 
+    #[derive(Debug, Clone, Copy, PartialEq, Eq)]
+    #[repr(i32)]
+    pub enum VideoEncoderComplexity {
+        Low = -1,
+        Normal = 0,
+        High = 1,
+        Higher = 2,
+        Max = 3,
+    }
+
+    #[derive(Debug, Clone)]
+    pub struct VideoEncoderSettings {
+        pub max_threads: u32,
+        pub has_complexity: bool,
+        pub complexity: VideoEncoderComplexity,
+    }
+
     extern "C++" {
         include!("livekit/webrtc.h");
         include!("livekit/rtp_parameters.h");
         include!("livekit/media_stream.h");
+        include!("livekit/codec_stats.h");
 
         type MediaType = crate::webrtc::ffi::MediaType;
         type RtpEncodingParameters = crate::rtp_parameters::ffi::RtpEncodingParameters;
         type RtpParameters = crate::rtp_parameters::ffi::RtpParameters;
         type MediaStreamTrack = crate::media_stream::ffi::MediaStreamTrack;
+        type CodecStats = crate::codec_stats::ffi::CodecStats;
     }
 
     unsafe extern "C++" {
@@ -50,6 +69,10 @@ pub mod ffi {
         fn init_send_encodings(self: &RtpSender) -> Vec<RtpEncodingParameters>;
         fn get_parameters(self: &RtpSender) -> RtpParameters;
         fn set_parameters(self: &RtpSender, parameters: RtpParameters) -> Result<()>;
+        fn set_video_encoder_settings(
+            self: &RtpSender,
+            settings: VideoEncoderSettings,
+        ) -> SharedPtr<CodecStats>;
 
         fn _shared_rtp_sender() -> SharedPtr<RtpSender>;
     }
@@ -0,0 +1,244 @@
+/*
+ * Copyright 2023 LiveKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the “License”);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an “AS IS” BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "livekit/scaling_pyramid.h"
+
+#include "absl/strings/match.h"
+#include "api/make_ref_counted.h"
+#include "api/video/video_frame.h"
+#include "modules/video_coding/include/video_error_codes.h"
+
+namespace livekit {
+
+ScalingPyramid::ScalingPyramid(
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> source) {
+  levels_.push_back(std::move(source));
+}
+
+rtc::scoped_refptr<webrtc::VideoFrameBuffer> ScalingPyramid::Scale(
+    int width,
+    int height) {
+  webrtc::MutexLock lock(&mutex_);
+
+  // Walk down the cascade while the next half level is still large enough,
+  // building the missing levels from the previous (smaller) one
+  size_t level = 0;
+  while (true) {
+    int half_width = levels_[level]->width() / 2;
+    int half_height = levels_[level]->height() / 2;
+    if (half_width < width || half_height < height || half_width == 0 ||
+        half_height == 0) {
+      break;
+    }
+
+    if (level + 1 == levels_.size()) {
+      levels_.push_back(levels_[level]->Scale(half_width, half_height));
+    }
+    ++level;
+  }
+
+  const rtc::scoped_refptr<webrtc::VideoFrameBuffer>& closest = levels_[level];
+  if (closest->width() == width && closest->height() == height) {
+    return closest;
+  }
+  return closest->Scale(width, height);
+}
+
+PyramidI420Buffer::PyramidI420Buffer(
+    rtc::scoped_refptr<webrtc::I420BufferInterface> buffer)
+    : buffer_(buffer), pyramid_(buffer) {}
+
+int PyramidI420Buffer::width() const {
+  return buffer_->width();
+}
+
+int PyramidI420Buffer::height() const {
+  return buffer_->height();
+}
+
+const uint8_t* PyramidI420Buffer::DataY() const {
+  return buffer_->DataY();
+}
+
+const uint8_t* PyramidI420Buffer::DataU() const {
+  return buffer_->DataU();
+}
+
+const uint8_t* PyramidI420Buffer::DataV() const {
+  return buffer_->DataV();
+}
+
+int PyramidI420Buffer::StrideY() const {
+  return buffer_->StrideY();
+}
+
+int PyramidI420Buffer::StrideU() const {
+  return buffer_->StrideU();
+}
+
+int PyramidI420Buffer::StrideV() const {
+  return buffer_->StrideV();
+}
+
+rtc::scoped_refptr<webrtc::VideoFrameBuffer> PyramidI420Buffer::CropAndScale(
+    int offset_x,
+    int offset_y,
+    int crop_width,
+    int crop_height,
+    int scaled_width,
+    int scaled_height) {
+  if (offset_x != 0 || offset_y != 0 || crop_width != width() ||
+      crop_height != height()) {
+    return buffer_->CropAndScale(offset_x, offset_y, crop_width, crop_height,
+                                 scaled_width, scaled_height);
+  }
+  return pyramid_.Scale(scaled_width, scaled_height);
+}
+
+PyramidNV12Buffer::PyramidNV12Buffer(
+    rtc::scoped_refptr<webrtc::NV12BufferInterface> buffer)
+    : buffer_(buffer), pyramid_(buffer) {}
+
+int PyramidNV12Buffer::width() const {
+  return buffer_->width();
+}
+
+int PyramidNV12Buffer::height() const {
+  return buffer_->height();
+}
+
+const uint8_t* PyramidNV12Buffer::DataY() const {
+  return buffer_->DataY();
+}
+
+const uint8_t* PyramidNV12Buffer::DataUV() const {
+  return buffer_->DataUV();
+}
+
+int PyramidNV12Buffer::StrideY() const {
+  return buffer_->StrideY();
+}
+
+int PyramidNV12Buffer::StrideUV() const {
+  return buffer_->StrideUV();
+}
+
+rtc::scoped_refptr<webrtc::I420BufferInterface> PyramidNV12Buffer::ToI420() {
+  return buffer_->ToI420();
+}
+
+rtc::scoped_refptr<webrtc::VideoFrameBuffer> PyramidNV12Buffer::CropAndScale(
+    int offset_x,
+    int offset_y,
+    int crop_width,
+    int crop_height,
+    int scaled_width,
+    int scaled_height) {
+  if (offset_x != 0 || offset_y != 0 || crop_width != width() ||
+      crop_height != height()) {
+    return buffer_->CropAndScale(offset_x, offset_y, crop_width, crop_height,
+                                 scaled_width, scaled_height);
+  }
+  return pyramid_.Scale(scaled_width, scaled_height);
+}
+
+PyramidSimulcastEncoder::PyramidSimulcastEncoder(
+    std::unique_ptr<webrtc::VideoEncoder> encoder)
+    : encoder_(std::move(encoder)) {}
+
+void PyramidSimulcastEncoder::SetFecControllerOverride(
+    webrtc::FecControllerOverride* fec_controller_override) {
+  encoder_->SetFecControllerOverride(fec_controller_override);
+}
+
+int PyramidSimulcastEncoder::InitEncode(
+    const webrtc::VideoCodec* codec_settings,
+    const webrtc::VideoEncoder::Settings& settings) {
+  int result = encoder_->InitEncode(codec_settings, settings);
+  // A simulcast capable encoder (libvpx VP8) gets every layer from a single
+  // input and already cascades the downscales itself, only split adapters
+  // (named after the adapter) scale the input of each layer encoder
+  simulcast_ =
+      result == WEBRTC_VIDEO_CODEC_OK && codec_settings &&
+      codec_settings->numberOfSimulcastStreams > 1 &&
+      absl::StartsWith(encoder_->GetEncoderInfo().implementation_name,
+                       "SimulcastEncoderAdapter");
+  return result;
+}
+
+int32_t PyramidSimulcastEncoder::RegisterEncodeCompleteCallback(
+    webrtc::EncodedImageCallback* callback) {
+  return encoder_->RegisterEncodeCompleteCallback(callback);
+}
+
+int32_t PyramidSimulcastEncoder::Release() {
+  return encoder_->Release();
+}
+
+int32_t PyramidSimulcastEncoder::Encode(
+    const webrtc::VideoFrame& frame,
+    const std::vector<webrtc::VideoFrameType>* frame_types) {
+  if (!simulcast_) {
+    return encoder_->Encode(frame, frame_types);
+  }
+
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer =
+      frame.video_frame_buffer();
+  switch (buffer->type()) {
+    case webrtc::VideoFrameBuffer::Type::kI420:
+      buffer = rtc::make_ref_counted<PyramidI420Buffer>(
+          rtc::scoped_refptr<webrtc::I420BufferInterface>(
+              const_cast<webrtc::I420BufferInterface*>(buffer->GetI420())));
+      break;
+    case webrtc::VideoFrameBuffer::Type::kNV12:
+      buffer = rtc::make_ref_counted<PyramidNV12Buffer>(
+          rtc::scoped_refptr<webrtc::NV12BufferInterface>(
+              const_cast<webrtc::NV12BufferInterface*>(buffer->GetNV12())));
+      break;
+    default:
+      // Native buffers are scaled by the platform encoders themselves
+      return encoder_->Encode(frame, frame_types);
+  }
+
+  webrtc::VideoFrame pyramid_frame(frame);
+  pyramid_frame.set_video_frame_buffer(buffer);
+  return encoder_->Encode(pyramid_frame, frame_types);
+}
+
+void PyramidSimulcastEncoder::SetRates(const RateControlParameters& parameters) {
+  encoder_->SetRates(parameters);
+}
+
+void PyramidSimulcastEncoder::OnPacketLossRateUpdate(float packet_loss_rate) {
+  encoder_->OnPacketLossRateUpdate(packet_loss_rate);
+}
+
+void PyramidSimulcastEncoder::OnRttUpdate(int64_t rtt_ms) {
+  encoder_->OnRttUpdate(rtt_ms);
+}
+
+void PyramidSimulcastEncoder::OnLossNotification(
+    const LossNotification& loss_notification) {
+  encoder_->OnLossNotification(loss_notification);
+}
+
+webrtc::VideoEncoder::EncoderInfo PyramidSimulcastEncoder::GetEncoderInfo()
+    const {
+  return encoder_->GetEncoderInfo();
+}
+
+}  // namespace livekit
@@ -16,10 +16,16 @@
 
 #include "livekit/video_decoder_factory.h"
 
+#include <algorithm>
+
 #include <modules/video_coding/codecs/av1/av1_svc_config.h>
 #include "api/environment/environment.h"
+#include "api/environment/environment_factory.h"
+#include "api/field_trials_view.h"
 #include "api/video_codecs/av1_profile.h"
 #include "api/video_codecs/sdp_video_format.h"
+#include "livekit/instrumented_video_codec.h"
+#include "livekit/lazy_video_decoder.h"
 #include "livekit/objc_video_factory.h"
 #include "media/base/media_constants.h"
 #include "modules/video_coding/codecs/h264/include/h264.h"
@@ -37,6 +43,25 @@
 
 namespace livekit {
 
+namespace {
+
+// Per-decoder override of the field trial selecting the output of the
+// libvpx decoders (the H264 and VP9 decoders only read the global one)
+class NV12DecodeFieldTrials : public webrtc::FieldTrialsView {
+ public:
+  explicit NV12DecodeFieldTrials(const webrtc::FieldTrialsView& base)
+      : base_(base) {}
+
+  std::string Lookup(absl::string_view key) const override {
+    return key == "WebRTC-NV12Decode" ? "Enabled" : base_.Lookup(key);
+  }
+
+ private:
+  const webrtc::FieldTrialsView& base_;  // kept alive by the parent env
+};
+
+}  // namespace
+
 VideoDecoderFactory::VideoDecoderFactory() {
 #ifdef __APPLE__
   factories_.push_back(livekit::CreateObjCVideoDecoderFactory());
@@ -91,6 +116,30 @@ VideoDecoderFactory::CodecSupport VideoDecoderFactory::QueryCodecSupport(
 
 std::unique_ptr<webrtc::VideoDecoder> VideoDecoderFactory::Create(
     const webrtc::Environment& env, const webrtc::SdpVideoFormat& format) {
+  auto formats = GetSupportedFormats();
+  if (std::none_of(formats.begin(), formats.end(),
+                   [&](const webrtc::SdpVideoFormat& supported) {
+                     return absl::EqualsIgnoreCase(supported.name,
+                                                   format.name);
+                   })) {
+    RTC_LOG(LS_ERROR) << "No VideoDecoder found for " << format.name;
+    return nullptr;
+  }
+
+  // The decoder is only created once there is something to decode,
+  // per-frame latency/QP/size are readable from the RtpReceiver
+  return std::make_unique<InstrumentedVideoDecoder>(
+      std::make_unique<LazyVideoDecoder>(
+          [this, env, format](webrtc::VideoFrameBuffer::Type output) {
+            return CreateInternal(env, format, output);
+          },
+          max_threads_.load()));
+}
+
+std::unique_ptr<webrtc::VideoDecoder> VideoDecoderFactory::CreateInternal(
+    const webrtc::Environment& env,
+    const webrtc::SdpVideoFormat& format,
+    webrtc::VideoFrameBuffer::Type output) {
   for (const auto& factory : factories_) {
     for (const auto& supported_format : factory->GetSupportedFormats()) {
       if (supported_format.IsSameCodec(format))
@@ -98,8 +147,17 @@ std::unique_ptr<webrtc::VideoDecoder> VideoDecoderFactory::Create(
     }
   }
 
-  if (absl::EqualsIgnoreCase(format.name, cricket::kVp8CodecName))
+  if (absl::EqualsIgnoreCase(format.name, cricket::kVp8CodecName)) {
+    if (output == webrtc::VideoFrameBuffer::Type::kNV12) {
+      // libvpx VP8 then decodes into a pool of NV12 buffers
+      return webrtc::CreateVp8Decoder(
+          webrtc::EnvironmentFactory(env)
+              .With(std::make_unique<NV12DecodeFieldTrials>(
+                  env.field_trials()))
+              .Create());
+    }
     return webrtc::CreateVp8Decoder(env);
+  }
   if (absl::EqualsIgnoreCase(format.name, cricket::kVp9CodecName))
     return webrtc::VP9Decoder::Create();
   if (absl::EqualsIgnoreCase(format.name, cricket::kH264CodecName))
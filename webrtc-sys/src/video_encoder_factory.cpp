@@ -16,11 +16,19 @@
 
 #include "livekit/video_encoder_factory.h"
 
+#include <algorithm>
+
+#include "absl/strings/ascii.h"
 #include "api/environment/environment_factory.h"
 #include "api/video_codecs/sdp_video_format.h"
+#include "api/video_codecs/video_codec.h"
 #include "api/video_codecs/video_encoder.h"
 #include "api/video_codecs/video_encoder_factory_template.h"
+#include "livekit/instrumented_video_codec.h"
 #include "livekit/objc_video_factory.h"
+#include "livekit/passthrough_video_encoder.h"
+#include "livekit/scaling_pyramid.h"
+#include "livekit/video_encoder_overrides.h"
 #include "media/base/media_constants.h"
 #include "media/engine/simulcast_encoder_adapter.h"
 #include "rtc_base/logging.h"
@@ -49,7 +57,8 @@ using Factory = webrtc::VideoEncoderFactoryTemplate<
 #endif
     webrtc::LibvpxVp9EncoderTemplateAdapter>;
 
-VideoEncoderFactory::InternalFactory::InternalFactory() {
+VideoEncoderFactory::InternalFactory::InternalFactory()
+    : builtin_factory_(std::make_unique<Factory>()) {
 #ifdef __APPLE__
   factories_.push_back(livekit::CreateObjCVideoEncoderFactory());
 #endif
@@ -59,46 +68,93 @@ VideoEncoderFactory::InternalFactory::InternalFactory() {
 #endif
 
   // TODO(theomonnom): Add other HW encoders here
-}
 
-std::vector<webrtc::SdpVideoFormat>
-VideoEncoderFactory::InternalFactory::GetSupportedFormats() const {
-  std::vector<webrtc::SdpVideoFormat> formats = Factory().GetSupportedFormats();
+  formats_ = builtin_factory_->GetSupportedFormats();
+  for (const auto& format : formats_) {
+    codecs_[format.name].builtin.push_back(format);
+  }
 
   for (const auto& factory : factories_) {
-    auto supported_formats = factory->GetSupportedFormats();
-    formats.insert(formats.end(), supported_formats.begin(),
-                   supported_formats.end());
+    for (const auto& format : factory->GetSupportedFormats()) {
+      codecs_[format.name].platform.emplace_back(factory.get(), format);
+      formats_.push_back(format);
+    }
+  }
+}
+
+bool VideoEncoderFactory::InternalFactory::CaseInsensitiveLess::operator()(
+    absl::string_view a,
+    absl::string_view b) const {
+  return std::lexicographical_compare(
+      a.begin(), a.end(), b.begin(), b.end(), [](char lhs, char rhs) {
+        return absl::ascii_tolower(lhs) < absl::ascii_tolower(rhs);
+      });
+}
+
+const VideoEncoderFactory::InternalFactory::CodecFormats*
+VideoEncoderFactory::InternalFactory::Find(
+    const webrtc::SdpVideoFormat& format) const {
+  auto it = codecs_.find(absl::string_view(format.name));
+  return it != codecs_.end() ? &it->second : nullptr;
+}
+
+bool VideoEncoderFactory::InternalFactory::IsSupported(
+    const webrtc::SdpVideoFormat& format) const {
+  const CodecFormats* codec = Find(format);
+  if (!codec) {
+    return false;
+  }
+
+  for (const auto& [factory, supported_format] : codec->platform) {
+    if (supported_format.IsSameCodec(format))
+      return true;
   }
-  return formats;
+  return format.IsCodecInList(codec->builtin);
+}
+
+std::vector<webrtc::SdpVideoFormat>
+VideoEncoderFactory::InternalFactory::GetSupportedFormats() const {
+  return formats_;
 }
 
 VideoEncoderFactory::CodecSupport
 VideoEncoderFactory::InternalFactory::QueryCodecSupport(
     const webrtc::SdpVideoFormat& format,
     absl::optional<std::string> scalability_mode) const {
+  const CodecFormats* codec = Find(format);
+  if (!codec) {
+    return {.is_supported = false};
+  }
+
+  // Create picks the platform encoder whenever it has the codec (it isn't
+  // told the scalability mode), so its answer is the one that applies
+  for (const auto& [factory, supported_format] : codec->platform) {
+    if (supported_format.IsSameCodec(format))
+      return factory->QueryCodecSupport(format, scalability_mode);
+  }
+
   auto original_format =
-      webrtc::FuzzyMatchSdpVideoFormat(Factory().GetSupportedFormats(), format);
-  return original_format
-             ? Factory().QueryCodecSupport(*original_format, scalability_mode)
-             : webrtc::VideoEncoderFactory::CodecSupport{.is_supported = false};
+      webrtc::FuzzyMatchSdpVideoFormat(codec->builtin, format);
+  return original_format ? builtin_factory_->QueryCodecSupport(
+                               *original_format, scalability_mode)
+                         : CodecSupport{.is_supported = false};
 }
 
 std::unique_ptr<webrtc::VideoEncoder>
 VideoEncoderFactory::InternalFactory::Create(
     const webrtc::Environment& env, const webrtc::SdpVideoFormat& format) {
-  for (const auto& factory : factories_) {
-    for (const auto& supported_format : factory->GetSupportedFormats()) {
+  const CodecFormats* codec = Find(format);
+  if (codec) {
+    for (const auto& [factory, supported_format] : codec->platform) {
       if (supported_format.IsSameCodec(format))
         return factory->Create(env, format);
     }
-  }
 
-  auto original_format =
-      webrtc::FuzzyMatchSdpVideoFormat(Factory().GetSupportedFormats(), format);
-
-  if (original_format) {
-    return Factory().Create(env, *original_format);
+    auto original_format =
+        webrtc::FuzzyMatchSdpVideoFormat(codec->builtin, format);
+    if (original_format) {
+      return builtin_factory_->Create(env, *original_format);
+    }
   }
 
   RTC_LOG(LS_ERROR) << "No VideoEncoder found for " << format.name;
@@ -123,11 +179,31 @@ VideoEncoderFactory::CodecSupport VideoEncoderFactory::QueryCodecSupport(
 std::unique_ptr<webrtc::VideoEncoder> VideoEncoderFactory::Create(
     const webrtc::Environment& env, const webrtc::SdpVideoFormat& format) {
   std::unique_ptr<webrtc::VideoEncoder> encoder;
-  if (format.IsCodecInList(internal_factory_->GetSupportedFormats())) {
-    encoder = std::make_unique<webrtc::SimulcastEncoderAdapter>(
-        env, internal_factory_.get(), nullptr, format);
+  CreatedVideoEncoder created;
+  if (internal_factory_->IsSupported(format)) {
+    // Simulcast layers are downscaled through a shared pyramid (1/4 is
+    // scaled from 1/2 instead of the full resolution input)
+    encoder = std::make_unique<PyramidSimulcastEncoder>(
+        std::make_unique<webrtc::SimulcastEncoderAdapter>(
+            env, internal_factory_.get(), nullptr, format));
+
+    // Pre-encoded frames (EncodedFrameBuffer) skip the encoder entirely
+    encoder = std::make_unique<PassthroughVideoEncoder>(
+        webrtc::PayloadStringToCodecType(format.name), std::move(encoder));
+
+    // Threads/complexity set on the RtpSender (VideoEncoderOverridesSelector)
+    auto tuned = std::make_unique<TunedVideoEncoder>(std::move(encoder));
+    created.tuned = tuned.get();
+
+    // Per-frame latency/QP/size, readable from the RtpSender
+    auto instrumented =
+        std::make_unique<InstrumentedVideoEncoder>(std::move(tuned));
+    created.instrumented = instrumented.get();
+    encoder = std::move(instrumented);
   }
 
+  // Always replaced, an encoder without selector is never left behind
+  SetCreatedVideoEncoder(created);
   return encoder;
 }
 
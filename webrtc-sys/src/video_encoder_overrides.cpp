@@ -0,0 +1,139 @@
+/*
+ * Copyright 2023 LiveKit
+ *
+ * Licensed under the Apache License, Version 2.0 (the “License”);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an “AS IS” BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "livekit/video_encoder_overrides.h"
+
+#include <algorithm>
+
+#include "livekit/instrumented_video_codec.h"
+
+namespace livekit {
+
+namespace {
+
+// Only spans a Create and the OnCurrentEncoder following it
+thread_local CreatedVideoEncoder created_encoder;
+
+}  // namespace
+
+void SetCreatedVideoEncoder(CreatedVideoEncoder encoder) {
+  created_encoder = encoder;
+}
+
+CreatedVideoEncoder TakeCreatedVideoEncoder() {
+  CreatedVideoEncoder encoder = created_encoder;
+  created_encoder = CreatedVideoEncoder();
+  return encoder;
+}
+
+VideoEncoderOverridesSelector::VideoEncoderOverridesSelector(
+    VideoEncoderOverrides overrides,
+    std::shared_ptr<CodecStats> stats)
+    : overrides_(overrides), stats_(std::move(stats)) {}
+
+void VideoEncoderOverridesSelector::OnCurrentEncoder(
+    const webrtc::SdpVideoFormat& format) {
+  CreatedVideoEncoder encoder = TakeCreatedVideoEncoder();
+  if (encoder.tuned) {
+    encoder.tuned->SetOverrides(overrides_);
+  }
+  if (encoder.instrumented) {
+    encoder.instrumented->SetStats(stats_);
+  }
+}
+
+absl::optional<webrtc::SdpVideoFormat>
+VideoEncoderOverridesSelector::OnAvailableBitrate(
+    const webrtc::DataRate& rate) {
+  return absl::nullopt;
+}
+
+absl::optional<webrtc::SdpVideoFormat>
+VideoEncoderOverridesSelector::OnEncoderBroken() {
+  return absl::nullopt;  // default fallback
+}
+
+TunedVideoEncoder::TunedVideoEncoder(
+    std::unique_ptr<webrtc::VideoEncoder> encoder)
+    : encoder_(std::move(encoder)) {}
+
+void TunedVideoEncoder::SetOverrides(const VideoEncoderOverrides& overrides) {
+  overrides_ = overrides;
+}
+
+void TunedVideoEncoder::SetFecControllerOverride(
+    webrtc::FecControllerOverride* fec_controller_override) {
+  encoder_->SetFecControllerOverride(fec_controller_override);
+}
+
+int TunedVideoEncoder::InitEncode(
+    const webrtc::VideoCodec* codec_settings,
+    const webrtc::VideoEncoder::Settings& settings) {
+  if (!overrides_) {
+    return encoder_->InitEncode(codec_settings, settings);
+  }
+
+  webrtc::VideoCodec codec = *codec_settings;
+  if (overrides_->complexity) {
+    codec.SetVideoEncoderComplexity(*overrides_->complexity);
+  }
+
+  webrtc::VideoEncoder::Settings tuned = settings;
+  if (overrides_->max_threads > 0) {
+    tuned.number_of_cores =
+        std::min(tuned.number_of_cores, overrides_->max_threads);
+    tuned.encoder_thread_limit = overrides_->max_threads;
+  }
+  return encoder_->InitEncode(&codec, tuned);
+}
+
+int32_t TunedVideoEncoder::RegisterEncodeCompleteCallback(
+    webrtc::EncodedImageCallback* callback) {
+  return encoder_->RegisterEncodeCompleteCallback(callback);
+}
+
+int32_t TunedVideoEncoder::Release() {
+  return encoder_->Release();
+}
+
+int32_t TunedVideoEncoder::Encode(
+    const webrtc::VideoFrame& frame,
+    const std::vector<webrtc::VideoFrameType>* frame_types) {
+  return encoder_->Encode(frame, frame_types);
+}
+
+void TunedVideoEncoder::SetRates(const RateControlParameters& parameters) {
+  encoder_->SetRates(parameters);
+}
+
+void TunedVideoEncoder::OnPacketLossRateUpdate(float packet_loss_rate) {
+  encoder_->OnPacketLossRateUpdate(packet_loss_rate);
+}
+
+void TunedVideoEncoder::OnRttUpdate(int64_t rtt_ms) {
+  encoder_->OnRttUpdate(rtt_ms);
+}
+
+void TunedVideoEncoder::OnLossNotification(
+    const LossNotification& loss_notification) {
+  encoder_->OnLossNotification(loss_notification);
+}
+
+webrtc::VideoEncoder::EncoderInfo TunedVideoEncoder::GetEncoderInfo() const {
+  return encoder_->GetEncoderInfo();
+}
+
+}  // namespace livekit
@@ -75,6 +75,10 @@ void VideoFrameBuilder::set_id(uint16_t id) {
   builder_.set_id(id);
 }
 
+void VideoFrameBuilder::set_update_rect(int x, int y, int width, int height) {
+  builder_.set_update_rect(webrtc::VideoFrame::UpdateRect{x, y, width, height});
+}
+
 std::unique_ptr<VideoFrame> VideoFrameBuilder::build() {
   return std::make_unique<VideoFrame>(builder_.build());
 }
@@ -52,6 +52,13 @@ pub mod ffi {
         fn set_timestamp_us(self: Pin<&mut VideoFrameBuilder>, timestamp_us: i64);
         fn set_rotation(self: Pin<&mut VideoFrameBuilder>, rotation: VideoRotation);
         fn set_id(self: Pin<&mut VideoFrameBuilder>, id: u16);
+        fn set_update_rect(
+            self: Pin<&mut VideoFrameBuilder>,
+            x: i32,
+            y: i32,
+            width: i32,
+            height: i32,
+        );
         fn set_video_frame_buffer(self: Pin<&mut VideoFrameBuilder>, buffer: &VideoFrameBuffer);
 
         fn build(self: Pin<&mut VideoFrameBuilder>) -> UniquePtr<VideoFrame>;
@@ -220,11 +220,34 @@ I010Buffer::I010Buffer(rtc::scoped_refptr<webrtc::I010BufferInterface> buffer)
 NV12Buffer::NV12Buffer(rtc::scoped_refptr<webrtc::NV12BufferInterface> buffer)
     : BiplanarYuv8Buffer(buffer) {}
 
+I420ScalingPyramid::I420ScalingPyramid(
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer)
+    : pyramid_(std::move(buffer)) {}
+
+std::unique_ptr<I420Buffer> I420ScalingPyramid::scale(int width,
+                                                      int height) const {
+  return std::make_unique<I420Buffer>(
+      pyramid_.Scale(width, height)->ToI420());
+}
+
 std::unique_ptr<I420Buffer> copy_i420_buffer(
     const std::unique_ptr<I420Buffer>& i420) {
   return std::make_unique<I420Buffer>(webrtc::I420Buffer::Copy(*i420->get()));
 }
 
+std::unique_ptr<I420Buffer> scale_i420_buffer(
+    const std::unique_ptr<I420Buffer>& i420,
+    int width,
+    int height) {
+  return std::make_unique<I420Buffer>(
+      i420->get()->Scale(width, height)->ToI420());
+}
+
+std::unique_ptr<I420ScalingPyramid> new_i420_scaling_pyramid(
+    const std::unique_ptr<I420Buffer>& i420) {
+  return std::make_unique<I420ScalingPyramid>(i420->get());
+}
+
 std::unique_ptr<I420Buffer> new_i420_buffer(int width,
                                             int height,
                                             int stride_y,
@@ -44,6 +44,7 @@ pub mod ffi {
         type I010Buffer;
         type NV12Buffer;
         type PlatformImageBuffer;
+        type I420ScalingPyramid;
 
         fn buffer_type(self: &VideoFrameBuffer) -> VideoFrameBufferType;
         fn width(self: &VideoFrameBuffer) -> u32;
@@ -88,6 +89,13 @@ pub mod ffi {
         fn data_a(self: &I420ABuffer) -> *const u8;
 
         fn copy_i420_buffer(i420: &UniquePtr<I420Buffer>) -> UniquePtr<I420Buffer>;
+        fn scale_i420_buffer(
+            i420: &UniquePtr<I420Buffer>,
+            width: i32,
+            height: i32,
+        ) -> UniquePtr<I420Buffer>;
+        fn new_i420_scaling_pyramid(i420: &UniquePtr<I420Buffer>) -> UniquePtr<I420ScalingPyramid>;
+        fn scale(self: &I420ScalingPyramid, width: i32, height: i32) -> UniquePtr<I420Buffer>;
         fn new_i420_buffer(
             width: i32,
             height: i32,
@@ -162,3 +170,4 @@ impl_thread_safety!(ffi::I422Buffer, Send + Sync);
 impl_thread_safety!(ffi::I444Buffer, Send + Sync);
 impl_thread_safety!(ffi::I010Buffer, Send + Sync);
 impl_thread_safety!(ffi::NV12Buffer, Send + Sync);
+impl_thread_safety!(ffi::I420ScalingPyramid, Send + Sync);
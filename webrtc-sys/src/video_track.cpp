@@ -25,6 +25,11 @@
 #include "api/video/video_rotation.h"
 #include "audio/remix_resample.h"
 #include "common_audio/include/audio_util.h"
+#include "libyuv/compare.h"
+#include "libyuv/convert.h"
+#include "libyuv/convert_from.h"
+#include "libyuv/planar_functions.h"
+#include "libyuv/rotate.h"
 #include "livekit/media_stream.h"
 #include "livekit/video_track.h"
 #include "rtc_base/logging.h"
@@ -37,7 +42,16 @@ namespace livekit {
 
 VideoTrack::VideoTrack(std::shared_ptr<RtcRuntime> rtc_runtime,
                        rtc::scoped_refptr<webrtc::VideoTrackInterface> track)
-    : MediaStreamTrack(rtc_runtime, std::move(track)) {}
+    : MediaStreamTrack(rtc_runtime, std::move(track)) {
+  webrtc::VideoTrackSourceInterface* source = this->track()->GetSource();
+  if (source && source->remote()) {
+    // should_receive_ keeps its default: the track state may have been
+    // lazily turned off by a previous wrapper, that isn't the user's choice
+    webrtc::MutexLock lock(&mutex_);
+    lazy_receive_ = true;
+    update_receive();  // no sink yet
+  }
+}
 
 VideoTrack::~VideoTrack() {
   webrtc::MutexLock lock(&mutex_);
@@ -46,12 +60,22 @@ VideoTrack::~VideoTrack() {
   }
 }
 
-void VideoTrack::add_sink(const std::shared_ptr<NativeVideoSink>& sink) const {
+void VideoTrack::add_sink(const std::shared_ptr<NativeVideoSink>& sink,
+                          const VideoSinkWants& wants) const {
+  // The wants only shape the frames of this sink (through its adapter), they
+  // aren't forwarded to the source: the broadcaster of a local source
+  // aggregates the wants of all its sinks, the encoder included, so a small
+  // preview would downscale and throttle the published video. The cost is a
+  // full resolution frame delivered to each sink before being scaled.
+  sink->set_sink_wants(wants);
+
+  // add_sink is also used to update the wants of an existing sink
   webrtc::MutexLock lock(&mutex_);
-  track()->AddOrUpdateSink(sink.get(),
-                           rtc::VideoSinkWants());  // TODO(theomonnom): Expose
-                                                    // VideoSinkWants to Rust?
-  sinks_.push_back(sink);
+  if (std::find(sinks_.begin(), sinks_.end(), sink) == sinks_.end()) {
+    track()->AddOrUpdateSink(sink.get(), rtc::VideoSinkWants());
+    sinks_.push_back(sink);
+    update_receive();
+  }
 }
 
 void VideoTrack::remove_sink(
@@ -59,14 +83,57 @@ void VideoTrack::remove_sink(
   webrtc::MutexLock lock(&mutex_);
   track()->RemoveSink(sink.get());
   sinks_.erase(std::remove(sinks_.begin(), sinks_.end(), sink), sinks_.end());
+  update_receive();
 }
 
 void VideoTrack::set_should_receive(bool should_receive) const {
-  track()->set_should_receive(should_receive);
+  webrtc::MutexLock lock(&mutex_);
+  should_receive_ = should_receive;
+  update_receive();
 }
 
 bool VideoTrack::should_receive() const {
-  return track()->should_receive();
+  webrtc::MutexLock lock(&mutex_);
+  return should_receive_;
+}
+
+void VideoTrack::set_lazy_receive(bool lazy_receive) const {
+  webrtc::MutexLock lock(&mutex_);
+  lazy_receive_ = lazy_receive;
+  update_receive();
+}
+
+bool VideoTrack::lazy_receive() const {
+  webrtc::MutexLock lock(&mutex_);
+  return lazy_receive_;
+}
+
+void VideoTrack::add_receive_hold() const {
+  webrtc::MutexLock lock(&mutex_);
+  ++receive_holds_;
+  update_receive();
+}
+
+void VideoTrack::remove_receive_hold() const {
+  webrtc::MutexLock lock(&mutex_);
+  --receive_holds_;
+  update_receive();
+}
+
+void VideoTrack::update_receive() const {
+  bool receive = should_receive_ && (!lazy_receive_ || !sinks_.empty() ||
+                                     receive_holds_ > 0);
+  if (receive == track()->should_receive()) {
+    return;
+  }
+
+  // Stopping the receive stream also releases the decoder
+  track()->set_should_receive(receive);
+  if (receive && track()->GetSource()) {
+    // The frames received before the pause are gone, don't wait for the
+    // periodic keyframe to start decoding again
+    track()->GetSource()->GenerateKeyFrame();
+  }
 }
 
 ContentHint VideoTrack::content_hint() const {
@@ -78,11 +145,181 @@ void VideoTrack::set_content_hint(ContentHint hint) const {
       static_cast<webrtc::VideoTrackInterface::ContentHint>(hint));
 }
 
-NativeVideoSink::NativeVideoSink(rust::Box<VideoSinkWrapper> observer)
-    : observer_(std::move(observer)) {}
+NativeVideoSink::NativeVideoSink(rust::Box<VideoSinkWrapper> observer,
+                                 VideoFrameBufferType format)
+    : observer_(std::move(observer)), format_(format), pool_(false, 8) {}
 
 void NativeVideoSink::OnFrame(const webrtc::VideoFrame& frame) {
-  observer_->on_frame(std::make_unique<VideoFrame>(frame));
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer =
+      frame.video_frame_buffer();
+
+  if (adapt_.load(std::memory_order_relaxed)) {
+    int cropped_width, cropped_height, out_width, out_height;
+    if (!adapter_.AdaptFrameResolution(frame.width(), frame.height(),
+                                       rtc::TimeNanos(), &cropped_width,
+                                       &cropped_height, &out_width,
+                                       &out_height)) {
+      return;  // decimated to match max_framerate_fps
+    }
+
+    // Scale before crossing the FFI, so Rust only sees the requested
+    // resolution
+    if (out_width != frame.width() || out_height != frame.height()) {
+      buffer = buffer->CropAndScale((frame.width() - cropped_width) / 2,
+                                    (frame.height() - cropped_height) / 2,
+                                    cropped_width, cropped_height, out_width,
+                                    out_height);
+    }
+  }
+
+  if (format_ != VideoFrameBufferType::Native) {
+    buffer = convert_buffer(buffer);
+    if (!buffer) {
+      return;  // conversion failed, already logged
+    }
+  }
+
+  if (buffer == frame.video_frame_buffer()) {
+    observer_->on_frame(std::make_unique<VideoFrame>(frame));
+    return;
+  }
+
+  webrtc::VideoFrame output_frame(frame);
+  output_frame.set_video_frame_buffer(buffer);
+  observer_->on_frame(std::make_unique<VideoFrame>(output_frame));
+}
+
+rtc::scoped_refptr<webrtc::VideoFrameBuffer> NativeVideoSink::convert_buffer(
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer) {
+  using Type = webrtc::VideoFrameBuffer::Type;
+  int width = buffer->width();
+  int height = buffer->height();
+
+  // Buffers already in the requested format (e.g the pooled NV12 output of
+  // the VP8 decoder) are passed through. The FFI hands them to the clients
+  // without a copy when their planes are contiguous, and copies them once
+  // otherwise.
+  Type type = buffer->type();
+  if ((format_ == VideoFrameBufferType::NV12 && type == Type::kNV12) ||
+      (format_ == VideoFrameBufferType::I420 && type == Type::kI420)) {
+    return buffer;
+  }
+
+  // Otherwise the output is a buffer owned by the sink (contiguous planes
+  // with a normalized stride)
+  if (format_ == VideoFrameBufferType::NV12) {
+    rtc::scoped_refptr<webrtc::NV12Buffer> nv12 =
+        pool_.CreateNV12Buffer(width, height);
+    if (!nv12) {
+      // Every pooled buffer is still held by the client
+      nv12 = webrtc::NV12Buffer::Create(width, height);
+    }
+
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> src = buffer;
+    if (buffer->type() == Type::kNative) {
+      Type mapped_types[] = {Type::kNV12};
+      auto mapped = buffer->GetMappedFrameBuffer(mapped_types);
+      if (mapped && mapped->type() == Type::kNV12) {
+        src = mapped;
+      }
+    }
+
+    if (src->type() == Type::kNV12) {
+      const webrtc::NV12BufferInterface* nv12_src = src->GetNV12();
+      libyuv::CopyPlane(nv12_src->DataY(), nv12_src->StrideY(),
+                        nv12->MutableDataY(), nv12->StrideY(), width, height);
+      libyuv::CopyPlane(nv12_src->DataUV(), nv12_src->StrideUV(),
+                        nv12->MutableDataUV(), nv12->StrideUV(),
+                        nv12->ChromaWidth() * 2, nv12->ChromaHeight());
+      return nv12;
+    }
+
+    // I420 buffers return themselves
+    rtc::scoped_refptr<webrtc::I420BufferInterface> i420 = src->ToI420();
+    if (!i420) {
+      RTC_LOG(LS_ERROR) << "failed to convert frame to NV12";
+      return nullptr;
+    }
+    libyuv::I420ToNV12(i420->DataY(), i420->StrideY(), i420->DataU(),
+                       i420->StrideU(), i420->DataV(), i420->StrideV(),
+                       nv12->MutableDataY(), nv12->StrideY(),
+                       nv12->MutableDataUV(), nv12->StrideUV(), width, height);
+    return nv12;
+  }
+
+  if (format_ == VideoFrameBufferType::I420) {
+    rtc::scoped_refptr<webrtc::I420Buffer> i420 =
+        pool_.CreateI420Buffer(width, height);
+    if (!i420) {
+      i420 = webrtc::I420Buffer::Create(width, height);
+    }
+
+    int ret = -1;
+    switch (buffer->type()) {
+      case Type::kI420:
+      case Type::kI420A: {
+        const webrtc::I420BufferInterface* src = buffer->GetI420();
+        ret = libyuv::I420Copy(src->DataY(), src->StrideY(), src->DataU(),
+                               src->StrideU(), src->DataV(), src->StrideV(),
+                               i420->MutableDataY(), i420->StrideY(),
+                               i420->MutableDataU(), i420->StrideU(),
+                               i420->MutableDataV(), i420->StrideV(), width,
+                               height);
+        break;
+      }
+      case Type::kI422: {
+        const webrtc::I422BufferInterface* src = buffer->GetI422();
+        ret = libyuv::I422ToI420(src->DataY(), src->StrideY(), src->DataU(),
+                                 src->StrideU(), src->DataV(), src->StrideV(),
+                                 i420->MutableDataY(), i420->StrideY(),
+                                 i420->MutableDataU(), i420->StrideU(),
+                                 i420->MutableDataV(), i420->StrideV(), width,
+                                 height);
+        break;
+      }
+      case Type::kI444: {
+        const webrtc::I444BufferInterface* src = buffer->GetI444();
+        ret = libyuv::I444ToI420(src->DataY(), src->StrideY(), src->DataU(),
+                                 src->StrideU(), src->DataV(), src->StrideV(),
+                                 i420->MutableDataY(), i420->StrideY(),
+                                 i420->MutableDataU(), i420->StrideU(),
+                                 i420->MutableDataV(), i420->StrideV(), width,
+                                 height);
+        break;
+      }
+      case Type::kNV12: {
+        const webrtc::NV12BufferInterface* src = buffer->GetNV12();
+        ret = libyuv::NV12ToI420(src->DataY(), src->StrideY(), src->DataUV(),
+                                 src->StrideUV(), i420->MutableDataY(),
+                                 i420->StrideY(), i420->MutableDataU(),
+                                 i420->StrideU(), i420->MutableDataV(),
+                                 i420->StrideV(), width, height);
+        break;
+      }
+      default: {
+        // Native and high bit depth buffers know best how to convert
+        // themselves, the result is then copied into the sink's buffer
+        rtc::scoped_refptr<webrtc::I420BufferInterface> src = buffer->ToI420();
+        if (src) {
+          ret = libyuv::I420Copy(src->DataY(), src->StrideY(), src->DataU(),
+                                 src->StrideU(), src->DataV(), src->StrideV(),
+                                 i420->MutableDataY(), i420->StrideY(),
+                                 i420->MutableDataU(), i420->StrideU(),
+                                 i420->MutableDataV(), i420->StrideV(), width,
+                                 height);
+        }
+        break;
+      }
+    }
+
+    if (ret != 0) {
+      RTC_LOG(LS_ERROR) << "failed to convert frame to I420: " << ret;
+      return nullptr;
+    }
+    return i420;
+  }
+
+  return buffer;
 }
 
 void NativeVideoSink::OnDiscardedFrame() {
@@ -99,19 +336,70 @@ void NativeVideoSink::OnConstraintsChanged(
   observer_->on_constraints_changed(cst);
 }
 
+void NativeVideoSink::set_sink_wants(const VideoSinkWants& wants) {
+  rtc::VideoSinkWants rtc_wants;
+  if (wants.has_max_pixel_count) {
+    rtc_wants.max_pixel_count = wants.max_pixel_count;
+  }
+  if (wants.has_target_pixel_count) {
+    rtc_wants.target_pixel_count = wants.target_pixel_count;
+  }
+  if (wants.has_max_framerate_fps) {
+    rtc_wants.max_framerate_fps = wants.max_framerate_fps;
+  }
+  rtc_wants.resolution_alignment = std::max(wants.resolution_alignment, 1);
+
+  adapter_.OnSinkWants(rtc_wants);
+  adapt_.store(wants.has_max_pixel_count || wants.has_target_pixel_count ||
+                   wants.has_max_framerate_fps ||
+                   rtc_wants.resolution_alignment > 1,
+               std::memory_order_relaxed);
+}
+
 std::shared_ptr<NativeVideoSink> new_native_video_sink(
-    rust::Box<VideoSinkWrapper> observer) {
-  return std::make_shared<NativeVideoSink>(std::move(observer));
+    rust::Box<VideoSinkWrapper> observer,
+    VideoFrameBufferType format) {
+  return std::make_shared<NativeVideoSink>(std::move(observer), format);
+}
+
+void KeyFrameRequestForwarder::set_observer(
+    rust::Box<KeyFrameRequestObserverWrapper> observer) {
+  webrtc::MutexLock lock(&mutex_);
+  observer_.emplace(std::move(observer));
+}
+
+void KeyFrameRequestForwarder::OnKeyFrameRequested() {
+  webrtc::MutexLock lock(&mutex_);
+  if (observer_) {
+    (*observer_)->on_keyframe_request();
+  }
 }
 
+namespace {
+
+// Rows hashed together when looking for changes in screen content
+constexpr int kScreencastBandHeight = 16;
+
+// Unchanged screen content is still forwarded at this interval, so the
+// encoder can answer keyframe requests
+constexpr int64_t kScreencastKeepAliveUs = rtc::kNumMicrosecsPerSec;
+
+}  // namespace
+
 VideoTrackSource::InternalSource::InternalSource(
-    const VideoResolution& resolution)
-    : rtc::AdaptedVideoTrackSource(4), resolution_(resolution) {}
+    const VideoResolution& resolution,
+    bool is_screencast)
+    : rtc::AdaptedVideoTrackSource(4),
+      resolution_(resolution),
+      rotation_pool_(false, 4),
+      is_screencast_(is_screencast),
+      keyframe_forwarder_(rtc::make_ref_counted<KeyFrameRequestForwarder>()) {
+}
 
 VideoTrackSource::InternalSource::~InternalSource() {}
 
 bool VideoTrackSource::InternalSource::is_screencast() const {
-  return false;
+  return is_screencast_;
 }
 
 absl::optional<bool> VideoTrackSource::InternalSource::needs_denoising() const {
@@ -147,6 +435,23 @@ bool VideoTrackSource::InternalSource::on_captured_frame(
                                   static_cast<uint32_t>(buffer->height())};
   }
 
+  // Hashes of this frame, they replace band_hashes_ only once the frame is
+  // forwarded. A frame dropped by AdaptFrame must not hide its changes from
+  // the next one. Empty when the content can't be hashed.
+  std::vector<uint32_t> hashes;
+  absl::optional<webrtc::VideoFrame::UpdateRect> update_rect;
+  if (frame.has_update_rect()) {
+    // Dirty region given by the capturer, the hashes can't be trusted anymore
+    update_rect = frame.update_rect();
+  } else if (is_screencast_) {
+    update_rect = detect_changes(*buffer, hashes);
+  }
+
+  if (is_screencast_ && update_rect && update_rect->IsEmpty() &&
+      aligned_timestamp_us - last_forwarded_us_ < kScreencastKeepAliveUs) {
+    return false;  // the screen didn't change, skip scaling and encoding
+  }
+
   int adapted_width, adapted_height, crop_width, crop_height, crop_x, crop_y;
   if (!AdaptFrame(buffer->width(), buffer->height(), aligned_timestamp_us,
                   &adapted_width, &adapted_height, &crop_width, &crop_height,
@@ -155,28 +460,215 @@ bool VideoTrackSource::InternalSource::on_captured_frame(
   }
 
   if (adapted_width != frame.width() || adapted_height != frame.height()) {
+    if (update_rect) {
+      update_rect = update_rect->ScaleWithFrame(
+          buffer->width(), buffer->height(), crop_x, crop_y, crop_width,
+          crop_height, adapted_width, adapted_height);
+    }
+
     buffer = buffer->CropAndScale(crop_x, crop_y, crop_width, crop_height,
                                   adapted_width, adapted_height);
   }
 
   webrtc::VideoRotation rotation = frame.rotation();
   if (apply_rotation() && rotation != webrtc::kVideoRotation_0) {
-    // If the buffer is I420, rtc::AdaptedVideoTrackSource will handle the
-    // rotation for us.
-    buffer = buffer->ToI420();
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> nv12 = buffer;
+    if (buffer->type() == webrtc::VideoFrameBuffer::Type::kNative) {
+      // Native buffers (e.g CVPixelBuffer) can often be mapped as NV12
+      // without a copy
+      webrtc::VideoFrameBuffer::Type mapped_types[] = {
+          webrtc::VideoFrameBuffer::Type::kNV12};
+      nv12 = buffer->GetMappedFrameBuffer(mapped_types);
+    }
+
+    if (nv12 && nv12->type() == webrtc::VideoFrameBuffer::Type::kNV12) {
+      // Convert and rotate in a single pass
+      rtc::scoped_refptr<webrtc::I420Buffer> rotated =
+          rotate_nv12(*nv12->GetNV12(), rotation);
+      if (rotated) {
+        buffer = rotated;
+        rotation = webrtc::kVideoRotation_0;
+      }
+    }
+
+    if (rotation != webrtc::kVideoRotation_0) {
+      // If the buffer is I420, rtc::AdaptedVideoTrackSource will handle the
+      // rotation for us.
+      buffer = buffer->ToI420();
+    }
+  }
+
+  if (frame.rotation() != webrtc::kVideoRotation_0 ||
+      (update_rect && update_rect->IsEmpty())) {
+    // The region would need to be rotated too, and keep-alive frames are
+    // forwarded as fully updated
+    update_rect.reset();
   }
 
   OnFrame(webrtc::VideoFrame::Builder()
               .set_video_frame_buffer(buffer)
               .set_rotation(rotation)
               .set_timestamp_us(aligned_timestamp_us)
+              .set_update_rect(update_rect)
               .build());
 
+  band_hashes_ = std::move(hashes);
+  hashed_width_ = frame.width();
+  hashed_height_ = frame.height();
+  last_forwarded_us_ = aligned_timestamp_us;
+  return true;
+}
+
+bool VideoTrackSource::InternalSource::on_captured_encoded_frame(
+    rtc::scoped_refptr<webrtc::EncodedImageBuffer> data,
+    webrtc::VideoCodecType codec,
+    bool is_keyframe,
+    int width,
+    int height,
+    int64_t timestamp_us) {
+  webrtc::MutexLock lock(&mutex_);
+
+  int64_t aligned_timestamp_us =
+      timestamp_aligner_.TranslateTimestamp(timestamp_us, rtc::TimeMicros());
+
+  if (resolution_.height == 0 || resolution_.width == 0) {
+    resolution_ = VideoResolution{static_cast<uint32_t>(width),
+                                  static_cast<uint32_t>(height)};
+  }
+
+  // AdaptFrame is skipped, an encoded frame can't be scaled or decimated
+  // (dropping a frame would break the following delta frames)
+  auto buffer = rtc::make_ref_counted<EncodedFrameBuffer>(
+      std::move(data), codec, is_keyframe, width, height, ++encoded_sequence_,
+      keyframe_forwarder_);
+
+  OnFrame(webrtc::VideoFrame::Builder()
+              .set_video_frame_buffer(buffer)
+              .set_rotation(webrtc::kVideoRotation_0)
+              .set_timestamp_us(aligned_timestamp_us)
+              .build());
   return true;
 }
 
-VideoTrackSource::VideoTrackSource(const VideoResolution& resolution) {
-  source_ = rtc::make_ref_counted<InternalSource>(resolution);
+rtc::scoped_refptr<KeyFrameRequestForwarder>
+VideoTrackSource::InternalSource::keyframe_forwarder() const {
+  return keyframe_forwarder_;
+}
+
+webrtc::VideoFrame::UpdateRect VideoTrackSource::InternalSource::detect_changes(
+    const webrtc::VideoFrameBuffer& buffer,
+    std::vector<uint32_t>& hashes) {
+  using Type = webrtc::VideoFrameBuffer::Type;
+  const int width = buffer.width();
+  const int height = buffer.height();
+  const webrtc::VideoFrame::UpdateRect full_rect{0, 0, width, height};
+
+  // Hash the planes in horizontal bands, libyuv::HashDjb2 is SIMD optimized
+  const uint8_t* planes[3] = {};
+  int strides[3] = {};
+  int widths[3] = {width, (width + 1) / 2, (width + 1) / 2};
+  int num_planes = 3;
+  if (buffer.type() == Type::kI420 || buffer.type() == Type::kI420A) {
+    const webrtc::I420BufferInterface* i420 = buffer.GetI420();
+    planes[0] = i420->DataY();
+    planes[1] = i420->DataU();
+    planes[2] = i420->DataV();
+    strides[0] = i420->StrideY();
+    strides[1] = i420->StrideU();
+    strides[2] = i420->StrideV();
+  } else if (buffer.type() == Type::kNV12) {
+    const webrtc::NV12BufferInterface* nv12 = buffer.GetNV12();
+    planes[0] = nv12->DataY();
+    planes[1] = nv12->DataUV();
+    strides[0] = nv12->StrideY();
+    strides[1] = nv12->StrideUV();
+    widths[1] = ((width + 1) / 2) * 2;
+    num_planes = 2;
+  } else {
+    // Reading native buffers would require a conversion, assume it changed
+    return full_rect;
+  }
+
+  const size_t num_bands =
+      (height + kScreencastBandHeight - 1) / kScreencastBandHeight;
+  const bool reset = width != hashed_width_ || height != hashed_height_ ||
+                     band_hashes_.size() != num_bands;
+  hashes.assign(num_bands, 0);
+
+  int first_changed = -1;
+  int last_changed = -1;
+  for (size_t band = 0; band < num_bands; ++band) {
+    int row_begin = static_cast<int>(band) * kScreencastBandHeight;
+    int row_end = std::min(height, row_begin + kScreencastBandHeight);
+
+    uint32_t hash = 5381;
+    for (int p = 0; p < num_planes; ++p) {
+      int begin = p == 0 ? row_begin : row_begin / 2;
+      int end = p == 0 ? row_end : (row_end + 1) / 2;
+      for (int row = begin; row < end; ++row) {
+        hash = libyuv::HashDjb2(planes[p] + row * strides[p], widths[p], hash);
+      }
+    }
+
+    hashes[band] = hash;
+    if (reset || hash != band_hashes_[band]) {
+      if (first_changed < 0) {
+        first_changed = static_cast<int>(band);
+      }
+      last_changed = static_cast<int>(band);
+    }
+  }
+
+  if (reset) {
+    return full_rect;
+  }
+
+  if (first_changed < 0) {
+    return webrtc::VideoFrame::UpdateRect{0, 0, 0, 0};
+  }
+
+  int top = first_changed * kScreencastBandHeight;
+  int bottom = std::min(height, (last_changed + 1) * kScreencastBandHeight);
+  return webrtc::VideoFrame::UpdateRect{0, top, width, bottom - top};
+}
+
+rtc::scoped_refptr<webrtc::I420Buffer>
+VideoTrackSource::InternalSource::rotate_nv12(
+    const webrtc::NV12BufferInterface& src,
+    webrtc::VideoRotation rotation) {
+  int width = src.width();
+  int height = src.height();
+  if (rotation == webrtc::kVideoRotation_90 ||
+      rotation == webrtc::kVideoRotation_270) {
+    std::swap(width, height);
+  }
+
+  rtc::scoped_refptr<webrtc::I420Buffer> dst =
+      rotation_pool_.CreateI420Buffer(width, height);
+  if (!dst) {
+    return nullptr;  // pool exhausted
+  }
+
+  int ret = libyuv::NV12ToI420Rotate(
+      src.DataY(), src.StrideY(), src.DataUV(), src.StrideUV(),
+      dst->MutableDataY(), dst->StrideY(), dst->MutableDataU(), dst->StrideU(),
+      dst->MutableDataV(), dst->StrideV(), src.width(), src.height(),
+      static_cast<libyuv::RotationMode>(rotation));
+  if (ret != 0) {
+    RTC_LOG(LS_ERROR) << "NV12ToI420Rotate failed: " << ret;
+    return nullptr;
+  }
+
+  return dst;
+}
+
+VideoTrackSource::VideoTrackSource(const VideoResolution& resolution,
+                                   bool is_screencast) {
+  source_ = rtc::make_ref_counted<InternalSource>(resolution, is_screencast);
+}
+
+bool VideoTrackSource::is_screencast() const {
+  return source_->is_screencast();
 }
 
 VideoResolution VideoTrackSource::video_resolution() const {
@@ -189,14 +681,33 @@ bool VideoTrackSource::on_captured_frame(
   return source_->on_captured_frame(rtc_frame);
 }
 
+bool VideoTrackSource::on_captured_encoded_frame(
+    rust::Slice<const uint8_t> data,
+    VideoCodecType codec,
+    bool is_keyframe,
+    uint32_t width,
+    uint32_t height,
+    int64_t timestamp_us) const {
+  return source_->on_captured_encoded_frame(
+      webrtc::EncodedImageBuffer::Create(data.data(), data.size()),
+      static_cast<webrtc::VideoCodecType>(codec), is_keyframe,
+      static_cast<int>(width), static_cast<int>(height), timestamp_us);
+}
+
+void VideoTrackSource::set_keyframe_request_observer(
+    rust::Box<KeyFrameRequestObserverWrapper> observer) const {
+  source_->keyframe_forwarder()->set_observer(std::move(observer));
+}
+
 rtc::scoped_refptr<VideoTrackSource::InternalSource> VideoTrackSource::get()
     const {
   return source_;
 }
 
 std::shared_ptr<VideoTrackSource> new_video_track_source(
-    const VideoResolution& resolution) {
-  return std::make_shared<VideoTrackSource>(resolution);
+    const VideoResolution& resolution,
+    bool is_screencast) {
+  return std::make_shared<VideoTrackSource>(resolution, is_screencast);
 }
 
 }  // namespace livekit
@@ -28,6 +28,17 @@ pub mod ffi {
         Text,
     }
 
+    // Same values as webrtc::VideoCodecType
+    #[repr(i32)]
+    #[derive(Debug)]
+    pub enum VideoCodecType {
+        Generic,
+        VP8,
+        VP9,
+        AV1,
+        H264,
+    }
+
     #[derive(Debug)]
     pub struct VideoTrackSourceConstraints {
         pub has_min_fps: bool,
@@ -36,6 +47,17 @@ pub mod ffi {
         pub max_fps: f64,
     }
 
+    #[derive(Debug, Clone, Copy, Default)]
+    pub struct VideoSinkWants {
+        pub has_max_pixel_count: bool,
+        pub max_pixel_count: i32,
+        pub has_target_pixel_count: bool,
+        pub target_pixel_count: i32,
+        pub has_max_framerate_fps: bool,
+        pub max_framerate_fps: i32,
+        pub resolution_alignment: i32,
+    }
+
     #[derive(Debug)]
     pub struct VideoResolution {
         pub width: u32,
@@ -45,8 +67,10 @@ pub mod ffi {
     extern "C++" {
         include!("livekit/video_frame.h");
         include!("livekit/media_stream_track.h");
+        include!("livekit/video_frame_buffer.h");
 
         type VideoFrame = crate::video_frame::ffi::VideoFrame;
+        type VideoFrameBufferType = crate::video_frame_buffer::ffi::VideoFrameBufferType;
         type MediaStreamTrack = crate::media_stream_track::ffi::MediaStreamTrack;
     }
 
@@ -57,17 +81,39 @@ pub mod ffi {
         type NativeVideoSink;
         type VideoTrackSource;
 
-        fn add_sink(self: &VideoTrack, sink: &SharedPtr<NativeVideoSink>);
+        fn add_sink(self: &VideoTrack, sink: &SharedPtr<NativeVideoSink>, wants: &VideoSinkWants);
         fn remove_sink(self: &VideoTrack, sink: &SharedPtr<NativeVideoSink>);
         fn set_should_receive(self: &VideoTrack, should_receive: bool);
         fn should_receive(self: &VideoTrack) -> bool;
+        fn set_lazy_receive(self: &VideoTrack, lazy_receive: bool);
+        fn lazy_receive(self: &VideoTrack) -> bool;
         fn content_hint(self: &VideoTrack) -> ContentHint;
         fn set_content_hint(self: &VideoTrack, hint: ContentHint);
-        fn new_native_video_sink(observer: Box<VideoSinkWrapper>) -> SharedPtr<NativeVideoSink>;
+        fn new_native_video_sink(
+            observer: Box<VideoSinkWrapper>,
+            format: VideoFrameBufferType,
+        ) -> SharedPtr<NativeVideoSink>;
 
         fn video_resolution(self: &VideoTrackSource) -> VideoResolution;
         fn on_captured_frame(self: &VideoTrackSource, frame: &UniquePtr<VideoFrame>) -> bool;
-        fn new_video_track_source(resolution: &VideoResolution) -> SharedPtr<VideoTrackSource>;
+        fn on_captured_encoded_frame(
+            self: &VideoTrackSource,
+            data: &[u8],
+            codec: VideoCodecType,
+            is_keyframe: bool,
+            width: u32,
+            height: u32,
+            timestamp_us: i64,
+        ) -> bool;
+        fn set_keyframe_request_observer(
+            self: &VideoTrackSource,
+            observer: Box<KeyFrameRequestObserverWrapper>,
+        );
+        fn is_screencast(self: &VideoTrackSource) -> bool;
+        fn new_video_track_source(
+            resolution: &VideoResolution,
+            is_screencast: bool,
+        ) -> SharedPtr<VideoTrackSource>;
         fn video_to_media(track: SharedPtr<VideoTrack>) -> SharedPtr<MediaStreamTrack>;
         unsafe fn media_to_video(track: SharedPtr<MediaStreamTrack>) -> SharedPtr<VideoTrack>;
         fn _shared_video_track() -> SharedPtr<VideoTrack>;
@@ -83,6 +129,12 @@ pub mod ffi {
             constraints: VideoTrackSourceConstraints,
         );
     }
+
+    extern "Rust" {
+        type KeyFrameRequestObserverWrapper;
+
+        fn on_keyframe_request(self: &KeyFrameRequestObserverWrapper);
+    }
 }
 
 impl_thread_safety!(ffi::VideoTrack, Send + Sync);
@@ -116,3 +168,21 @@ impl VideoSinkWrapper {
         self.observer.on_constraints_changed(constraints);
     }
 }
+
+pub trait KeyFrameRequestObserver: Send + Sync {
+    fn on_keyframe_request(&self);
+}
+
+pub struct KeyFrameRequestObserverWrapper {
+    observer: Arc<dyn KeyFrameRequestObserver>,
+}
+
+impl KeyFrameRequestObserverWrapper {
+    pub fn new(observer: Arc<dyn KeyFrameRequestObserver>) -> Self {
+        Self { observer }
+    }
+
+    fn on_keyframe_request(&self) {
+        self.observer.on_keyframe_request();
+    }
+}
@@ -20,6 +20,7 @@
 #include <atomic>
 #include <iostream>
 #include <memory>
+#include <string>
 
 #include "livekit/audio_track.h"
 #include "livekit/media_stream_track.h"
@@ -72,6 +73,9 @@ RtcRuntime::RtcRuntime() {
 RtcRuntime::~RtcRuntime() {
   RTC_LOG(LS_VERBOSE) << "~RtcRuntime()";
 
+  for (auto& thread : crypto_threads_) {
+    thread->Stop();
+  }
   worker_thread_->Stop();
   signaling_thread_->Stop();
   network_thread_->Stop();
@@ -101,6 +105,46 @@ rtc::Thread* RtcRuntime::signaling_thread() const {
   return signaling_thread_.get();
 }
 
+rtc::Thread* RtcRuntime::next_crypto_thread() {
+  webrtc::MutexLock lock(&crypto_mutex_);
+  size_t index = next_crypto_thread_++ % crypto_thread_count_;
+  if (index >= crypto_threads_.size()) {
+    index = crypto_threads_.size();
+    std::unique_ptr<rtc::Thread> thread = rtc::Thread::Create();
+    thread->SetName("crypto_thread_" + std::to_string(index), thread.get());
+    thread->Start();
+    crypto_threads_.push_back(std::move(thread));
+  }
+  return crypto_threads_[index].get();
+}
+
+void RtcRuntime::set_crypto_thread_count(int count) {
+  webrtc::MutexLock lock(&crypto_mutex_);
+  crypto_thread_count_ = static_cast<size_t>(std::max(count, 1));
+}
+
+void RtcRuntime::add_encrypted_receiver(
+    const webrtc::RtpReceiverInterface* receiver) {
+  webrtc::MutexLock lock(&crypto_mutex_);
+  encrypted_receivers_.insert(receiver);
+}
+
+void RtcRuntime::remove_encrypted_receiver(
+    const webrtc::RtpReceiverInterface* receiver) {
+  webrtc::MutexLock lock(&crypto_mutex_);
+  // A receiver may have been given to several cryptors, only forget one
+  auto it = encrypted_receivers_.find(receiver);
+  if (it != encrypted_receivers_.end()) {
+    encrypted_receivers_.erase(it);
+  }
+}
+
+bool RtcRuntime::is_encrypted_receiver(
+    const webrtc::RtpReceiverInterface* receiver) const {
+  webrtc::MutexLock lock(&crypto_mutex_);
+  return encrypted_receivers_.count(receiver) != 0;
+}
+
 std::shared_ptr<MediaStreamTrack> RtcRuntime::get_or_create_media_stream_track(
     rtc::scoped_refptr<webrtc::MediaStreamTrackInterface> rtc_track) {
   webrtc::MutexLock lock(&mutex_);